@@ -0,0 +1,106 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include "parser.h"
+#include "IR/passes/basis_translation.hpp"
+#include "statevector.hpp"
+#include "timing.hpp"
+
+// Every EquivalenceLibrary rule simulated against the gate it implements,
+// under random parameters, and 200 random 3-qubit circuits simulated
+// against their translation into each basis. Then translation of a random
+// 2M-gate qelib1 circuit into three native sets (the output is up to six
+// times larger). Decompositions are searched and composed once per basis,
+// so the time is dominated by copying templates into the output circuit.
+
+constexpr uint32_t kQubits = 256;
+constexpr size_t kGates = 2000000;
+constexpr int kCircuits = 200;
+
+static qarser::Circuit random_circuit(uint32_t num_qubits, size_t num_gates, std::mt19937& rng) {
+    using qarser::OpCode;
+    const OpCode one_qubit[] = {OpCode::H, OpCode::X, OpCode::S, OpCode::T, OpCode::SX, OpCode::Y};
+    const OpCode two_qubit[] = {OpCode::CX, OpCode::CZ, OpCode::SWAP};
+    std::uniform_real_distribution<double> angle(-3.0, 3.0);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", num_qubits);
+    circuit.reserve(num_gates, 2 * num_gates, num_gates);
+    while (circuit.size() < num_gates) {
+        uint32_t a = rng() % num_qubits;
+        uint32_t b = (a + 1 + rng() % (num_qubits - 1)) % num_qubits;
+        switch (rng() % 8) {
+            case 0: case 1: circuit.add(two_qubit[rng() % 3], {a, b}); break;
+            case 2: circuit.add(OpCode::RZ, {a}, {angle(rng)}); break;
+            case 3: circuit.add(OpCode::U, {a}, {angle(rng), angle(rng), angle(rng)}); break;
+            case 4: circuit.add(OpCode::CRZ, {a, b}, {angle(rng)}); break;
+            default: circuit.add(one_qubit[rng() % 6], {a}); break;
+        }
+    }
+    return circuit;
+}
+
+// Rules whose body differs from their target gate on random states, under three parameter draws
+static size_t wrong_rules(std::mt19937& rng) {
+    std::uniform_real_distribution<double> angle(-3.0, 3.0);
+    size_t wrong = 0;
+    for (const auto& rule : qarser::EquivalenceLibrary::standard().get_rules()) {
+        const qarser::GateDef& def = *rule.definition;
+        std::vector<uint32_t> qubits(def.qubits.size());
+        for (uint32_t q = 0; q < qubits.size(); ++q) qubits[q] = q;
+        std::vector<double> params(def.params.size());
+        bool same = true;
+        for (int draw = 0; draw < 3 && same; ++draw) {
+            for (double& param : params) param = angle(rng);
+            qarser::Circuit gate, body;
+            gate.add_qreg("q", qubits.size());
+            body.add_qreg("q", qubits.size());
+            gate.add(rule.target, qubits.data(), qubits.size(), params.data(), params.size());
+            // Renamed, or calls inside the body that reach the same name would resolve to it
+            uint32_t id = body.add_gate(def.name + "_rule", params.size(), qubits.size(), &def);
+            body.add(qarser::OpCode::GATE, qubits.data(), qubits.size(), params.data(), params.size(), nullptr, 0, id);
+            same = equivalent(gate, body, rng);
+        }
+        if (!same) {
+            std::cout << "rule for " << def.name << " differs\n";
+            ++wrong;
+        }
+    }
+    return wrong;
+}
+
+int main() {
+    using qarser::OpCode;
+    std::mt19937 rng(42);
+    size_t rules = qarser::EquivalenceLibrary::standard().get_rules().size();
+    size_t wrong = wrong_rules(rng);
+    qarser::Circuit circuit = random_circuit(kQubits, kGates, rng);
+
+    const std::pair<const char*, std::vector<OpCode>> bases[] = {
+        {"{rz, sx, x, cx}", {OpCode::RZ, OpCode::SX, OpCode::X, OpCode::CX}},
+        {"{U, CX}", {OpCode::U, OpCode::CX}},
+        {"{rx, rz, cz}", {OpCode::RX, OpCode::RZ, OpCode::CZ}},
+    };
+    std::cout << "rules:        " << rules - wrong << " of " << rules << " equivalent\n";
+    std::cout << "gates:        " << circuit.size() << "\n";
+    int mismatches = 0;
+    for (const auto& [name, basis] : bases) {
+        qarser::BasisTranslator small_translator(basis);
+        for (int i = 0; i < kCircuits; ++i) {
+            qarser::Circuit small = random_circuit(3, 20, rng);
+            if (!equivalent(small, small_translator.translate(small), rng)) {
+                ++mismatches;
+            }
+        }
+
+        std::unique_ptr<qarser::BasisTranslator> translator;
+        double setup = time_ms([&] { translator = std::make_unique<qarser::BasisTranslator>(basis); });
+        qarser::Circuit translated;
+        double ms = time_ms([&] { translated = translator->translate(circuit); });
+        std::cout << name << "\n";
+        std::cout << "  search:     " << setup << " ms\n";
+        std::cout << "  output:     " << translated.size() << " gates\n";
+        std::cout << "  time:       " << ms << " ms (" << circuit.size() / ms / 1000.0 << " Mgates/s)\n";
+    }
+    std::cout << "mismatches:   " << mismatches << " of " << 3 * kCircuits << " small circuits\n";
+    return wrong == 0 && mismatches == 0 ? 0 : 1;
+}
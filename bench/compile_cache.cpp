@@ -0,0 +1,122 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "parser.h"
+#include "SA/analyzer.hpp"
+#include "IR/lowering.hpp"
+#include "IR/inliner.hpp"
+#include "IR/compile_cache.hpp"
+#include "IR/passes/commutative_cancellation.hpp"
+#include "IR/passes/phase_folding.hpp"
+#include "IR/passes/single_qubit_fusion.hpp"
+#include "timing.hpp"
+
+// 1000 compile requests drawn from 32 distinct random programs, each sent
+// with its own register names, spacing, comments and order of independent
+// gates. Every request is compiled from scratch, then through a cache keyed
+// by the structural hash.
+
+constexpr int kPrograms = 32;
+constexpr int kRequests = 1000;
+constexpr int kGates = 4000;
+constexpr uint32_t kQubits = 20;
+
+struct Gate {
+    int kind;           // 0 h, 1 t, 2 rz, 3 cx
+    uint32_t a, b;
+    int angle;
+};
+
+std::vector<Gate> random_program(std::mt19937& rng) {
+    std::vector<Gate> gates(kGates);
+    for (auto& gate : gates) {
+        gate.kind = static_cast<int>(rng() % 4);
+        gate.a = rng() % kQubits;
+        gate.b = (gate.a + 1 + rng() % (kQubits - 1)) % kQubits;
+        gate.angle = static_cast<int>(rng() % 8);
+    }
+    return gates;
+}
+
+bool independent(const Gate& x, const Gate& y) {
+    bool x2 = x.kind == 3, y2 = y.kind == 3;
+    return x.a != y.a && !(y2 && x.a == y.b) && !(x2 && x.b == y.a) && !(x2 && y2 && x.b == y.b);
+}
+
+// The same program under new names, layout and order of commuting neighbours
+std::string variant(std::vector<Gate> gates, std::mt19937& rng) {
+    for (size_t i = 0; i + 1 < gates.size(); ++i) {
+        if (rng() % 2 && independent(gates[i], gates[i + 1])) {
+            std::swap(gates[i], gates[i + 1]);
+        }
+    }
+    std::string reg = "r" + std::to_string(rng() % 1000);
+    std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n// request\nqreg " + reg + "[" +
+                         std::to_string(kQubits) + "];\n";
+    for (const auto& gate : gates) {
+        std::string space(1 + rng() % 3, ' ');
+        std::string a = reg + "[" + std::to_string(gate.a) + "]";
+        switch (gate.kind) {
+            case 0: source += "h" + space + a + ";\n"; break;
+            case 1: source += "t" + space + a + ";\n"; break;
+            case 2: source += "rz(" + std::to_string(gate.angle) + " * pi / 8)" + space + a + ";\n"; break;
+            default: source += "cx " + a + "," + space + reg + "[" + std::to_string(gate.b) + "];\n"; break;
+        }
+    }
+    return source;
+}
+
+qarser::Circuit compile(qarser::Circuit circuit, const qarser::GateLibrary& library) {
+    qarser::PhaseFolding().run(circuit);
+    qarser::Circuit flat = qarser::Inliner(library).inline_circuit(circuit);
+    qarser::CommutativeCancellation().run(flat);
+    qarser::SingleQubitFusion().run(flat);
+    return flat;
+}
+
+int main() {
+    std::mt19937 rng(7);
+    std::vector<std::vector<Gate>> programs;
+    for (int i = 0; i < kPrograms; ++i) {
+        programs.push_back(random_program(rng));
+    }
+    std::vector<std::string> requests;
+    for (int i = 0; i < kRequests; ++i) {
+        requests.push_back(variant(programs[rng() % kPrograms], rng));
+    }
+
+    double uncached = time_ms([&] {
+        for (const auto& source : requests) {
+            auto program = qarser::Parser(source).parse();
+            qarser::SemanticAnalyzer analyzer;
+            analyzer.analyze(*program);
+            const auto& library = analyzer.get_context().get_library();
+            compile(qarser::CircuitLowering(library).lower(*program), library);
+        }
+    });
+
+    qarser::CompileCache<qarser::Circuit> cache(64);
+    double hashing = 0;
+    double cached = time_ms([&] {
+        for (const auto& source : requests) {
+            auto program = qarser::Parser(source).parse();
+            qarser::SemanticAnalyzer analyzer;
+            analyzer.analyze(*program);
+            const auto& library = analyzer.get_context().get_library();
+            qarser::Circuit circuit = qarser::CircuitLowering(library).lower(*program);
+            qarser::Hash128 key;
+            hashing += time_ms([&] { key = qarser::StructuralHasher(library).hash(circuit); });
+            cache.get_or_compile(key, [&] { return compile(circuit, library); });
+        }
+    });
+
+    qarser::CacheStats stats = cache.get_stats();
+    std::cout << "uncached:     " << uncached << " ms\n";
+    std::cout << "cached:       " << cached << " ms (hashing " << hashing << " ms)\n";
+    std::cout << "hit rate:     " << stats.hit_rate() << " (" << stats.hits << " hits, " << stats.misses
+              << " misses, " << stats.entries << " entries)\n";
+    // Every variant of a program must hit the entry its first request made
+    return stats.misses == kPrograms ? 0 : 1;
+}
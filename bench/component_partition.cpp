@@ -0,0 +1,84 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "parser.h"
+#include "IR/structural_hash.hpp"
+#include "IR/passes/component_partition.hpp"
+#include "IR/passes/peephole.hpp"
+#include "IR/passes/single_qubit_fusion.hpp"
+#include "utils/thread_pool.hpp"
+#include "timing.hpp"
+
+// 256 independent 16-qubit subsystems interleaved on one 4096-qubit
+// register, 4M operations in all. The circuit is split into components,
+// each component is optimized on the thread pool, and the results are
+// recombined; the structural hash checks the split itself round-trips.
+
+constexpr uint32_t kSystems = 256;
+constexpr uint32_t kWidth = 16;
+constexpr size_t kOperations = 4000000;
+
+static void optimize(qarser::Circuit& circuit) {
+    qarser::PeepholeOptimizer().run(circuit);
+    qarser::SingleQubitFusion().run(circuit);
+}
+
+int main() {
+    using qarser::OpCode;
+    std::mt19937 rng(11);
+
+    // Subsystem s owns qubits s, s + kSystems, s + 2 * kSystems, ...
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", kSystems * kWidth);
+    circuit.add_creg("c", kSystems * kWidth);
+    while (circuit.size() < kOperations) {
+        uint32_t system = rng() % kSystems;
+        uint32_t a = system + kSystems * (rng() % kWidth);
+        uint32_t b = system + kSystems * ((a / kSystems + 1 + rng() % (kWidth - 1)) % kWidth);
+        switch (rng() % 4) {
+            case 0: circuit.add(OpCode::H, {a}); break;
+            case 1: circuit.add(OpCode::RZ, {a}, {0.25 * (rng() % 8)}); break;
+            default: circuit.add(OpCode::CX, {a, b}); break;
+        }
+    }
+    for (uint32_t q = 0; q < kSystems * kWidth; ++q) {
+        circuit.add(OpCode::MEASURE, &q, 1, nullptr, 0, &q, 1);
+    }
+
+    qarser::ComponentPartition partition;
+    double split_ms = time_ms([&] { partition = qarser::ComponentPartitioner().split(circuit); });
+
+    std::vector<qarser::Circuit> parts(partition.components.size());
+    for (size_t i = 0; i < parts.size(); ++i) {
+        parts[i] = partition.components[i].circuit;
+    }
+    qarser::Circuit recombined;
+    double recombine_ms = time_ms([&] { recombined = partition.recombine(parts); });
+    qarser::StructuralHasher hasher(qarser::GateLibrary::qelib1());
+    bool same = hasher.hash(recombined) == hasher.hash(circuit);
+
+    qarser::ThreadPool& pool = qarser::ThreadPool::shared();
+    double parts_ms = time_ms([&] {
+        pool.parallel_for(parts.size(), 1, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                optimize(parts[i]);
+            }
+        });
+    });
+    qarser::Circuit whole = circuit;
+    double whole_ms = time_ms([&] { optimize(whole); });
+    size_t optimized = partition.recombine(parts).size();
+
+    size_t widest = 0;
+    for (const auto& component : partition.components) {
+        widest = std::max(widest, component.qubits.size());
+    }
+    std::cout << "components:   " << partition.components.size() << ", widest " << widest << " qubits\n";
+    std::cout << "split:        " << split_ms << " ms, recombine " << recombine_ms << " ms, round trip "
+              << (same ? "exact" : "DIFFERS") << "\n";
+    std::cout << "optimize:     " << whole_ms << " ms whole, " << parts_ms << " ms by component on "
+              << pool.size() << " threads (" << whole.size() << " / " << optimized << " operations)\n";
+    std::cout << "state vector: 2^" << kSystems * kWidth << " amplitudes whole, "
+              << partition.components.size() << " x 2^" << widest << " by component\n";
+    return same && partition.components.size() == kSystems ? 0 : 1;
+}
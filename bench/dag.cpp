@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "IR/dag.hpp"
+#include "timing.hpp"
+
+// Dependency DAG of a random 10M-operation circuit on 1024 qubits, with
+// successors checked as the exact transpose of the predecessors. A 200K
+// operation circuit on 32 qubits is checked edge by edge against a
+// backwards scan for the previous operation on every wire.
+
+constexpr uint32_t kQubits = 1024;
+constexpr size_t kOperations = 10000000;
+constexpr uint32_t kCheckQubits = 32;
+constexpr size_t kCheckOperations = 200000;
+
+static qarser::Circuit random_circuit(uint32_t num_qubits, size_t num_operations, uint32_t seed) {
+    std::mt19937 rng(seed);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", num_qubits);
+    circuit.add_creg("c", num_qubits);
+    circuit.reserve(num_operations, 2 * num_operations);
+    std::vector<uint32_t> span;
+    for (size_t i = 0; i < num_operations; ++i) {
+        uint32_t a = rng() % num_qubits;
+        uint32_t b = (a + 1 + rng() % (num_qubits - 1)) % num_qubits;
+        switch (rng() % 64) {
+            case 0:
+                span.clear();
+                for (uint32_t q = a; q < std::min(num_qubits, a + 8); ++q) span.push_back(q);
+                circuit.add(qarser::OpCode::BARRIER, span.data(), span.size());
+                break;
+            case 1: case 2: case 3: case 4:
+                circuit.add(qarser::OpCode::MEASURE, &a, 1, nullptr, 0, &b, 1);
+                break;
+            case 5: case 6: case 7: case 8: case 9: case 10: case 11: case 12:
+                circuit.add(qarser::OpCode::RZ, {a}, {0.5});
+                break;
+            default:
+                if (rng() % 2) circuit.add(qarser::OpCode::CX, {a, b});
+                else circuit.add(qarser::OpCode::H, {a});
+                break;
+        }
+    }
+    return circuit;
+}
+
+// Successor lists hold exactly the reversed predecessor edges, in ascending order
+static bool transposed(const qarser::DependencyDag& dag) {
+    size_t edges = 0;
+    for (uint32_t v = 0; v < dag.size(); ++v) {
+        auto succs = dag.successors(v);
+        if (!std::is_sorted(succs.begin(), succs.end())) {
+            return false;
+        }
+        for (uint32_t u : dag.predecessors(v)) {
+            auto from = dag.successors(u);
+            if (u >= v || !std::binary_search(from.begin(), from.end(), v)) {
+                return false;
+            }
+        }
+        edges += succs.size();
+    }
+    return edges == dag.num_edges();
+}
+
+// Predecessors found by scanning back from every operation, one wire at a time
+static bool matches_scan(const qarser::Circuit& circuit, const qarser::DependencyDag& dag) {
+    const auto& ops = circuit.get_operations();
+    uint32_t num_qubits = circuit.get_num_qubits();
+    auto wires = [&](const qarser::Operation& op) {
+        std::vector<uint32_t> result(circuit.qubits(op).begin(), circuit.qubits(op).end());
+        for (uint32_t c : circuit.clbits(op)) result.push_back(num_qubits + c);
+        return result;
+    };
+    std::vector<uint32_t> expected;
+    for (uint32_t v = 0; v < ops.size(); ++v) {
+        expected.clear();
+        for (uint32_t wire : wires(ops[v])) {
+            for (uint32_t u = v; u-- > 0;) {
+                auto other = wires(ops[u]);
+                if (std::find(other.begin(), other.end(), wire) != other.end()) {
+                    expected.push_back(u);
+                    break;
+                }
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        auto preds = dag.predecessors(v);
+        if (!std::equal(preds.begin(), preds.end(), expected.begin(), expected.end())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    qarser::Circuit circuit = random_circuit(kQubits, kOperations, 42);
+    qarser::DependencyDag dag;
+    double build_ms = time_ms([&] { dag.build(circuit); });
+    bool transpose_ok = transposed(dag);
+
+    qarser::Circuit small = random_circuit(kCheckQubits, kCheckOperations, 7);
+    bool scan_ok = matches_scan(small, qarser::DependencyDag(small));
+
+    std::cout << "operations:   " << circuit.size() << "\n";
+    std::cout << "edges:        " << dag.num_edges() << " (" << dag.memory_bytes() / (1 << 20) << " MB)\n";
+    std::cout << "build:        " << build_ms << " ms (" << circuit.size() / build_ms / 1000 << "M ops/s)\n";
+    std::cout << "transpose:    " << (transpose_ok ? "exact" : "WRONG") << "\n";
+    std::cout << "scan check:   " << (scan_ok ? "match" : "MISMATCH") << " on " << small.size() << " operations\n";
+    return transpose_ok && scan_ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "parser.h"
+#include "IR/passes/dead_operation_elimination.hpp"
+#include "statevector.hpp"
+#include "timing.hpp"
+
+// Dead operation elimination on 2000 random 4-qubit circuits with
+// mid-circuit measurements into 3 bits, resets and barriers, each checked
+// to keep the distribution of measured outcomes; then on a random
+// 20M-operation circuit over 4096 qubits where only every fourth qubit is
+// ever measured, a few times along the way and once more at the end,
+// followed by a tail of gates, which is timed.
+//
+// The circuit IR has no classically conditioned operations, so the small
+// circuits cannot contain any.
+
+constexpr int kCircuits = 2000;
+constexpr uint32_t kQubits = 4096;
+constexpr size_t kOperations = 20000000;
+
+static qarser::Circuit random_small_circuit(std::mt19937& rng) {
+    using qarser::OpCode;
+    const OpCode one_qubit[] = {OpCode::H, OpCode::X, OpCode::T, OpCode::SX};
+    std::uniform_real_distribution<double> angle(-3.0, 3.0);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", 4);
+    circuit.add_creg("c", 3);
+    size_t length = 10 + rng() % 21;
+    int branching = 0;      // measurements and resets, each doubles the simulated branches
+    while (circuit.size() < length) {
+        uint32_t a = rng() % 4;
+        uint32_t b = (a + 1 + rng() % 3) % 4;
+        switch (rng() % 10) {
+            case 0: case 1: circuit.add(one_qubit[rng() % 4], {a}); break;
+            case 2: circuit.add(OpCode::RY, {a}, {angle(rng)}); break;
+            case 3: case 4: circuit.add(OpCode::CX, {a, b}); break;
+            case 5: circuit.add(OpCode::CZ, {a, b}); break;
+            case 6: case 7:
+                if (branching < 8) {
+                    uint32_t clbit = rng() % 3;
+                    circuit.add(OpCode::MEASURE, &a, 1, nullptr, 0, &clbit, 1);
+                    ++branching;
+                }
+                break;
+            case 8:
+                if (branching < 8) {
+                    circuit.add(OpCode::RESET, {a});
+                    ++branching;
+                }
+                break;
+            default: {
+                uint32_t qubits[] = {a, b};
+                circuit.add(OpCode::BARRIER, qubits, 1 + rng() % 2);
+                break;
+            }
+        }
+    }
+    uint32_t q = rng() % 4, clbit = rng() % 3;
+    circuit.add(OpCode::MEASURE, &q, 1, nullptr, 0, &clbit, 1);
+    return circuit;
+}
+
+static bool same_distribution(const std::vector<double>& a, const std::vector<double>& b) {
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::abs(a[i] - b[i]) > 1e-9) {
+            return false;
+        }
+    }
+    return a.size() == b.size();
+}
+
+int main() {
+    using qarser::OpCode;
+
+    std::mt19937 rng(42);
+    bool ok = true;
+    size_t small_operations = 0, small_removed = 0;
+    for (int i = 0; i < kCircuits; ++i) {
+        qarser::Circuit original = random_small_circuit(rng);
+        qarser::Circuit reduced = original;
+        size_t removed = qarser::DeadOperationElimination().run(reduced);
+        ok = ok && original.size() - removed == reduced.size() &&
+             same_distribution(outcome_distribution(original), outcome_distribution(reduced));
+        small_operations += original.size();
+        small_removed += removed;
+    }
+
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", kQubits);
+    circuit.add_creg("c", kQubits / 4);
+    circuit.reserve(kOperations + kQubits, 2 * kOperations, kOperations);
+    auto measure = [&](uint32_t q) {
+        uint32_t clbit = q / 4;
+        circuit.add(OpCode::MEASURE, &q, 1, nullptr, 0, &clbit, 1);
+    };
+    for (size_t k = 0; circuit.size() < kOperations; ++k) {
+        // Gates pair qubits 4k, 4k+1 and 4k+2, 4k+3: the second pair is never observed
+        uint32_t a = rng() % kQubits;
+        uint32_t b = a ^ 1;
+        switch (rng() % 16) {
+            case 0: if (a % 4 == 0) measure(a); break;
+            case 1: case 2: circuit.add(OpCode::CX, {a, b}); break;
+            default: circuit.add(OpCode::RZ, {a}, {(rng() % 1000) / 159.0}); break;
+        }
+        if (k == kOperations * 9 / 10) {
+            for (uint32_t q = 0; q < kQubits; q += 4) {
+                measure(q);
+            }
+        }
+    }
+
+    size_t before = circuit.size();
+    size_t removed = 0;
+    qarser::DeadOperationElimination pass;
+    double ms = time_ms([&] { removed = pass.run(circuit); });
+
+    ok = ok && before - removed == circuit.size();
+
+    std::cout << "small:        " << kCircuits << " circuits, " << small_removed << " of " << small_operations
+              << " operations removed, outcomes " << (ok ? "unchanged" : "CHANGED") << "\n";
+    std::cout << "operations:   " << before << " -> " << circuit.size() << " (" << removed << " removed)\n";
+    std::cout << "time:         " << ms << " ms (" << before / ms / 1000.0 << " Mops/s)\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <string>
+#include "parser.h"
+#include "SA/analyzer.hpp"
+#include "AST/compressor.hpp"
+#include "timing.hpp"
+
+// Gate costs of small definitions worked out by hand, with the same
+// definition called under several constant arguments so the T-count memo
+// must tell them apart; recursion detection; calls that come before their
+// definition, which get no cost; and repeat extrapolation, compared
+// against the raw program, on a 1M-statement sequence of parametrized
+// calls and on a shifted ladder, both also timed.
+
+constexpr int kCalls = 1000000;
+constexpr int kLadder = 100000;
+
+static qarser::GateCost cost_of(qarser::Program& program, double* ms = nullptr) {
+    qarser::SemanticAnalyzer analyzer;
+    analyzer.analyze(program);
+    qarser::GateCostAnalyzer costs(analyzer.get_context());
+    double elapsed = time_ms([&] { program.accept(costs); });
+    if (ms) {
+        *ms = elapsed;
+    }
+    return costs.get_total();
+}
+
+static bool same(const qarser::GateCost& a, const qarser::GateCost& b) {
+    return a.one_qubit == b.one_qubit && a.two_qubit == b.two_qubit && a.depth == b.depth &&
+           a.t_count == b.t_count && a.t_count_exact == b.t_count_exact;
+}
+
+static void print(const char* title, const qarser::GateCost& cost) {
+    std::cout << title << cost.one_qubit << " U, " << cost.two_qubit << " CX, depth " << cost.depth
+              << ", T-count " << cost.t_count << (cost.t_count_exact ? "" : " (inexact)") << "\n";
+}
+
+int main() {
+    // t is u1(pi/4) = U(0, 0, pi/4), a T up to phase. rot(x) is a T once for
+    // x = pi/2, pi/4 and 3pi/2, and never for pi/8 or pi. blk(x) costs
+    // rot(x) + rot(2x) + 2: 4 T for pi/4, 3 for pi/8. Six U and one CX per
+    // blk with a depth bound of 5; two U and a depth of 2 per rot.
+    const std::string definitions =
+        "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\n"
+        "gate tt a { t a; t a; }\n"
+        "gate rot(x) a { u1(x) a; u1(x / 2) a; }\n"
+        "gate blk(x) a, b { rot(x) a; cx a, b; rot(2 * x) b; tt a; }\n";
+    auto program = qarser::Parser(definitions +
+        "rot(pi / 2) q[0];\nrot(pi) q[0];\nrot(pi / 2) q[1];\nrot(3 * pi / 2) q[1];\n"
+        "blk(pi / 4) q[0], q[1];\nblk(pi / 8) q[1], q[0];\n").parse();
+    qarser::GateCost expected{20, 2, 14, 10, true};
+    qarser::GateCost small = cost_of(*program);
+    bool ok = same(small, expected);
+
+    bool recursion = false;
+    try {
+        auto recursive = qarser::Parser("OPENQASM 2.0;\nqreg q[1];\ngate a x { a x; }\na q[0];\n").parse();
+        cost_of(*recursive);
+    }
+    catch (const std::runtime_error&) {
+        recursion = true;
+    }
+    ok = ok && recursion;
+
+    // The first call and the body of `early` come before `late` is defined
+    auto ordered = qarser::Parser(
+        "OPENQASM 2.0;\nqreg q[1];\nlate q[0];\ngate early a { late a; U(0, 0, pi / 4) a; }\n"
+        "gate late a { U(0, 0, pi / 4) a; U(0, 0, pi / 4) a; }\nlate q[0];\nearly q[0];\n").parse();
+    qarser::GateCost order_expected{3, 0, 3, 3, true};
+    qarser::GateCost order_cost = cost_of(*ordered);
+    ok = ok && same(order_cost, order_expected);
+
+    // Every call after the first block hits the memo; each block raises
+    // every qubit it touches by 5, so the repeat is extrapolated
+    std::string source = definitions + "qreg r[4];\n";
+    for (int i = 0; i < kCalls / 5; ++i) {
+        source += "blk(pi / 4) q[0], q[1];\nblk(pi / 8) r[2], r[3];\ntt r[0];\nrot(pi / 2) r[0];\nt r[0];\n";
+    }
+    auto raw = qarser::Parser(source).parse();
+    auto compressed = qarser::Parser(source).parse();
+    auto report = qarser::RepeatCompressor().compress(*compressed);
+    double raw_ms = 0, compressed_ms = 0;
+    qarser::GateCost raw_cost = cost_of(*raw, &raw_ms);
+    qarser::GateCost compressed_cost = cost_of(*compressed, &compressed_ms);
+    qarser::GateCost calls{uint64_t{kCalls / 5} * 17, uint64_t{kCalls / 5} * 2, uint64_t{kCalls / 5} * 5,
+                           uint64_t{kCalls / 5} * 11, true};
+    ok = ok && same(raw_cost, calls) && same(compressed_cost, calls);
+
+    // A ladder that moves by one qubit per step compresses to a single
+    // shifted repeat; every step waits on the one before it
+    std::string ladder = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg r[" + std::to_string(kLadder + 1) + "];\n";
+    for (int i = 0; i < kLadder; ++i) {
+        ladder += "h r[" + std::to_string(i) + "];\nt r[" + std::to_string(i + 1) + "];\ncx r[" +
+                  std::to_string(i) + "], r[" + std::to_string(i + 1) + "];\n";
+    }
+    auto ladder_raw = qarser::Parser(ladder).parse();
+    auto ladder_compressed = qarser::Parser(ladder).parse();
+    auto ladder_report = qarser::RepeatCompressor().compress(*ladder_compressed);
+    double ladder_raw_ms = 0, ladder_compressed_ms = 0;
+    qarser::GateCost ladder_raw_cost = cost_of(*ladder_raw, &ladder_raw_ms);
+    qarser::GateCost ladder_cost = cost_of(*ladder_compressed, &ladder_compressed_ms);
+    ok = ok && same(ladder_raw_cost, ladder_cost) && ladder_report.statements_after < 10;
+
+    print("small program: ", small);
+    print("expected:      ", expected);
+    std::cout << "recursion:     " << (recursion ? "detected" : "MISSED") << "\n";
+    print("call order:    ", order_cost);
+    print("calls:         ", compressed_cost);
+    std::cout << "cost:          " << raw_ms << " ms raw, " << compressed_ms << " ms compressed ("
+              << report.statements_before << " -> " << report.statements_after << " statements)\n";
+    print("ladder raw:    ", ladder_raw_cost);
+    print("ladder:        ", ladder_cost);
+    std::cout << "ladder cost:   " << ladder_raw_ms << " ms raw, " << ladder_compressed_ms << " ms compressed ("
+              << ladder_report.statements_before << " -> " << ladder_report.statements_after << " statements)\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "SA/analyzer.hpp"
+#include "SA/incremental_analyzer.hpp"
+#include "timing.hpp"
+
+// 3000 random edits of a 2000-statement program whose few register and
+// gate names keep colliding: declarations come and go, gates are defined,
+// redefined and called with wrong arities or out-of-range indices, and
+// now and then the include itself is edited. After every edit the
+// incremental diagnostics must equal those of a fresh full analysis.
+
+constexpr size_t kStatements = 2000;
+constexpr int kEdits = 3000;
+
+class StatementGenerator {
+private:
+    std::mt19937 rng;
+    int next_line = 1;
+
+public:
+    explicit StatementGenerator(uint32_t seed) : rng(seed) {}
+
+    std::vector<std::unique_ptr<qarser::Statement>> make(size_t count) {
+        std::string source = "OPENQASM 2.0;\n";
+        for (size_t i = 0; i < count; ++i) {
+            source += statement() + "\n";
+        }
+        auto program = qarser::Parser(source).parse();
+        for (auto& stmt : program->statements) {
+            stmt->line = next_line++;
+        }
+        return std::move(program->statements);
+    }
+
+private:
+    std::string pick(std::initializer_list<const char*> options) {
+        return *(options.begin() + rng() % options.size());
+    }
+
+    std::string qubit() {
+        return pick({"q", "r"}) + "[" + std::to_string(rng() % 5) + "]";
+    }
+
+    std::string statement() {
+        switch (rng() % 64) {
+            case 0: return "qreg " + pick({"q", "r", "g"}) + "[" + std::to_string(1 + rng() % 4) + "];";
+            case 1: return "creg " + pick({"c", "q"}) + "[" + std::to_string(rng() % 4) + "];";
+            case 2: return "gate " + pick({"g", "k", "h"}) + " a, b { " + pick({"cx", "k", "g", "m"}) + " a, b; }";
+            case 3: return "gate k(t) a { rz(t) a; " + pick({"h", "g", "u1(t)"}) + " a; }";
+            case 4: return rng() % 8 == 0 ? "include \"qelib1.inc\";" : "barrier " + qubit() + ", " + pick({"q", "r"}) + ";";
+            case 5: return "measure " + qubit() + " -> " + pick({"c", "q"}) + "[" + std::to_string(rng() % 3) + "];";
+            case 6: return "reset " + pick({"q", "r", "s"}) + "[" + std::to_string(rng() % 5) + "];";
+            case 7: return "k(0.5) " + qubit() + ";";
+            case 8: return "g " + qubit() + ", " + qubit() + ";";
+            case 9: return "cx " + pick({"q", "r"}) + ", " + pick({"q", "r"}) + ";";
+            case 10: return pick({"x", "m"}) + " " + qubit() + ";";
+            default: return pick({"h", "t", "rz(0.25)"}) + " " + qubit() + ";";
+        }
+    }
+};
+
+// Rendered diagnostics, one per line
+static std::string render(const std::vector<qarser::Diagnostic>& errors, const qarser::ErrorCollector& names) {
+    std::string text;
+    for (const auto& err : errors) {
+        text += std::to_string(err.line) + ": " + names.format(err) + "\n";
+    }
+    return text;
+}
+
+int main() {
+    StatementGenerator generator(17);
+    std::mt19937 rng(5);
+
+    qarser::Program program;
+    program.statements = generator.make(kStatements);
+    program.statements.insert(program.statements.begin(),
+        std::move(qarser::Parser("OPENQASM 2.0;\ninclude \"qelib1.inc\";").parse()->statements.front()));
+
+    qarser::IncrementalAnalyzer incremental;
+    incremental.analyze(program);
+
+    double incremental_ms = 0, full_ms = 0;
+    int mismatches = 0;
+    size_t diagnostics = 0;
+    for (int edit = 0; edit < kEdits; ++edit) {
+        size_t size = program.statements.size();
+        size_t first = rng() % (size + 1);
+        size_t count = std::min<size_t>(rng() % 4, size - first);
+        auto statements = generator.make(rng() % 4);
+        incremental_ms += time_ms([&] { incremental.replace(program, first, count, std::move(statements)); });
+
+        qarser::SemanticAnalyzer analyzer;
+        full_ms += time_ms([&] { analyzer.analyze(program); });
+        const auto& collector = analyzer.get_context().get_errors();
+        std::string expected = render(collector.get_errors(), collector);
+        std::string actual = render(incremental.get_errors(), incremental.get_collector());
+        diagnostics += collector.get_errors().size();
+        if (actual != expected) {
+            if (++mismatches == 1) {
+                std::cout << "edit " << edit << " differs\nexpected:\n" << expected << "incremental:\n" << actual;
+            }
+        }
+    }
+
+    std::cout << "edits:        " << kEdits << " on " << program.statements.size() << " statements, "
+              << diagnostics / kEdits << " diagnostics on average\n";
+    std::cout << "incremental:  " << incremental_ms << " ms\n";
+    std::cout << "full:         " << full_ms << " ms\n";
+    std::cout << "mismatches:   " << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
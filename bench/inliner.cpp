@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "parser.h"
+#include "SA/analyzer.hpp"
+#include "IR/lowering.hpp"
+#include "IR/inliner.hpp"
+#include "timing.hpp"
+
+// Inlines a program with 1M qelib1 call sites, compared against recursively
+// walking GateDef bodies and re-substituting arguments at every call site.
+// Also reuses one Inliner across two programs that define the same gate
+// name differently.
+
+constexpr int kQubits = 16;
+constexpr int kCallSites = 1000000;
+
+// Baseline: expands one call by evaluating the body against the call's bindings
+void expand_naive(const qarser::GateLibrary& library, const std::string& name,
+                  const std::vector<std::optional<double>>& params,
+                  const std::vector<uint32_t>& qubits, qarser::Circuit& out) {
+    if (name == "U") {
+        double values[3] = {*params[0], *params[1], *params[2]};
+        out.add(qarser::OpCode::U, qubits.data(), 1, values, 3);
+        return;
+    }
+    if (name == "CX") {
+        out.add(qarser::OpCode::CX, qubits.data(), 2);
+        return;
+    }
+    const qarser::GateDef* def = library.find_definition(name);
+    qarser::ExpressionEvaluator evaluator(def->params, params);
+    for (const auto& stmt : def->body) {
+        const auto& call = static_cast<const qarser::Gate&>(*stmt);
+        std::vector<std::optional<double>> args;
+        for (const auto& param : call.params) {
+            args.push_back(evaluator.evaluate(*param));
+        }
+        std::vector<uint32_t> targets;
+        for (const auto& ref : call.qubits) {
+            for (size_t i = 0; i < def->qubits.size(); ++i) {
+                if (def->qubits[i].name == ref.name) {
+                    targets.push_back(qubits[i]);
+                }
+            }
+        }
+        expand_naive(library, call.name, args, targets, out);
+    }
+}
+
+static bool same_operations(const qarser::Circuit& a, const qarser::Circuit& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        const auto& x = a.get_operations()[i];
+        const auto& y = b.get_operations()[i];
+        auto qx = a.qubits(x), qy = b.qubits(y);
+        auto px = a.params(x), py = b.params(y);
+        if (x.code != y.code || !std::equal(qx.begin(), qx.end(), qy.begin(), qy.end()) || px.size() != py.size()) {
+            return false;
+        }
+        // Templates fold constants, so values may differ in the last bits
+        for (size_t p = 0; p < px.size(); ++p) {
+            if (std::abs(px[p] - py[p]) > 1e-12 * std::max(1.0, std::abs(py[p]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static qarser::Circuit lower(const std::string& source, const qarser::GateLibrary*& library,
+                             std::unique_ptr<qarser::Program>& program, qarser::SemanticAnalyzer& analyzer) {
+    program = qarser::Parser(source).parse();
+    analyzer.analyze(*program);
+    library = &analyzer.get_context().get_library();
+    return qarser::CircuitLowering(*library).lower(*program);
+}
+
+int main() {
+    const char* gates[] = {"ccx", "cu3(0.1,0.2,0.3)", "cswap", "c3x", "rzz(0.4)", "ch", "cry(0.7)"};
+    const int arity[] = {3, 2, 3, 4, 2, 2, 2};
+
+    std::mt19937 rng(42);
+    std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" + std::to_string(kQubits) + "];\n";
+    for (int i = 0; i < kCallSites; ++i) {
+        int g = rng() % 7;
+        source += gates[g];
+        int first = rng() % (kQubits - arity[g] + 1);
+        for (int a = 0; a < arity[g]; ++a) {
+            source += (a == 0 ? " q[" : ", q[") + std::to_string(first + a) + "]";
+        }
+        source += ";\n";
+    }
+
+    auto program = qarser::Parser(source).parse();
+    qarser::SemanticAnalyzer analyzer;
+    analyzer.analyze(*program);
+    const qarser::GateLibrary& library = analyzer.get_context().get_library();
+    qarser::Circuit circuit = qarser::CircuitLowering(library).lower(*program);
+
+    qarser::Circuit inlined;
+    double template_ms = time_ms([&] {
+        inlined = qarser::Inliner(library).inline_circuit(circuit);
+    });
+
+    qarser::Circuit naive;
+    double naive_ms = time_ms([&] {
+        std::vector<std::optional<double>> params;
+        std::vector<uint32_t> qubits;
+        for (const auto& op : circuit.get_operations()) {
+            params.assign(circuit.params(op).begin(), circuit.params(op).end());
+            qubits.assign(circuit.qubits(op).begin(), circuit.qubits(op).end());
+            expand_naive(library, circuit.name(op), params, qubits, naive);
+        }
+    });
+
+    bool same = same_operations(inlined, naive);
+
+    // Calls to 'f' in the second program must not expand to the first one's 'f'
+    const qarser::GateLibrary* first_library = nullptr;
+    const qarser::GateLibrary* second_library = nullptr;
+    std::unique_ptr<qarser::Program> first_program, second_program;
+    qarser::SemanticAnalyzer first_analyzer, second_analyzer;
+    const std::string header = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\n";
+    qarser::Circuit first = lower(header + "gate f a { x a; }\ngate g a, b { f a; cx a, b; }\ng q[0], q[1];\n",
+                                  first_library, first_program, first_analyzer);
+    qarser::Circuit second = lower(header + "gate f a { h a; }\ngate g a, b { f a; cx a, b; }\ng q[0], q[1];\n",
+                                   second_library, second_program, second_analyzer);
+    qarser::Inliner reused(*first_library);
+    reused.inline_circuit(first);
+    bool reuse_ok = same_operations(reused.inline_circuit(second), qarser::Inliner(*second_library).inline_circuit(second));
+
+    std::cout << "call sites:   " << circuit.size() << "\n";
+    std::cout << "primitives:   " << inlined.size() << " (naive " << naive.size() << "), "
+              << (same ? "identical" : "DIFFERENT") << "\n";
+    std::cout << "templates:    " << template_ms << " ms\n";
+    std::cout << "naive:        " << naive_ms << " ms\n";
+    std::cout << "reused:       " << (reuse_ok ? "second program's definitions" : "STALE definitions") << "\n";
+    return same && reuse_ok ? 0 : 1;
+}
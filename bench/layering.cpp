@@ -0,0 +1,93 @@
+#include <iostream>
+#include <random>
+#include "IR/layering.hpp"
+#include "timing.hpp"
+
+// ASAP/ALAP layering of a random 10M-operation circuit on 1024 qubits,
+// wavefront-parallel against the serial timeline sweep. A 2M-operation
+// circuit on 64K qubits, whose wavefronts hold thousands of operations,
+// runs the same check on an explicit four-thread pool, once with unit-like
+// durations and once with durations in picoseconds.
+
+constexpr uint32_t kQubits = 1024;
+constexpr size_t kOperations = 10000000;
+constexpr uint32_t kWideQubits = 65536;
+constexpr size_t kWideOperations = 2000000;
+
+static qarser::Circuit random_circuit(uint32_t num_qubits, size_t num_operations, std::mt19937& rng) {
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", num_qubits);
+    circuit.add_creg("c", num_qubits);
+    circuit.reserve(num_operations, 2 * num_operations);
+    for (size_t i = 0; i < num_operations; ++i) {
+        uint32_t a = rng() % num_qubits;
+        uint32_t b = (a + 1 + rng() % (num_qubits - 1)) % num_qubits;
+        switch (rng() % 8) {
+            case 0: case 1: case 2: circuit.add(qarser::OpCode::CX, {a, b}); break;
+            case 3: circuit.add(qarser::OpCode::RZ, {a}, {0.5}); break;
+            case 4: circuit.add(qarser::OpCode::MEASURE, &a, 1, nullptr, 0, &b, 1); break;
+            default: circuit.add(qarser::OpCode::H, {a}); break;
+        }
+    }
+    return circuit;
+}
+
+struct Run {
+    double serial_ms, dag_ms, parallel_ms;
+    qarser::Layers layers;
+    bool same;
+};
+
+static Run run(const qarser::Circuit& circuit, const qarser::GateDurations& durations, qarser::ThreadPool& pool) {
+    qarser::Layering layering(circuit, durations, pool);
+    Run result;
+    qarser::Layers serial;
+    qarser::DependencyDag dag;
+    result.serial_ms = time_ms([&] { serial = layering.compute_serial(); });
+    result.dag_ms = time_ms([&] { dag.build(circuit); });
+    result.parallel_ms = time_ms([&] { result.layers = layering.compute(dag); });
+    const qarser::Layers& parallel = result.layers;
+    result.same = serial.asap == parallel.asap && serial.alap == parallel.alap &&
+                  serial.depth == parallel.depth && serial.critical_path == parallel.critical_path &&
+                  serial.layer_starts == parallel.layer_starts && serial.parallelism == parallel.parallelism &&
+                  parallel.layer_starts.size() <= circuit.size();
+    return result;
+}
+
+static void print(const char* title, const Run& run, size_t threads) {
+    std::cout << title << "\n";
+    std::cout << "  threads:    " << threads << "\n";
+    std::cout << "  depth:      " << run.layers.depth << " (critical path " << run.layers.critical_path.size()
+              << " ops, " << run.layers.layer_starts.size() << " layer starts)\n";
+    std::cout << "  serial:     " << run.serial_ms << " ms\n";
+    std::cout << "  dag build:  " << run.dag_ms << " ms\n";
+    std::cout << "  wavefront:  " << run.parallel_ms << " ms\n";
+    std::cout << "  match:      " << (run.same ? "yes" : "NO") << "\n";
+}
+
+int main() {
+    std::mt19937 rng(42);
+    qarser::Circuit circuit = random_circuit(kQubits, kOperations, rng);
+    qarser::Circuit wide = random_circuit(kWideQubits, kWideOperations, rng);
+
+    qarser::GateDurations durations;
+    durations.set(qarser::OpCode::CX, 3);
+    durations.set(qarser::OpCode::MEASURE, 10);
+    qarser::GateDurations picoseconds;
+    picoseconds.set(qarser::OpCode::CX, 300000);
+    picoseconds.set(qarser::OpCode::H, 35000);
+    picoseconds.set(qarser::OpCode::RZ, 0);
+    picoseconds.set(qarser::OpCode::MEASURE, 5000000);
+
+    qarser::ThreadPool four(4);
+    Run narrow = run(circuit, durations, qarser::ThreadPool::shared());
+    Run wide_units = run(wide, durations, four);
+    Run wide_ps = run(wide, picoseconds, four);
+
+    std::cout << "operations:   " << circuit.size() << " on " << kQubits << " qubits, "
+              << wide.size() << " on " << kWideQubits << " qubits\n";
+    print("narrow:", narrow, qarser::ThreadPool::shared().size());
+    print("wide:", wide_units, four.size());
+    print("wide, ps:", wide_ps, four.size());
+    return narrow.same && wide_units.same && wide_ps.same ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "IR/passes/light_cone.hpp"
+#include "timing.hpp"
+
+// Light-cone slicing of a 20M-operation brickwork circuit on a line of
+// 65536 qubits, down to the marginal of a few bits measured at its end.
+// Nearest-neighbour gates make the cone widen by one qubit per layer: the
+// cone of each bit stays an interval, and walking the layers backwards
+// gives the qubits and operations the slice must keep.
+
+constexpr uint32_t kQubits = 65536;
+constexpr size_t kOperations = 20000000;
+
+// Cone of qubits [low, high] walked back through `layers` brickwork layers, counting its gate pairs per layer
+static std::pair<uint32_t, uint32_t> cone(uint32_t low, uint32_t high, uint32_t layers, uint32_t num_qubits,
+                                          std::vector<size_t>& pairs) {
+    for (uint32_t layer = layers; layer-- > 0;) {
+        // Pairs of this layer start at qubits of its parity
+        if (low > 0 && (low - 1) % 2 == layer % 2) --low;
+        if (high + 1 < num_qubits && high % 2 == layer % 2) ++high;
+        for (uint32_t q = low; q + 1 <= high; ++q) {
+            if (q % 2 == layer % 2) ++pairs[layer];
+        }
+    }
+    return {low, high};
+}
+
+int main() {
+    using qarser::OpCode;
+
+    std::mt19937 rng(42);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", kQubits);
+    circuit.add_creg("c", kQubits);
+    circuit.reserve(kOperations + kQubits, 2 * kOperations, kOperations);
+    uint32_t layers = 0;
+    for (; circuit.size() < kOperations; ++layers) {
+        for (uint32_t q = layers % 2; q + 1 < kQubits; q += 2) {
+            double angle = (rng() % 1000) / 159.0;
+            circuit.add(OpCode::RY, {q}, {angle});
+            circuit.add(OpCode::CX, {q, q + 1});
+        }
+    }
+    for (uint32_t q = 0; q < kQubits; ++q) {
+        circuit.add(OpCode::MEASURE, &q, 1, nullptr, 0, &q, 1);
+    }
+
+    std::vector<uint32_t> bits = {0, 1, kQubits / 2};
+    qarser::LightConeSlice slice;
+    double ms = time_ms([&] { slice = qarser::LightConeSlicer().slice(circuit, bits); });
+
+    std::cout << "operations:   " << circuit.size() << " -> " << slice.circuit.size() << "\n";
+    std::cout << "qubits:       " << kQubits << " -> " << slice.circuit.get_num_qubits() << "\n";
+    std::cout << "time:         " << ms << " ms (" << circuit.size() / ms / 1000.0 << " Mops/s)\n";
+
+    // Bits 0 and 1 share a cone, the one of the middle bit lies apart
+    std::vector<size_t> pairs(layers, 0);
+    auto low = cone(0, 1, layers, kQubits, pairs);
+    auto middle = cone(kQubits / 2, kQubits / 2, layers, kQubits, pairs);
+    std::vector<uint32_t> expected;
+    for (auto [first, last] : {low, middle}) {
+        for (uint32_t q = first; q <= last; ++q) expected.push_back(q);
+    }
+    size_t operations = bits.size();
+    for (size_t count : pairs) {
+        operations += 2 * count;
+    }
+    bool ok = slice.qubits == expected && slice.circuit.size() == operations;
+    std::cout << "expected:     " << operations << " operations on " << expected.size() << " qubits, "
+              << (ok ? "match" : "MISMATCH") << "\n";
+    return ok ? 0 : 1;
+}
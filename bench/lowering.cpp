@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include "parser.h"
+#include "SA/analyzer.hpp"
+#include "IR/lowering.hpp"
+#include "timing.hpp"
+
+// Lowering of a 3M-operation program on a 64-qubit register: mostly
+// indexed one- and two-qubit gates, with whole-register broadcasts and
+// measurements mixed in. The circuit is compared operation by operation
+// with one built directly through Circuit::add.
+
+constexpr uint32_t kQubits = 64;
+constexpr size_t kOperations = 3000000;
+
+static bool same_operations(const qarser::Circuit& a, const qarser::Circuit& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        const auto& x = a.get_operations()[i];
+        const auto& y = b.get_operations()[i];
+        auto qx = a.qubits(x), qy = b.qubits(y);
+        auto cx = a.clbits(x), cy = b.clbits(y);
+        auto px = a.params(x), py = b.params(y);
+        if (x.code != y.code || !std::equal(qx.begin(), qx.end(), qy.begin(), qy.end()) ||
+            !std::equal(cx.begin(), cx.end(), cy.begin(), cy.end()) ||
+            !std::equal(px.begin(), px.end(), py.begin(), py.end())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    using qarser::OpCode;
+    std::mt19937 rng(8);
+    std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" + std::to_string(kQubits) +
+                         "];\ncreg c[" + std::to_string(kQubits) + "];\n";
+    qarser::Circuit expected;
+    expected.add_qreg("q", kQubits);
+    expected.add_creg("c", kQubits);
+    auto index = [](uint32_t i) { return "[" + std::to_string(i) + "]"; };
+    while (expected.size() < kOperations) {
+        uint32_t a = rng() % kQubits;
+        uint32_t b = (a + 1 + rng() % (kQubits - 1)) % kQubits;
+        switch (rng() % 64) {
+            case 0:
+                source += "h q;\n";
+                for (uint32_t i = 0; i < kQubits; ++i) expected.add(OpCode::H, {i});
+                break;
+            case 1:
+                source += "measure q -> c;\n";
+                for (uint32_t i = 0; i < kQubits; ++i) expected.add(OpCode::MEASURE, &i, 1, nullptr, 0, &i, 1);
+                break;
+            case 2: case 3: case 4: case 5: case 6: case 7: case 8: case 9:
+                source += "rz(0.25) q" + index(a) + ";\n";
+                expected.add(OpCode::RZ, {a}, {0.25});
+                break;
+            case 10: case 11: case 12: case 13:
+                source += "t q" + index(a) + ";\n";
+                expected.add(OpCode::T, {a});
+                break;
+            default:
+                source += "cx q" + index(a) + ", q" + index(b) + ";\n";
+                expected.add(OpCode::CX, {a, b});
+                break;
+        }
+    }
+
+    auto program = qarser::Parser(source).parse();
+    qarser::SemanticAnalyzer analyzer;
+    analyzer.analyze(*program);
+    if (!analyzer.get_context().get_errors().empty()) {
+        analyzer.get_context().get_errors().report();
+        return 1;
+    }
+
+    qarser::Circuit circuit;
+    double lower_ms = time_ms([&] {
+        circuit = qarser::CircuitLowering(analyzer.get_context().get_library()).lower(*program);
+    });
+    bool same = same_operations(circuit, expected);
+
+    std::cout << "statements:   " << program->statements.size() << "\n";
+    std::cout << "operations:   " << circuit.size() << "\n";
+    std::cout << "lower:        " << lower_ms << " ms (" << circuit.size() / lower_ms / 1000 << "M ops/s)\n";
+    std::cout << "match:        " << (same ? "yes" : "NO") << "\n";
+    return same ? 0 : 1;
+}
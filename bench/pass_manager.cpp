@@ -0,0 +1,133 @@
+#include <iostream>
+#include <random>
+#include "IR/pass_manager.hpp"
+#include "IR/passes/dead_operation_elimination.hpp"
+#include "IR/passes/peephole.hpp"
+#include "IR/passes/single_qubit_fusion.hpp"
+#include "IR/passes/vf2_layout.hpp"
+#include "timing.hpp"
+#ifdef __unix__
+#include <sys/resource.h>
+#endif
+
+// An optimization pipeline over a 4M-operation circuit on 64 qubits that
+// checks depth and wire usage between passes, runs peephole cancellation
+// to a fixed point and picks a layout on an 8x8 grid. The pass manager
+// reuses analyses passes left intact; the baseline recomputes every
+// analysis each time a step needs it.
+
+constexpr uint32_t kSide = 8;
+constexpr uint32_t kQubits = kSide * kSide;
+constexpr size_t kOperations = 4000000;
+
+int main() {
+    using qarser::Analysis;
+    using qarser::OpCode;
+    std::mt19937 rng(3);
+    auto coupling = qarser::CouplingMap::grid(kSide, kSide);
+
+    // Two-qubit gates on grid neighbours, so a perfect layout exists
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", kQubits);
+    circuit.add_creg("c", kQubits);
+    while (circuit.size() < kOperations) {
+        uint32_t a = rng() % kQubits;
+        switch (rng() % 5) {
+            case 0: circuit.add(OpCode::H, {a}); break;
+            case 1: circuit.add(OpCode::T, {a}); break;
+            case 2: circuit.add(OpCode::RZ, {a}, {0.1 * (rng() % 16)}); break;
+            default: {
+                auto neighbors = coupling.neighbors(a);
+                uint32_t b = neighbors[rng() % neighbors.size()];
+                circuit.add(OpCode::CX, {a, b});
+                if (rng() % 4 == 0) {
+                    circuit.add(OpCode::CX, {a, b});
+                }
+            }
+        }
+    }
+    for (uint32_t q = 0; q < kQubits; ++q) {
+        circuit.add(OpCode::MEASURE, &q, 1, nullptr, 0, &q, 1);
+    }
+    qarser::Circuit baseline_circuit = circuit;
+
+    qarser::VF2Layout layout(coupling);
+    uint64_t depth = 0, checksum = 0;
+    auto report_depth = [&](qarser::Circuit& c, qarser::AnalysisCache& analyses) {
+        depth = analyses.get_layers(c).depth;
+        checksum += depth;
+        return false;
+    };
+    auto report_usage = [&](qarser::Circuit& c, qarser::AnalysisCache& analyses) {
+        checksum += analyses.get_usage(c).active;
+        return false;
+    };
+    auto select_layout = [&](qarser::Circuit& c, qarser::AnalysisCache& analyses) {
+        checksum += layout.run(c, analyses.get_interactions(c)).score;
+        return false;
+    };
+
+    qarser::PassManager manager;
+#ifdef __unix__
+    manager.set_peak_probe([] {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<long>(usage.ru_maxrss);
+    });
+#endif
+    manager.add("layout", {Analysis::INTERACTIONS}, {}, select_layout)
+        .add("depth", {Analysis::LAYERS}, {}, report_depth)
+        .add("usage", {Analysis::WIRE_USAGE}, {}, report_usage)
+        .add("dead operations", {}, {}, [](qarser::Circuit& c, qarser::AnalysisCache&) {
+            return qarser::DeadOperationElimination().run(c) > 0;
+        })
+        .add("depth", {Analysis::LAYERS}, {}, report_depth)
+        .add("single-qubit fusion", {}, {Analysis::INTERACTIONS}, [](qarser::Circuit& c, qarser::AnalysisCache&) {
+            return qarser::SingleQubitFusion().run(c) > 0;
+        })
+        .add("layout", {Analysis::INTERACTIONS}, {}, select_layout)
+        .add("depth", {Analysis::LAYERS}, {}, report_depth)
+        .add("peephole", {}, {}, [](qarser::Circuit& c, qarser::AnalysisCache&) {
+            return qarser::PeepholeOptimizer().run(c) > 0;
+        })
+        .add("depth", {Analysis::LAYERS}, {}, report_depth)
+        .add("peephole", {}, {}, [](qarser::Circuit& c, qarser::AnalysisCache&) {
+            return qarser::PeepholeOptimizer().run(c) > 0;
+        })
+        .add("depth", {Analysis::LAYERS}, {}, report_depth)
+        .add("usage", {Analysis::WIRE_USAGE}, {}, report_usage)
+        .add("layout", {Analysis::INTERACTIONS}, {}, select_layout);
+
+    double managed = time_ms([&] { manager.run(circuit); });
+    uint64_t managed_checksum = checksum;
+    manager.print(std::cout);
+
+    // Same steps, every analysis built from scratch when needed
+    checksum = 0;
+    qarser::Circuit& c = baseline_circuit;
+    double baseline = time_ms([&] {
+        auto fresh = [&](auto&& step) {
+            qarser::AnalysisCache analyses;
+            step(c, analyses);
+        };
+        fresh(select_layout);
+        fresh(report_depth);
+        fresh(report_usage);
+        qarser::DeadOperationElimination().run(c);
+        fresh(report_depth);
+        qarser::SingleQubitFusion().run(c);
+        fresh(select_layout);
+        fresh(report_depth);
+        qarser::PeepholeOptimizer().run(c);
+        fresh(report_depth);
+        qarser::PeepholeOptimizer().run(c);
+        fresh(report_depth);
+        fresh(report_usage);
+        fresh(select_layout);
+    });
+
+    std::cout << "pass manager: " << managed << " ms\n";
+    std::cout << "baseline:     " << baseline << " ms\n";
+    std::cout << "final depth:  " << depth << ", " << circuit.size() << " operations\n";
+    return managed_checksum == checksum ? 0 : 1;
+}
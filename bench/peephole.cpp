@@ -0,0 +1,131 @@
+#include <iostream>
+#include <random>
+#include "parser.h"
+#include "IR/passes/peephole.hpp"
+#include "statevector.hpp"
+#include "timing.hpp"
+
+// Peephole cancellation on 3000 random 4-qubit circuits, built from every
+// gate the standard rules know and full of inverse pairs, nested pairs and
+// rotations that add up to a period, or to 2pi where the period of a
+// controlled rotation is 4pi, each simulated against its optimized
+// form; then a random 10M-gate circuit in which a quarter of the gates
+// are immediately undone, which is timed.
+
+constexpr int kCircuits = 3000;
+constexpr uint32_t kQubits = 256;
+constexpr size_t kGates = 10000000;
+
+static qarser::Circuit random_small_circuit(std::mt19937& rng) {
+    using qarser::OpCode;
+    struct Kind {
+        OpCode code;
+        OpCode inverse;
+        uint32_t num_qubits;
+        double period;      // 0 unless a rotation
+    };
+    const double turn = 2 * M_PI;
+    const Kind kinds[] = {
+        {OpCode::CX, OpCode::CX, 2, 0}, {OpCode::X, OpCode::X, 1, 0}, {OpCode::Y, OpCode::Y, 1, 0},
+        {OpCode::Z, OpCode::Z, 1, 0}, {OpCode::H, OpCode::H, 1, 0}, {OpCode::CZ, OpCode::CZ, 2, 0},
+        {OpCode::CY, OpCode::CY, 2, 0}, {OpCode::SWAP, OpCode::SWAP, 2, 0}, {OpCode::CH, OpCode::CH, 2, 0},
+        {OpCode::CCX, OpCode::CCX, 3, 0}, {OpCode::CSWAP, OpCode::CSWAP, 3, 0}, {OpCode::C3X, OpCode::C3X, 4, 0},
+        {OpCode::S, OpCode::SDG, 1, 0}, {OpCode::SDG, OpCode::S, 1, 0}, {OpCode::T, OpCode::TDG, 1, 0},
+        {OpCode::TDG, OpCode::T, 1, 0}, {OpCode::SX, OpCode::SXDG, 1, 0}, {OpCode::SXDG, OpCode::SX, 1, 0},
+        {OpCode::RX, OpCode::RX, 1, turn}, {OpCode::RY, OpCode::RY, 1, turn}, {OpCode::RZ, OpCode::RZ, 1, turn},
+        {OpCode::U1, OpCode::U1, 1, turn}, {OpCode::P, OpCode::P, 1, turn}, {OpCode::RXX, OpCode::RXX, 2, turn},
+        {OpCode::RZZ, OpCode::RZZ, 2, turn}, {OpCode::CU1, OpCode::CU1, 2, turn}, {OpCode::CP, OpCode::CP, 2, turn},
+        {OpCode::CRX, OpCode::CRX, 2, 2 * turn}, {OpCode::CRY, OpCode::CRY, 2, 2 * turn},
+        {OpCode::CRZ, OpCode::CRZ, 2, 2 * turn},
+    };
+    std::uniform_real_distribution<double> angle(-3.0, 3.0);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", 4);
+    size_t length = 10 + rng() % 31;
+    std::vector<uint32_t> qubits = {0, 1, 2, 3};
+    struct Open {
+        Kind kind;
+        uint32_t wires[4];
+        double theta;
+    };
+    // Operations not yet undone, innermost last
+    std::vector<Open> open;
+    while (circuit.size() < length) {
+        if (!open.empty() && rng() % 2 == 0) {
+            Open last = open.back();
+            open.pop_back();
+            // Undo exactly or up to a whole period; a controlled rotation
+            // by a total of 2pi is not the identity and must stay
+            const double totals[] = {0.0, last.kind.period, turn};
+            double theta = totals[rng() % 3] - last.theta;
+            circuit.add(last.kind.inverse, last.wires, last.kind.num_qubits, &theta, last.kind.period > 0 ? 1 : 0);
+            continue;
+        }
+        Open next{kinds[rng() % (sizeof(kinds) / sizeof(kinds[0]))], {}, angle(rng)};
+        std::shuffle(qubits.begin(), qubits.end(), rng);
+        std::copy(qubits.begin(), qubits.end(), next.wires);
+        circuit.add(next.kind.code, next.wires, next.kind.num_qubits, &next.theta, next.kind.period > 0 ? 1 : 0);
+        if (rng() % 3 != 0) {
+            open.push_back(next);
+        }
+    }
+    return circuit;
+}
+
+int main() {
+    using qarser::OpCode;
+    const OpCode one_qubit[] = {OpCode::H, OpCode::X, OpCode::S, OpCode::T, OpCode::SX};
+    const OpCode inverse[] = {OpCode::H, OpCode::X, OpCode::SDG, OpCode::TDG, OpCode::SXDG};
+
+    std::mt19937 rng(42);
+    bool ok = true;
+    size_t small_gates = 0, small_remaining = 0;
+    for (int i = 0; i < kCircuits; ++i) {
+        qarser::Circuit original = random_small_circuit(rng);
+        qarser::Circuit optimized = original;
+        size_t removed = qarser::PeepholeOptimizer().run(optimized);
+        ok = ok && original.size() - removed == optimized.size() && equivalent(original, optimized, rng);
+        small_gates += original.size();
+        small_remaining += optimized.size();
+    }
+
+    std::uniform_real_distribution<double> angle(-3.0, 3.0);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", kQubits);
+    circuit.reserve(kGates, 2 * kGates, kGates);
+    while (circuit.size() < kGates) {
+        uint32_t a = rng() % kQubits;
+        uint32_t b = (a + 1 + rng() % (kQubits - 1)) % kQubits;
+        int g = rng() % 5;
+        switch (rng() % 8) {
+            case 0:
+                circuit.add(one_qubit[g], {a});
+                circuit.add(inverse[g], {a});
+                break;
+            case 1: {
+                double theta = angle(rng);
+                circuit.add(OpCode::RZ, {a}, {theta});
+                circuit.add(OpCode::RZ, {a}, {-theta});
+                break;
+            }
+            case 2: case 3: case 4: circuit.add(OpCode::CX, {a, b}); break;
+            case 5: circuit.add(OpCode::RZ, {a}, {angle(rng)}); break;
+            default: circuit.add(one_qubit[g], {a}); break;
+        }
+    }
+
+    size_t before = circuit.size();
+    size_t removed = 0;
+    qarser::PeepholeOptimizer optimizer;
+    double ms = time_ms([&] { removed = optimizer.run(circuit); });
+
+    ok = ok && before - removed == circuit.size();
+
+    std::cout << "small:        " << kCircuits << " circuits, " << small_gates << " -> " << small_remaining
+              << " gates, " << (ok ? "equivalent" : "MISMATCH") << "\n";
+    std::cout << "gates:        " << before << "\n";
+    std::cout << "removed:      " << removed << "\n";
+    std::cout << "remaining:    " << circuit.size() << "\n";
+    std::cout << "time:         " << ms << " ms (" << before / ms / 1000.0 << " Mgates/s)\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <random>
+#include "parser.h"
+#include "IR/passes/phase_folding.hpp"
+#include "statevector.hpp"
+#include "timing.hpp"
+
+// Phase folding on a random 10M-gate Clifford+T circuit over 4096 qubits,
+// built from Toffoli-like blocks whose T phases partly cancel. 2000 small
+// circuits from the same generator, on 4 and 5 qubits, are first simulated
+// against their folded form.
+
+constexpr uint32_t kQubits = 4096;
+constexpr size_t kGates = 10000000;
+constexpr int kCircuits = 2000;
+
+static qarser::Circuit random_circuit(uint32_t num_qubits, size_t num_gates, std::mt19937& rng) {
+    using qarser::OpCode;
+    const OpCode phases[] = {OpCode::T, OpCode::TDG, OpCode::S, OpCode::Z};
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", num_qubits);
+    circuit.reserve(num_gates, 2 * num_gates, 0);
+    while (circuit.size() < num_gates) {
+        uint32_t a = rng() % num_qubits;
+        uint32_t b = (a + 1 + rng() % (num_qubits - 1)) % num_qubits;
+        switch (rng() % 8) {
+            case 0: circuit.add(OpCode::H, {b}); break;
+            case 1: case 2: case 3: circuit.add(OpCode::CX, {a, b}); break;
+            case 4:
+                // Phases on the same parity, separated by a CX pair
+                circuit.add(OpCode::T, {b});
+                circuit.add(OpCode::CX, {a, b});
+                circuit.add(phases[rng() % 4], {b});
+                circuit.add(OpCode::CX, {a, b});
+                circuit.add(OpCode::TDG, {b});
+                break;
+            default: circuit.add(phases[rng() % 4], {a}); break;
+        }
+    }
+    return circuit;
+}
+
+int main() {
+    std::mt19937 rng(42);
+    int mismatches = 0;
+    size_t t_before = 0, t_after = 0;
+    for (int i = 0; i < kCircuits; ++i) {
+        qarser::Circuit small = random_circuit(4 + i % 2, 20 + rng() % 41, rng);
+        qarser::Circuit folded = small;
+        qarser::PhaseFoldingReport small_report = qarser::PhaseFolding().run(folded);
+        t_before += small_report.t_count_before;
+        t_after += small_report.t_count_after;
+        if (!equivalent(small, folded, rng)) {
+            ++mismatches;
+        }
+    }
+
+    qarser::Circuit circuit = random_circuit(kQubits, kGates, rng);
+    qarser::PhaseFoldingReport report;
+    qarser::PhaseFolding folding;
+    double ms = time_ms([&] { report = folding.run(circuit); });
+
+    std::cout << "gates:        " << kGates << " on " << kQubits << " qubits\n";
+    std::cout << "T count:      " << report.t_count_before << " -> " << report.t_count_after << "\n";
+    std::cout << "CX count:     " << report.cx_count_before << " -> " << report.cx_count_after << "\n";
+    std::cout << "time:         " << ms << " ms (" << kGates / ms / 1000.0 << " Mgates/s)\n";
+    std::cout << "small:        " << kCircuits << " circuits, T count " << t_before << " -> " << t_after
+              << ", " << mismatches << " mismatches\n";
+    return mismatches == 0 && t_after < t_before && report.t_count_after <= report.t_count_before ? 0 : 1;
+}
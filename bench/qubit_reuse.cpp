@@ -0,0 +1,92 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "IR/passes/qubit_reuse.hpp"
+#include "timing.hpp"
+
+// Qubit reuse on a syndrome-extraction style circuit: 256 data qubits and
+// 200k ancillas, each entangled with a few data qubits and then measured.
+// The ancillas take turns on one wire, so the width must drop to 257 with
+// one reset per reused ancilla. A small circuit that only narrows when
+// rescheduled is checked as well.
+
+constexpr uint32_t kData = 256;
+constexpr uint32_t kAncillas = 200000;
+
+// Every inserted reset directly follows a measurement on its wire and is followed by another operation
+static bool resets_between_segments(const qarser::Circuit& circuit, size_t expected) {
+    std::vector<qarser::OpCode> previous(circuit.get_num_qubits(), qarser::OpCode::BARRIER);
+    std::vector<bool> started(circuit.get_num_qubits(), false);
+    size_t resets = 0;
+    for (const auto& op : circuit.get_operations()) {
+        if (op.code == qarser::OpCode::BARRIER) {
+            continue;
+        }
+        for (uint32_t wire : circuit.qubits(op)) {
+            if (op.code == qarser::OpCode::RESET &&
+                (!started[wire] || previous[wire] != qarser::OpCode::MEASURE)) {
+                return false;
+            }
+            started[wire] = true;
+            previous[wire] = op.code;
+        }
+        resets += op.code == qarser::OpCode::RESET;
+    }
+    for (qarser::OpCode code : previous) {
+        if (code == qarser::OpCode::RESET) {
+            return false;
+        }
+    }
+    return resets == expected;
+}
+
+int main() {
+    using qarser::OpCode;
+
+    std::mt19937 rng(42);
+    qarser::Circuit circuit;
+    circuit.add_qreg("data", kData);
+    circuit.add_qreg("anc", kAncillas);
+    circuit.add_creg("c", kAncillas);
+    circuit.reserve(6 * size_t(kAncillas), 10 * size_t(kAncillas), 0);
+    for (uint32_t a = 0; a < kAncillas; ++a) {
+        uint32_t ancilla = kData + a;
+        circuit.add(OpCode::H, {ancilla});
+        for (int k = 0; k < 4; ++k) {
+            circuit.add(OpCode::CX, {ancilla, static_cast<uint32_t>(rng() % kData)});
+        }
+        uint32_t clbit = a;
+        circuit.add(OpCode::MEASURE, &ancilla, 1, nullptr, 0, &clbit, 1);
+    }
+
+    qarser::QubitReuseResult result;
+    double ms = time_ms([&] { result = qarser::QubitReuse().run(circuit); });
+
+    std::cout << "operations:   " << circuit.size() << "\n";
+    std::cout << "width:        " << result.width_before << " -> " << result.width_after
+              << (result.reordered ? " (rescheduled)" : " (program order)") << "\n";
+    std::cout << "resets:       " << result.resets << "\n";
+    std::cout << "time:         " << ms << " ms\n";
+    bool ok = result.width_after == kData + 1 && result.resets == kAncillas - 1 &&
+              resets_between_segments(result.circuit, result.resets);
+    for (uint32_t a = 0; a < kAncillas; ++a) {
+        ok = ok && result.wires[kData + a].size() == 1 && result.wires[kData + a][0] == result.wires[kData][0];
+    }
+
+    // Program order keeps both ancillas alive at once; measuring the first early frees its wire
+    qarser::Circuit small;
+    small.add_qreg("q", 2);
+    small.add_creg("c", 2);
+    small.add(OpCode::H, {0});
+    small.add(OpCode::H, {1});
+    for (uint32_t q = 0; q < 2; ++q) {
+        small.add(OpCode::MEASURE, &q, 1, nullptr, 0, &q, 1);
+    }
+    auto narrowed = qarser::QubitReuse().run(small);
+    ok = ok && narrowed.width_after == 1 && narrowed.reordered && narrowed.resets == 1 &&
+         resets_between_segments(narrowed.circuit, 1);
+    std::cout << "small:        " << narrowed.width_before << " -> " << narrowed.width_after
+              << (narrowed.reordered ? " (rescheduled)" : " (program order)") << "\n";
+    std::cout << "check:        " << (ok ? "as expected" : "WRONG") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "SA/analyzer.hpp"
+#include "AST/compressor.hpp"
+#include "timing.hpp"
+
+// Qubit usage of a small program with a CX ladder, a stride-2 layer and
+// nested blocks, checked against hand-computed sets before and after
+// repeat compression; then a 2000-step Trotter chain on 256 qubits,
+// analyzed raw and compressed.
+
+constexpr int kQubits = 256;
+constexpr int kSteps = 2000;
+
+static qarser::QubitUsage usage_of(qarser::Program& program, double* ms = nullptr) {
+    qarser::SemanticAnalyzer analyzer;
+    analyzer.analyze(program);
+    qarser::QubitUsageAnalyzer usage(analyzer.get_context());
+    double elapsed = time_ms([&] { program.accept(usage); });
+    if (ms) {
+        *ms = elapsed;
+    }
+    return usage.get_usage();
+}
+
+static bool expect(const qarser::QubitUsage& usage, const std::string& name,
+                   const std::vector<size_t>& used, const std::vector<size_t>& measured) {
+    const auto* reg = usage.find(name);
+    if (!reg || reg->used.to_indices() != used || reg->measured.to_indices() != measured) {
+        std::cout << "register " << name << " differs\n";
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[8];\nqreg a[7];\nqreg g[12];\ncreg c[8];\nh q[0];\n";
+    for (int i = 0; i < 5; ++i) {
+        source += "cx q[" + std::to_string(i) + "], q[" + std::to_string(i + 1) + "];\n";
+    }
+    for (int i = 0; i < 6; i += 2) {
+        source += "rz(0.1) a[" + std::to_string(i) + "];\n";
+    }
+    for (int r = 0; r < 3; ++r) {
+        source += "x g[" + std::to_string(4 * r) + "];\nx g[" + std::to_string(4 * r + 1) + "];\nt q[7];\n";
+    }
+    for (int i = 0; i < 3; ++i) {
+        source += "measure q[" + std::to_string(i) + "] -> c[" + std::to_string(i) + "];\n";
+    }
+
+    bool ok = true;
+    auto raw = qarser::Parser(source).parse();
+    auto compressed = qarser::Parser(source).parse();
+    auto report = qarser::RepeatCompressor().compress(*compressed);
+    for (auto* program : {raw.get(), compressed.get()}) {
+        auto usage = usage_of(*program);
+        ok = expect(usage, "q", {0, 1, 2, 3, 4, 5, 7}, {0, 1, 2}) && ok;
+        ok = expect(usage, "a", {0, 2, 4}, {}) && ok;
+        ok = expect(usage, "g", {0, 1, 4, 5, 8, 9}, {}) && ok;
+    }
+
+    // Every qubit of a chain measured but the last
+    source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" + std::to_string(kQubits) + "];\n";
+    source += "creg c[" + std::to_string(kQubits) + "];\n";
+    for (int step = 0; step < kSteps; ++step) {
+        for (int i = 0; i + 1 < kQubits; ++i) {
+            source += "rzz(0.05) q[" + std::to_string(i) + "], q[" + std::to_string(i + 1) + "];\n";
+        }
+        for (int i = 0; i < kQubits; ++i) {
+            source += "rx(0.1) q[" + std::to_string(i) + "];\n";
+        }
+    }
+    for (int i = 0; i + 1 < kQubits; ++i) {
+        source += "measure q[" + std::to_string(i) + "] -> c[" + std::to_string(i) + "];\n";
+    }
+    auto chain = qarser::Parser(source).parse();
+    double raw_ms = 0, compressed_ms = 0;
+    auto raw_usage = usage_of(*chain, &raw_ms);
+    auto chain_report = qarser::RepeatCompressor().compress(*chain);
+    auto compressed_usage = usage_of(*chain, &compressed_ms);
+    const auto& reg = compressed_usage.get_registers().front();
+    ok = ok && reg.used.count() == kQubits && reg.unmeasured().to_indices() == std::vector<size_t>{kQubits - 1} &&
+         reg.used == raw_usage.get_registers().front().used &&
+         reg.measured == raw_usage.get_registers().front().measured;
+
+    std::cout << "small program: " << report.statements_before << " -> " << report.statements_after
+              << " statements (" << report.repeats << " repeats), usage " << (ok ? "as expected" : "DIFFERS") << "\n";
+    std::cout << "chain:         " << chain_report.statements_before << " -> " << chain_report.statements_after
+              << " statements, usage " << raw_ms << " ms -> " << compressed_ms << " ms\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "SA/analyzer.hpp"
+#include "AST/compressor.hpp"
+#include "IR/lowering.hpp"
+#include "timing.hpp"
+
+// A Trotterized Ising chain: 2000 steps of an RZZ ladder and an RX layer
+// over 256 qubits (about 1M statements), analyzed, costed and lowered
+// from the raw AST and from its compressed form. Compression must not
+// change diagnostics: a CX ladder running off its register, and 500
+// random programs of translated blocks with out-of-range, undeclared,
+// aliased and miscounted calls, must report the same errors on the same
+// lines raw and compressed, also under an error limit.
+
+constexpr int kQubits = 256;
+constexpr int kSteps = 2000;
+constexpr int kPrograms = 500;
+
+struct Timings {
+    double analyze = 0;
+    double cost = 0;
+    double lower = 0;
+    qarser::GateCost total;
+    size_t operations = 0;
+};
+
+Timings run(qarser::Program& program) {
+    Timings t;
+    qarser::SemanticAnalyzer analyzer;
+    t.analyze = time_ms([&] { analyzer.analyze(program); });
+    qarser::GateCostAnalyzer costs(analyzer.get_context());
+    t.cost = time_ms([&] { program.accept(costs); });
+    t.total = costs.get_total();
+    qarser::Circuit circuit;
+    t.lower = time_ms([&] { circuit = qarser::CircuitLowering(analyzer.get_context().get_library()).lower(program); });
+    t.operations = circuit.size();
+    return t;
+}
+
+static std::vector<std::string> diagnostics(qarser::Program& program, size_t limit = 0) {
+    qarser::SemanticAnalyzer analyzer;
+    analyzer.set_error_limit(limit);
+    analyzer.analyze(program);
+    const auto& errors = analyzer.get_context().get_errors();
+    std::vector<std::string> result;
+    for (const auto& err : errors.get_errors()) {
+        result.push_back(std::to_string(err.line) + ": " + errors.format(err));
+    }
+    result.push_back(std::to_string(errors.get_dropped()) + " dropped");
+    return result;
+}
+
+// Diagnostics of `source`, raw and compressed, agree; the compressed program is analyzed twice
+static bool same_diagnostics(const std::string& source, size_t limit = 0) {
+    auto raw = qarser::Parser(source).parse();
+    auto compressed = qarser::Parser(source).parse();
+    qarser::RepeatCompressor().compress(*compressed);
+    auto expected = diagnostics(*raw, limit);
+    return diagnostics(*compressed, limit) == expected && diagnostics(*compressed, limit) == expected;
+}
+
+// Blocks of one to three statements copied with their indices moved by a fixed stride
+static std::string random_program(std::mt19937& rng) {
+    std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[8];\nqreg r[5];\ncreg c[8];\n";
+    auto index = [](int i) { return "[" + std::to_string(i) + "]"; };
+    for (int block = 0; block < 6; ++block) {
+        int period = 1 + rng() % 3, copies = 2 + rng() % 8, stride = int(rng() % 3) - 1;
+        std::vector<int> kinds(period), starts(period);
+        for (int t = 0; t < period; ++t) {
+            kinds[t] = rng() % 8;
+            starts[t] = rng() % 6 + (stride < 0 ? copies - 1 : 0);
+        }
+        std::string gap = rng() % 4 ? "\n" : "\n\n";
+        for (int copy = 0; copy < copies; ++copy) {
+            for (int t = 0; t < period; ++t) {
+                int i = starts[t] + copy * stride;
+                switch (kinds[t]) {
+                    case 0: source += "cx q" + index(i) + ", q" + index(i + 1) + ";"; break;
+                    case 1: source += "h r" + index(i) + ";"; break;
+                    case 2: source += "foo q" + index(i) + ";"; break;
+                    case 3: source += "cx q" + index(i) + ", q" + index(starts[t] + 2) + ";"; break;
+                    case 4: source += "rz(0.1, 0.2) q" + index(i) + ";"; break;
+                    case 5: source += "measure q" + index(i) + " -> c" + index(i) + ";"; break;
+                    case 6: source += "reset r" + index(i) + ";"; break;
+                    default: source += "cx r" + index(i) + ", q" + index(i + 3) + ";"; break;
+                }
+                source += gap;
+            }
+        }
+    }
+    return source;
+}
+
+int main() {
+    // q[7], q[8] and q[8], q[9] run off the register on lines 12 and 13
+    std::string ladder = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[8];\ncreg c[8];\n";
+    for (int i = 0; i < 9; ++i) {
+        ladder += "cx q[" + std::to_string(i) + "], q[" + std::to_string(i + 1) + "];\n";
+    }
+    auto compressed_ladder = qarser::Parser(ladder).parse();
+    qarser::RepeatCompressor().compress(*compressed_ladder);
+    auto ladder_errors = diagnostics(*compressed_ladder);
+    bool diagnostics_ok = ladder_errors.size() == 3 && ladder_errors[0].rfind("12: ", 0) == 0 &&
+                          ladder_errors[1].rfind("13: ", 0) == 0 && same_diagnostics(ladder);
+
+    std::mt19937 rng(47);
+    int mismatches = 0;
+    for (int i = 0; i < kPrograms; ++i) {
+        std::string program = random_program(rng);
+        if (!same_diagnostics(program) || !same_diagnostics(program, 1 + rng() % 4)) {
+            ++mismatches;
+        }
+    }
+    diagnostics_ok = diagnostics_ok && mismatches == 0;
+
+    std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" + std::to_string(kQubits) + "];\n";
+    source += "creg c[" + std::to_string(kQubits) + "];\nh q;\n";
+    for (int step = 0; step < kSteps; ++step) {
+        for (int i = 0; i + 1 < kQubits; ++i) {
+            source += "rzz(0.05) q[" + std::to_string(i) + "], q[" + std::to_string(i + 1) + "];\n";
+        }
+        for (int i = 0; i < kQubits; ++i) {
+            source += "rx(0.1) q[" + std::to_string(i) + "];\n";
+        }
+    }
+    source += "measure q -> c;\n";
+
+    auto raw = qarser::Parser(source).parse();
+    auto compressed = qarser::Parser(source).parse();
+    qarser::CompressionReport report;
+    double compress_ms = time_ms([&] { report = qarser::RepeatCompressor().compress(*compressed); });
+
+    Timings a = run(*raw);
+    Timings b = run(*compressed);
+
+    std::cout << "statements:   " << report.statements_before << " -> " << report.statements_after
+              << " (" << report.repeats << " repeats, " << compress_ms << " ms)\n";
+    std::cout << "analyze:      " << a.analyze << " ms -> " << b.analyze << " ms\n";
+    std::cout << "cost:         " << a.cost << " ms -> " << b.cost << " ms (depth " << a.total.depth
+              << " / " << b.total.depth << ")\n";
+    std::cout << "lower:        " << a.lower << " ms -> " << b.lower << " ms (" << b.operations << " operations)\n";
+    std::cout << "diagnostics:  " << (diagnostics_ok ? "unchanged" : "CHANGED") << " by compression ("
+              << mismatches << " of " << kPrograms << " random programs differ)\n";
+    bool same = a.operations == b.operations && a.total.depth == b.total.depth &&
+                a.total.two_qubit == b.total.two_qubit && a.total.one_qubit == b.total.one_qubit;
+    return same && diagnostics_ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "IR/passes/sabre_routing.hpp"
+#include "timing.hpp"
+
+// SABRE routing of a random 20k-gate circuit onto a 20x20 grid, with the
+// trials spread over the shared thread pool. The routed circuit is
+// replayed from the initial layout: every two-qubit gate and SWAP must be
+// on adjacent physical qubits, the SWAPs must end at the final layout, and
+// every logical qubit must see the same sequence of gates as in the input.
+
+constexpr uint32_t kRows = 20;
+constexpr uint32_t kColumns = 20;
+constexpr size_t kGates = 20000;
+
+using Wires = std::vector<std::vector<std::vector<uint32_t>>>;  // logical qubit -> gates as {code, qubits...}
+
+static void record(Wires& wires, qarser::OpCode code, const std::vector<uint32_t>& logical) {
+    std::vector<uint32_t> gate{static_cast<uint32_t>(code)};
+    gate.insert(gate.end(), logical.begin(), logical.end());
+    for (uint32_t q : logical) {
+        wires[q].push_back(gate);
+    }
+}
+
+static bool replays(const qarser::Circuit& circuit, const qarser::RoutingResult& result,
+                    const qarser::CouplingMap& coupling) {
+    Wires expected(circuit.get_num_qubits()), routed(circuit.get_num_qubits());
+    for (const auto& op : circuit.get_operations()) {
+        auto qubits = circuit.qubits(op);
+        record(expected, op.code, std::vector<uint32_t>(qubits.begin(), qubits.end()));
+    }
+
+    qarser::Layout layout = result.initial_layout;
+    for (const auto& op : result.circuit.get_operations()) {
+        auto qubits = result.circuit.qubits(op);
+        if (op.num_qubits == 2 && !coupling.adjacent(qubits[0], qubits[1])) {
+            return false;
+        }
+        std::vector<uint32_t> logical;
+        for (uint32_t p : qubits) logical.push_back(layout.to_logical[p]);
+        if (op.code != qarser::OpCode::SWAP) {
+            record(routed, op.code, logical);
+            continue;
+        }
+        std::swap(layout.to_logical[qubits[0]], layout.to_logical[qubits[1]]);
+        layout.to_physical[logical[0]] = qubits[1];
+        layout.to_physical[logical[1]] = qubits[0];
+    }
+    return layout.to_physical == result.final_layout.to_physical &&
+           layout.to_logical == result.final_layout.to_logical && routed == expected;
+}
+
+int main() {
+    using qarser::OpCode;
+    constexpr uint32_t kQubits = kRows * kColumns;
+
+    std::mt19937 rng(42);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", kQubits);
+    circuit.reserve(kGates, 2 * kGates, 0);
+    for (size_t i = 0; i < kGates; ++i) {
+        uint32_t a = rng() % kQubits;
+        if (rng() % 2 == 0) {
+            circuit.add(OpCode::H, {a});
+            continue;
+        }
+        // Mostly nearby partners, as in circuits that were laid out by hand
+        uint32_t b = rng() % 4 == 0 ? rng() % kQubits : (a + 1 + rng() % 8) % kQubits;
+        if (b == a) {
+            b = (a + 1) % kQubits;
+        }
+        circuit.add(OpCode::CX, {a, b});
+    }
+
+    auto coupling = qarser::CouplingMap::grid(kRows, kColumns);
+    qarser::SabreOptions options;
+    options.seed = 7;
+    qarser::SabreRouter router(coupling, options);
+
+    qarser::RoutingResult result;
+    double ms = time_ms([&] { result = router.route(circuit); });
+
+    std::cout << "gates:        " << kGates << " on a " << kRows << "x" << kColumns << " grid\n";
+    std::cout << "trials:       " << options.trials << " (best: " << result.trial << ")\n";
+    std::cout << "swaps:        " << result.swaps << "\n";
+    std::cout << "time:         " << ms << " ms (" << kGates / ms / 1000.0 << " Mgates/s)\n";
+    bool ok = replays(circuit, result, coupling);
+    std::cout << "replay:       " << (ok ? "adjacent, ends at the final layout" : "WRONG") << "\n";
+    return ok && result.circuit.size() == kGates + result.swaps ? 0 : 1;
+}
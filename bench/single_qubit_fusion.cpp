@@ -0,0 +1,94 @@
+#include <iostream>
+#include <random>
+#include "parser.h"
+#include "IR/passes/single_qubit_fusion.hpp"
+#include "statevector.hpp"
+#include "timing.hpp"
+
+// Single-qubit fusion of runs that multiply to the identity, exactly or up
+// to roundoff, and of runs only a small rotation away from it that must
+// survive; then 2000 random 4-qubit circuits simulated against their fused
+// form, and a random 2M-gate circuit on 256 qubits that is timed.
+
+constexpr int kCircuits = 2000;
+constexpr uint32_t kQubits = 256;
+constexpr size_t kGates = 2000000;
+
+static qarser::Circuit random_circuit(uint32_t num_qubits, size_t num_gates, std::mt19937& rng) {
+    using qarser::OpCode;
+    const OpCode fixed[] = {OpCode::H, OpCode::X, OpCode::Y, OpCode::Z, OpCode::S, OpCode::SDG,
+                            OpCode::T, OpCode::TDG, OpCode::SX, OpCode::SXDG};
+    const OpCode rotation[] = {OpCode::RZ, OpCode::RX, OpCode::RY, OpCode::P, OpCode::U1};
+    std::uniform_real_distribution<double> angle(-3.0, 3.0);
+    qarser::Circuit circuit;
+    circuit.add_qreg("q", num_qubits);
+    while (circuit.size() < num_gates) {
+        uint32_t a = rng() % num_qubits;
+        uint32_t b = (a + 1 + rng() % (num_qubits - 1)) % num_qubits;
+        switch (rng() % 8) {
+            case 0: case 1: case 2: circuit.add(fixed[rng() % 10], {a}); break;
+            case 3: case 4: circuit.add(rotation[rng() % 5], {a}, {angle(rng)}); break;
+            case 5: circuit.add(OpCode::U, {a}, {angle(rng), angle(rng), angle(rng)}); break;
+            default: circuit.add(OpCode::CX, {a, b}); break;
+        }
+    }
+    return circuit;
+}
+
+// Size of `circuit` after fusion, which must leave it equivalent
+static size_t fused_size(const qarser::Circuit& circuit, std::mt19937& rng, bool& ok) {
+    qarser::Circuit fused = circuit;
+    qarser::SingleQubitFusion().run(fused);
+    ok = ok && equivalent(circuit, fused, rng);
+    return fused.size();
+}
+
+int main() {
+    using qarser::OpCode;
+    std::mt19937 rng(39);
+    bool ok = true;
+
+    // h; rz(theta); h is rx(theta): gone for theta = 0 or 2pi, kept otherwise
+    size_t sizes[4];
+    const double thetas[] = {0.0, 2 * M_PI, 5e-5, 1e-7};
+    for (int i = 0; i < 4; ++i) {
+        qarser::Circuit circuit;
+        circuit.add_qreg("q", 1);
+        circuit.add(OpCode::H, {0});
+        circuit.add(OpCode::RZ, {0}, {thetas[i]});
+        circuit.add(OpCode::H, {0});
+        sizes[i] = fused_size(circuit, rng, ok);
+    }
+    ok = ok && sizes[0] == 0 && sizes[1] == 0 && sizes[2] == 1 && sizes[3] == 1;
+
+    // An identity only up to roundoff is still removed
+    qarser::Circuit undone;
+    undone.add_qreg("q", 1);
+    undone.add(OpCode::RX, {0}, {1.234});
+    undone.add(OpCode::RX, {0}, {-1.234});
+    undone.add(OpCode::RY, {0}, {0.3});
+    undone.add(OpCode::RY, {0}, {-0.3});
+    size_t undone_size = fused_size(undone, rng, ok);
+    ok = ok && undone_size == 0;
+
+    size_t gates = 0, remaining = 0;
+    for (int i = 0; i < kCircuits; ++i) {
+        qarser::Circuit circuit = random_circuit(4, 20 + rng() % 41, rng);
+        gates += circuit.size();
+        remaining += fused_size(circuit, rng, ok);
+    }
+
+    qarser::Circuit large = random_circuit(kQubits, kGates, rng);
+    size_t before = large.size();
+    size_t removed = 0;
+    double ms = time_ms([&] { removed = qarser::SingleQubitFusion().run(large); });
+
+    std::cout << "h rz h:       " << sizes[0] << ", " << sizes[1] << ", " << sizes[2] << ", " << sizes[3]
+              << " ops for rz(0), rz(2pi), rz(5e-5), rz(1e-7)\n";
+    std::cout << "undone:       " << undone_size << " ops for rx(a) rx(-a) ry(b) ry(-b)\n";
+    std::cout << "circuits:     " << kCircuits << " (" << gates << " -> " << remaining << " gates)\n";
+    std::cout << "equivalent:   " << (ok ? "yes" : "NO") << "\n";
+    std::cout << "large:        " << before << " -> " << large.size() << " gates\n";
+    std::cout << "time:         " << ms << " ms (" << before / ms / 1000.0 << " Mgates/s)\n";
+    return ok && before - removed == large.size() ? 0 : 1;
+}
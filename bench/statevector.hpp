@@ -0,0 +1,184 @@
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "IR/inliner.hpp"
+#include "IR/matrix.hpp"
+
+// State-vector simulation for the benches that check a pass against the
+// circuit it was given. Circuits are inlined to U and CX through the
+// qelib1 definitions first, so every gate is simulated from its
+// definition rather than from a second hand-written matrix table.
+// Measurements and resets are simulated by branching on their outcome.
+
+class StateVector {
+private:
+    std::vector<qarser::Complex> amplitudes;
+
+public:
+    // |0...0>
+    explicit StateVector(uint32_t num_qubits)
+        : amplitudes(size_t{1} << num_qubits, 0.0) {
+        amplitudes[0] = 1.0;
+    }
+
+    // Uniformly random amplitudes, normalized
+    static StateVector random(uint32_t num_qubits, std::mt19937& rng) {
+        std::normal_distribution<double> normal;
+        StateVector state(num_qubits);
+        double norm = 0;
+        for (auto& amplitude : state.amplitudes) {
+            amplitude = {normal(rng), normal(rng)};
+            norm += std::norm(amplitude);
+        }
+        for (auto& amplitude : state.amplitudes) {
+            amplitude /= std::sqrt(norm);
+        }
+        return state;
+    }
+
+    // Applies a unitary circuit; qubit q is bit q of the amplitude index
+    void run(const qarser::Circuit& circuit, const qarser::GateLibrary& library = qarser::GateLibrary::qelib1()) {
+        qarser::Circuit flat = qarser::Inliner(library).inline_circuit(circuit);
+        for (const auto& op : flat.get_operations()) {
+            step(flat, op);
+        }
+    }
+
+    // Applies one U, CX or barrier of an inlined circuit
+    void step(const qarser::Circuit& flat, const qarser::Operation& op) {
+        auto qubits = flat.qubits(op);
+        switch (op.code) {
+            case qarser::OpCode::U: {
+                auto p = flat.params(op);
+                apply(qarser::Matrix2::u(p[0], p[1], p[2]), qubits[0], -1);
+                break;
+            }
+            case qarser::OpCode::CX:
+                flip(qubits[1], static_cast<int>(qubits[0]));
+                break;
+            case qarser::OpCode::BARRIER:
+                break;
+            default:
+                throw std::invalid_argument(std::string("Cannot simulate ") + flat.name(op));
+        }
+    }
+
+    // Probability that measuring `qubit` gives 1
+    double probability_one(uint32_t qubit) const {
+        double p = 0;
+        for (size_t i = 0; i < amplitudes.size(); ++i) {
+            if (i & (size_t{1} << qubit)) p += std::norm(amplitudes[i]);
+        }
+        return p;
+    }
+
+    // Projects `qubit` onto `outcome`, which must have a non-zero probability, and renormalizes
+    void collapse(uint32_t qubit, bool outcome) {
+        double norm = 0;
+        for (size_t i = 0; i < amplitudes.size(); ++i) {
+            if (((i >> qubit) & 1) != outcome) {
+                amplitudes[i] = 0.0;
+            }
+            norm += std::norm(amplitudes[i]);
+        }
+        for (auto& amplitude : amplitudes) {
+            amplitude /= std::sqrt(norm);
+        }
+    }
+
+    // X on `target`, controlled on `control` if it is not negative
+    void flip(uint32_t target, int control = -1) {
+        apply(qarser::Matrix2{0.0, 1.0, 1.0, 0.0}, target, control);
+    }
+
+    // Whether both states are equal up to a global phase
+    bool equals_up_to_phase(const StateVector& other, double tolerance = 1e-9) const {
+        qarser::Complex overlap = 0.0;
+        for (size_t i = 0; i < amplitudes.size(); ++i) {
+            overlap += std::conj(amplitudes[i]) * other.amplitudes[i];
+        }
+        return amplitudes.size() == other.amplitudes.size() && std::abs(1.0 - std::abs(overlap)) < tolerance;
+    }
+
+private:
+    void apply(const qarser::Matrix2& m, uint32_t target, int control) {
+        size_t bit = size_t{1} << target;
+        for (size_t i = 0; i < amplitudes.size(); ++i) {
+            if ((i & bit) || (control >= 0 && !(i & (size_t{1} << control)))) {
+                continue;
+            }
+            qarser::Complex x = amplitudes[i], y = amplitudes[i | bit];
+            amplitudes[i] = m.a * x + m.b * y;
+            amplitudes[i | bit] = m.c * x + m.d * y;
+        }
+    }
+};
+
+
+// Whether two unitary circuits on the same qubits agree up to a global phase on `trials` random states
+inline bool equivalent(const qarser::Circuit& a, const qarser::Circuit& b, std::mt19937& rng, int trials = 2) {
+    for (int t = 0; t < trials; ++t) {
+        StateVector x = StateVector::random(a.get_num_qubits(), rng);
+        StateVector y = x;
+        x.run(a);
+        y.run(b);
+        if (!x.equals_up_to_phase(y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Probability of each classical outcome, bit c of the index being clbit c, when `circuit` runs from |0...0>
+inline std::vector<double> outcome_distribution(const qarser::Circuit& circuit,
+                                                const qarser::GateLibrary& library = qarser::GateLibrary::qelib1()) {
+    struct Branch {
+        StateVector state;
+        size_t clbits;
+        double probability;
+    };
+    qarser::Circuit flat = qarser::Inliner(library).inline_circuit(circuit);
+    std::vector<Branch> branches{{StateVector(flat.get_num_qubits()), 0, 1.0}};
+    std::vector<Branch> next;
+    for (const auto& op : flat.get_operations()) {
+        if (op.code != qarser::OpCode::MEASURE && op.code != qarser::OpCode::RESET) {
+            for (auto& branch : branches) {
+                branch.state.step(flat, op);
+            }
+            continue;
+        }
+        uint32_t qubit = flat.qubits(op)[0];
+        next.clear();
+        for (const auto& branch : branches) {
+            double one = branch.state.probability_one(qubit);
+            for (bool outcome : {false, true}) {
+                double p = outcome ? one : 1.0 - one;
+                if (p < 1e-12) {
+                    continue;
+                }
+                Branch child = branch;
+                child.state.collapse(qubit, outcome);
+                child.probability *= p;
+                if (op.code == qarser::OpCode::MEASURE) {
+                    size_t bit = size_t{1} << flat.clbits(op)[0];
+                    child.clbits = outcome ? child.clbits | bit : child.clbits & ~bit;
+                }
+                else if (outcome) {
+                    child.state.flip(qubit);
+                }
+                next.push_back(std::move(child));
+            }
+        }
+        branches.swap(next);
+    }
+
+    std::vector<double> distribution(size_t{1} << flat.get_num_clbits(), 0.0);
+    for (const auto& branch : branches) {
+        distribution[branch.clbits] += branch.probability;
+    }
+    return distribution;
+}
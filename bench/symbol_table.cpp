@@ -0,0 +1,64 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SA/context/symbol.hpp"
+#include "timing.hpp"
+
+// 1M lookups over 10k symbols, compared against a plain std::unordered_map.
+
+constexpr int kSymbols = 10000;
+constexpr int kLookups = 1000000;
+
+int main() {
+    std::vector<std::string> names;
+    names.reserve(kSymbols);
+    for (int i = 0; i < kSymbols; ++i) {
+        names.push_back((i % 3 == 0 ? "q" : i % 3 == 1 ? "c" : "g") + std::to_string(i));
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, kSymbols - 1);
+    std::vector<int> queries(kLookups);
+    for (auto& q : queries) {
+        q = pick(rng);
+    }
+
+    qarser::SymbolTable table;
+    std::unordered_map<std::string, qarser::Symbol> baseline;
+    for (int i = 0; i < kSymbols; ++i) {
+        switch (i % 3) {
+            case 0: table.add_qreg(names[i], 1 + i % 64); break;
+            case 1: table.add_creg(names[i], 1 + i % 64); break;
+            case 2: table.add_gate(names[i], i % 4, 1 + i % 64); break;
+        }
+        baseline.emplace(names[i], *table.lookup(names[i]));
+    }
+
+    long long checksum_table = 0;
+    double table_ms = time_ms([&] {
+        for (int q : queries) {
+            checksum_table += table.lookup(names[q])->width;
+        }
+    });
+
+    long long checksum_baseline = 0;
+    double baseline_ms = time_ms([&] {
+        for (int q : queries) {
+            checksum_baseline += baseline.find(names[q])->second.width;
+        }
+    });
+
+    std::cout << "symbols: " << kSymbols << ", lookups: " << kLookups << "\n"
+              << "SymbolTable:        " << table_ms << " ms ("
+              << table_ms * 1e6 / kLookups << " ns/lookup)\n"
+              << "std::unordered_map: " << baseline_ms << " ms ("
+              << baseline_ms * 1e6 / kLookups << " ns/lookup)\n";
+
+    if (checksum_table != checksum_baseline) {
+        std::cerr << "checksum mismatch\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <chrono>
+
+// Wall-clock timing shared by the benches.
+
+// Milliseconds taken by fn()
+template <typename Fn>
+double time_ms(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
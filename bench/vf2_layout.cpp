@@ -0,0 +1,113 @@
+#include <iostream>
+#include <random>
+#include "IR/passes/vf2_layout.hpp"
+#include "timing.hpp"
+
+// Layout selection on a 32x32 grid for two circuits over 300 qubits: one
+// whose interactions are a relabelled spanning tree of a grid region, so a
+// perfect layout exists, and one with random interactions, which falls
+// back to greedy placement. Then a coupling map of two separate 4x4 grids:
+// a path fits into one of them, and a triangle, which has no perfect
+// layout on a grid, must be rejected rather than placed with distances
+// across the gap.
+
+constexpr uint32_t kSide = 32;
+constexpr uint32_t kQubits = 300;
+constexpr size_t kRounds = 50;
+
+static void report(const char* name, const qarser::LayoutResult& result, double ms) {
+    std::cout << name << (result.perfect ? "perfect" : "greedy") << ", score " << result.score << ", "
+              << result.candidates << " candidates, " << ms << " ms\n";
+}
+
+int main() {
+    using qarser::OpCode;
+    std::mt19937 rng(42);
+    auto coupling = qarser::CouplingMap::grid(kSide, kSide);
+
+    // Random spanning tree of the first kQubits physical qubits, grown
+    // from qubit 0 through grid edges
+    std::vector<uint32_t> label(kQubits);
+    for (uint32_t q = 0; q < kQubits; ++q) {
+        label[q] = q;
+    }
+    std::shuffle(label.begin(), label.end(), rng);
+    std::vector<std::pair<uint32_t, uint32_t>> tree;
+    std::vector<bool> reached(kQubits, false);
+    std::vector<uint32_t> frontier = {0};
+    reached[0] = true;
+    while (tree.size() + 1 < kQubits) {
+        uint32_t p = frontier[rng() % frontier.size()];
+        auto neighbors = coupling.neighbors(p);
+        uint32_t next = neighbors[rng() % neighbors.size()];
+        if (next < kQubits && !reached[next]) {
+            reached[next] = true;
+            frontier.push_back(next);
+            tree.emplace_back(label[p], label[next]);
+        }
+    }
+
+    qarser::Circuit embeddable;
+    embeddable.add_qreg("q", kQubits);
+    qarser::Circuit random;
+    random.add_qreg("q", kQubits);
+    for (size_t round = 0; round < kRounds; ++round) {
+        for (const auto& [a, b] : tree) {
+            embeddable.add(OpCode::CX, {a, b});
+            uint32_t c = rng() % kQubits;
+            random.add(OpCode::CX, {c, static_cast<uint32_t>((c + 1 + rng() % (kQubits - 1)) % kQubits)});
+        }
+    }
+
+    qarser::VF2Layout selector(coupling);
+    qarser::LayoutResult result;
+    double ms = time_ms([&] { result = selector.run(embeddable); });
+    report("tree:    ", result, ms);
+    bool ok = result.perfect;
+    ms = time_ms([&] { result = selector.run(random); });
+    report("random:  ", result, ms);
+
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (uint32_t base : {0u, 16u}) {
+        for (uint32_t r = 0; r < 4; ++r) {
+            for (uint32_t c = 0; c < 4; ++c) {
+                uint32_t p = base + 4 * r + c;
+                if (c + 1 < 4) edges.emplace_back(p, p + 1);
+                if (r + 1 < 4) edges.emplace_back(p, p + 4);
+            }
+        }
+    }
+    qarser::CouplingMap split(32, edges);
+    qarser::VF2Layout split_selector(split);
+    qarser::Circuit path;
+    path.add_qreg("q", 10);
+    for (uint32_t q = 0; q + 1 < 10; ++q) {
+        path.add(OpCode::CX, {q, q + 1});
+    }
+    qarser::LayoutResult path_result;
+    ms = time_ms([&] { path_result = split_selector.run(path); });
+    bool path_ok = path_result.perfect && path_result.score == 9;
+    for (uint32_t q = 0; q + 1 < 10; ++q) {
+        path_ok = path_ok && split.adjacent(path_result.layout.to_physical[q], path_result.layout.to_physical[q + 1]);
+    }
+    report("split:   ", path_result, ms);
+
+    qarser::Circuit triangle;
+    triangle.add_qreg("q", 3);
+    triangle.add(OpCode::CX, {0, 1});
+    triangle.add(OpCode::CX, {1, 2});
+    triangle.add(OpCode::CX, {2, 0});
+    bool rejected = false;
+    try {
+        split_selector.run(triangle);
+    }
+    catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    qarser::InteractionGraph triangle_graph(triangle);
+    bool unreachable = split_selector.score(triangle_graph, {0, 1, 16}) == std::numeric_limits<uint64_t>::max();
+    std::cout << "triangle: " << (rejected ? "rejected" : "PLACED") << ", across the gap scores "
+              << (unreachable ? "as unreachable" : "WRONG") << "\n";
+    ok = ok && path_ok && rejected && unreachable;
+    return ok ? 0 : 1;
+}
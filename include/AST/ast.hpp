@@ -26,7 +26,9 @@ namespace qarser {
             GATE,
             GATE_DEF,
             MEASURE,
-            BARRIER
+            RESET,
+            BARRIER,
+            REPEAT
         };
 
         Statement(int line = 0) : AstNode(line) {}
@@ -52,8 +54,8 @@ namespace qarser {
     public:
         std::string filename;
     public:
-        Include(const std::string& filename) 
-            : filename(filename) {}
+        Include(int line, const std::string& filename) 
+            : Statement(line), filename(filename) {}
 
         void accept(AstVisitor& visitor) override { 
             visitor.visit(*this);
@@ -111,24 +113,6 @@ namespace qarser {
     };
 
 
-    class Reset : public Statement {
-    public:
-        std::string qubit;
-
-    public:
-        Reset(const std::string& qubit) 
-            : qubit(qubit) {}
-
-        void accept(AstVisitor& visitor) override {
-            visitor.visit(*this);
-        }
-
-        Kind kind() const override {
-            return Kind::MEASURE;
-        }
-    };
-
-
 ;
 
 // TODO
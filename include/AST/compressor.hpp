@@ -0,0 +1,462 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "gate.hpp"
+
+
+namespace qarser {
+
+    struct CompressionReport {
+        size_t statements_before = 0;   // operation statements, nested ones included
+        size_t statements_after = 0;    // the same, plus one per Repeat
+        size_t repeats = 0;
+    };
+
+
+    /**
+     * @brief Folds repeated runs of operation statements into Repeat blocks.
+     *
+     * Every gate call, measure, reset and barrier gets a shape fingerprint
+     * covering everything but its register indices, and rolling hashes over
+     * the fingerprints compare whole blocks in O(1). At each position the
+     * candidate periods are the distances to the next few statements of the
+     * same shape, and to the next few identical ones (which finds long
+     * blocks whose shapes recur inside them). A candidate block repeats
+     * while the hashes match and every register's indices move by the same
+     * stride per copy; the candidate covering the most statements wins and
+     * its body is compressed again. Candidates are verified structurally,
+     * so hash collisions only cost time. Copies must also lay out their
+     * lines alike, so every statement keeps its original line through its
+     * copy's line offset.
+     *
+     * Declarations, includes and gate definitions end a run.
+     */
+    class RepeatCompressor {
+    private:
+        static constexpr uint64_t MOD = (uint64_t(1) << 61) - 1;
+        static constexpr uint64_t BASE = 1000003;
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        uint32_t max_period;
+        uint32_t max_candidates;
+        CompressionReport report;
+
+        // Per-run scratch
+        std::vector<uint64_t> powers;
+        std::vector<const RegisterRef*> refs_a;
+        std::vector<const RegisterRef*> refs_b;
+
+    public:
+        explicit RepeatCompressor(uint32_t max_period = 4096, uint32_t max_candidates = 16)
+            : max_period(max_period), max_candidates(max_candidates) {}
+
+        CompressionReport compress(Program& program) {
+            report = CompressionReport{};
+            std::vector<std::unique_ptr<Statement>> result;
+            std::vector<std::unique_ptr<Statement>> run;
+            for (auto& stmt : program.statements) {
+                if (is_operation(*stmt)) {
+                    run.push_back(std::move(stmt));
+                    continue;
+                }
+                flush(run, result);
+                result.push_back(std::move(stmt));
+            }
+            flush(run, result);
+            program.statements = std::move(result);
+            return report;
+        }
+
+    private:
+        static bool is_operation(const Statement& stmt) {
+            switch (stmt.kind()) {
+                case Statement::Kind::GATE:
+                case Statement::Kind::MEASURE:
+                case Statement::Kind::RESET:
+                case Statement::Kind::BARRIER:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        void flush(std::vector<std::unique_ptr<Statement>>& run, std::vector<std::unique_ptr<Statement>>& out) {
+            report.statements_before += run.size();
+            size_t first = out.size();
+            compress_run(run, out);
+            for (size_t i = first; i < out.size(); ++i) {
+                report.statements_after += count_statements(*out[i]);
+            }
+            run.clear();
+        }
+
+        static size_t count_statements(const Statement& stmt) {
+            if (stmt.kind() != Statement::Kind::REPEAT) {
+                return 1;
+            }
+            size_t count = 1;
+            for (const auto& inner : static_cast<const Repeat&>(stmt).body) {
+                count += count_statements(*inner);
+            }
+            return count;
+        }
+
+        // Moves the statements of `run` to `out`, folding repeats
+        void compress_run(std::vector<std::unique_ptr<Statement>>& run, std::vector<std::unique_ptr<Statement>>& out) {
+            uint32_t n = static_cast<uint32_t>(run.size());
+            if (n < 2) {
+                for (auto& stmt : run) {
+                    out.push_back(std::move(stmt));
+                }
+                return;
+            }
+
+            std::vector<uint64_t> shapes(n), exact(n);
+            for (uint32_t i = 0; i < n; ++i) {
+                shapes[i] = shape_hash(*run[i]);
+                exact[i] = exact_hash(*run[i], shapes[i]);
+            }
+            std::vector<uint32_t> next_shape = next_equal(shapes);
+            std::vector<uint32_t> next_exact = next_equal(exact);
+
+            // Prefix hashes of the shapes, powers are shared with nested calls
+            std::vector<uint64_t> hashes(n + 1, 0);
+            for (uint32_t i = 0; i < n; ++i) {
+                hashes[i + 1] = add(mul(hashes[i], BASE), shapes[i] % MOD);
+            }
+            if (powers.size() < n + 1) {
+                powers.resize(n + 1);
+                powers[0] = 1;
+                for (uint32_t i = 1; i <= n; ++i) {
+                    powers[i] = mul(powers[i - 1], BASE);
+                }
+            }
+            auto block = [&](uint32_t begin, uint32_t length) {
+                return add(hashes[begin + length], MOD - mul(hashes[begin], powers[length]));
+            };
+
+            std::vector<uint32_t> periods;
+            for (uint32_t i = 0; i < n;) {
+                periods.clear();
+                for (uint32_t j = next_exact[i], c = 0; j != NONE && c < 4; j = next_exact[j], ++c) {
+                    periods.push_back(j - i);
+                }
+                for (uint32_t j = next_shape[i], c = 0; j != NONE && c < max_candidates; j = next_shape[j], ++c) {
+                    periods.push_back(j - i);
+                }
+
+                uint32_t best_period = 0, best_count = 1;
+                std::vector<Repeat::Shift> best_shifts;
+                std::vector<Repeat::Shift> shifts;
+                for (uint32_t period : periods) {
+                    if (period > max_period || size_t(i) + 2 * size_t(period) > n) {
+                        continue;
+                    }
+                    uint64_t hash = block(i, period);
+                    if (block(i + period, period) != hash || !derive_shifts(run, i, period, shifts) ||
+                        !same_layout(run, i, 1, period)) {
+                        continue;
+                    }
+                    uint32_t count = 2;
+                    while (size_t(i) + size_t(count + 1) * period <= n &&
+                           block(i + count * period, period) == hash &&
+                           matches(run, i, count, period, shifts) && same_layout(run, i, count, period)) {
+                        ++count;
+                    }
+                    if (size_t(count) * period > size_t(best_count) * best_period ||
+                        (size_t(count) * period == size_t(best_count) * best_period && period < best_period)) {
+                        best_period = period;
+                        best_count = count;
+                        best_shifts = shifts;
+                    }
+                }
+
+                if (best_count < 2 || size_t(best_count - 1) * best_period < 2) {
+                    out.push_back(std::move(run[i]));
+                    ++i;
+                    continue;
+                }
+                std::vector<int> line_offsets(best_count);
+                for (uint32_t c = 0; c < best_count; ++c) {
+                    line_offsets[c] = run[i + c * best_period]->line - run[i]->line;
+                }
+                std::vector<std::unique_ptr<Statement>> copy;
+                for (uint32_t t = 0; t < best_period; ++t) {
+                    copy.push_back(std::move(run[i + t]));
+                }
+                for (uint32_t t = best_period; t < best_count * best_period; ++t) {
+                    run[i + t].reset();
+                }
+                int line = copy[0]->line;
+                std::vector<std::unique_ptr<Statement>> body;
+                compress_run(copy, body);
+                out.push_back(std::make_unique<Repeat>(line, std::move(body), static_cast<int>(best_count),
+                                                       std::move(best_shifts), std::move(line_offsets)));
+                ++report.repeats;
+                i += best_count * best_period;
+            }
+        }
+
+        // For every element, the index of the next equal one or NONE
+        static std::vector<uint32_t> next_equal(const std::vector<uint64_t>& values) {
+            std::vector<uint32_t> next(values.size(), NONE);
+            std::unordered_map<uint64_t, uint32_t> last;
+            last.reserve(values.size());
+            for (uint32_t i = static_cast<uint32_t>(values.size()); i-- > 0;) {
+                auto [it, inserted] = last.emplace(values[i], i);
+                if (!inserted) {
+                    next[i] = it->second;
+                    it->second = i;
+                }
+            }
+            return next;
+        }
+
+        /**
+         * @brief Strides moving the block at `begin` onto the one after it.
+         *
+         * Fails if the blocks differ in shape, if a register's indices move
+         * by different amounts, or if a moving register is also used whole.
+         */
+        bool derive_shifts(const std::vector<std::unique_ptr<Statement>>& run, uint32_t begin, uint32_t period,
+                           std::vector<Repeat::Shift>& shifts) {
+            shifts.clear();
+            std::vector<std::string> whole;
+            for (uint32_t t = 0; t < period; ++t) {
+                const Statement& a = *run[begin + t];
+                const Statement& b = *run[begin + period + t];
+                if (!same_shape(a, b)) {
+                    return false;
+                }
+                for (size_t r = 0; r < refs_a.size(); ++r) {
+                    const RegisterRef& ref = *refs_a[r];
+                    if (ref.isRefWholeRegister()) {
+                        whole.push_back(ref.name);
+                        continue;
+                    }
+                    int stride = refs_b[r]->index - ref.index;
+                    bool found = false;
+                    for (const auto& shift : shifts) {
+                        if (shift.name == ref.name) {
+                            if (shift.stride != stride) {
+                                return false;
+                            }
+                            found = true;
+                            break;
+                        }
+                    }
+                    if (!found) {
+                        shifts.push_back(Repeat::Shift{ref.name, stride});
+                    }
+                }
+            }
+            std::vector<Repeat::Shift> moving;
+            for (const auto& shift : shifts) {
+                if (shift.stride == 0) {
+                    continue;
+                }
+                for (const auto& name : whole) {
+                    if (name == shift.name) {
+                        return false;
+                    }
+                }
+                moving.push_back(shift);
+            }
+            shifts = std::move(moving);
+            return true;
+        }
+
+        // Whether copy `copy` of the block at `begin` is the first one moved `copy` times
+        bool matches(const std::vector<std::unique_ptr<Statement>>& run, uint32_t begin, uint32_t copy,
+                     uint32_t period, const std::vector<Repeat::Shift>& shifts) {
+            for (uint32_t t = 0; t < period; ++t) {
+                if (!same_shape(*run[begin + t], *run[begin + copy * period + t])) {
+                    return false;
+                }
+                for (size_t r = 0; r < refs_a.size(); ++r) {
+                    const RegisterRef& ref = *refs_a[r];
+                    if (ref.isRefWholeRegister()) {
+                        continue;
+                    }
+                    int stride = 0;
+                    for (const auto& shift : shifts) {
+                        if (shift.name == ref.name) {
+                            stride = shift.stride;
+                            break;
+                        }
+                    }
+                    if (static_cast<long long>(refs_b[r]->index) !=
+                        ref.index + static_cast<long long>(copy) * stride) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Whether copy `copy` of the block at `begin` spreads over its lines like the first one
+        static bool same_layout(const std::vector<std::unique_ptr<Statement>>& run, uint32_t begin, uint32_t copy,
+                                uint32_t period) {
+            uint32_t start = begin + copy * period;
+            for (uint32_t t = 1; t < period; ++t) {
+                if (run[start + t]->line - run[start]->line != run[begin + t]->line - run[begin]->line) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static void collect_refs(const Statement& stmt, std::vector<const RegisterRef*>& refs) {
+            refs.clear();
+            auto append = [&](const std::vector<RegisterRef>& list) {
+                for (const auto& ref : list) {
+                    refs.push_back(&ref);
+                }
+            };
+            switch (stmt.kind()) {
+                case Statement::Kind::GATE:
+                    append(static_cast<const Gate&>(stmt).qubits);
+                    break;
+                case Statement::Kind::MEASURE:
+                    append(static_cast<const Measure&>(stmt).qubits);
+                    append(static_cast<const Measure&>(stmt).cbits);
+                    break;
+                case Statement::Kind::RESET:
+                    refs.push_back(&static_cast<const Reset&>(stmt).qubit);
+                    break;
+                case Statement::Kind::BARRIER:
+                    append(static_cast<const Barrier&>(stmt).qubits);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // Equal up to register indices, leaves both operand lists in refs_a and refs_b
+        bool same_shape(const Statement& a, const Statement& b) {
+            if (a.kind() != b.kind()) {
+                return false;
+            }
+            if (a.kind() == Statement::Kind::GATE) {
+                const auto& ga = static_cast<const Gate&>(a);
+                const auto& gb = static_cast<const Gate&>(b);
+                if (ga.name != gb.name || ga.params.size() != gb.params.size()) {
+                    return false;
+                }
+                for (size_t p = 0; p < ga.params.size(); ++p) {
+                    if (!same_expression(*ga.params[p], *gb.params[p])) {
+                        return false;
+                    }
+                }
+            }
+            if (a.kind() == Statement::Kind::MEASURE &&
+                static_cast<const Measure&>(a).qubits.size() != static_cast<const Measure&>(b).qubits.size()) {
+                return false;
+            }
+            collect_refs(a, refs_a);
+            collect_refs(b, refs_b);
+            if (refs_a.size() != refs_b.size()) {
+                return false;
+            }
+            for (size_t r = 0; r < refs_a.size(); ++r) {
+                if (refs_a[r]->name != refs_b[r]->name ||
+                    refs_a[r]->isRefWholeRegister() != refs_b[r]->isRefWholeRegister()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool same_expression(const Expression& a, const Expression& b) {
+            if (auto* na = dynamic_cast<const NumberExpr*>(&a)) {
+                auto* nb = dynamic_cast<const NumberExpr*>(&b);
+                return nb && na->value == nb->value;
+            }
+            if (auto* ia = dynamic_cast<const IdentifierExpr*>(&a)) {
+                auto* ib = dynamic_cast<const IdentifierExpr*>(&b);
+                return ib && ia->name == ib->name;
+            }
+            if (auto* ua = dynamic_cast<const UnaryExpr*>(&a)) {
+                auto* ub = dynamic_cast<const UnaryExpr*>(&b);
+                return ub && ua->op == ub->op && same_expression(*ua->operand, *ub->operand);
+            }
+            if (auto* ba = dynamic_cast<const BinaryExpr*>(&a)) {
+                auto* bb = dynamic_cast<const BinaryExpr*>(&b);
+                return bb && ba->op == bb->op && same_expression(*ba->left, *bb->left) &&
+                       same_expression(*ba->right, *bb->right);
+            }
+            return false;
+        }
+
+        static uint64_t mix(uint64_t hash, uint64_t value) {
+            hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+
+        static uint64_t expression_hash(const Expression& expr) {
+            if (auto* number = dynamic_cast<const NumberExpr*>(&expr)) {
+                double value = number->value == 0.0 ? 0.0 : number->value;
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return mix(1, bits);
+            }
+            if (auto* id = dynamic_cast<const IdentifierExpr*>(&expr)) {
+                return mix(2, std::hash<std::string>{}(id->name));
+            }
+            if (auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+                return mix(mix(3, static_cast<uint64_t>(unary->op)), expression_hash(*unary->operand));
+            }
+            if (auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+                uint64_t hash = mix(4, static_cast<uint64_t>(binary->op));
+                return mix(mix(hash, expression_hash(*binary->left)), expression_hash(*binary->right));
+            }
+            return 0;
+        }
+
+        uint64_t shape_hash(const Statement& stmt) {
+            uint64_t hash = mix(0, static_cast<uint64_t>(stmt.kind()));
+            if (stmt.kind() == Statement::Kind::GATE) {
+                const auto& gate = static_cast<const Gate&>(stmt);
+                hash = mix(hash, std::hash<std::string>{}(gate.name));
+                for (const auto& param : gate.params) {
+                    hash = mix(hash, expression_hash(*param));
+                }
+            }
+            if (stmt.kind() == Statement::Kind::MEASURE) {
+                hash = mix(hash, static_cast<const Measure&>(stmt).qubits.size());
+            }
+            collect_refs(stmt, refs_a);
+            for (const RegisterRef* ref : refs_a) {
+                hash = mix(mix(hash, std::hash<std::string>{}(ref->name)), ref->isRefWholeRegister());
+            }
+            return hash;
+        }
+
+        uint64_t exact_hash(const Statement& stmt, uint64_t shape) {
+            collect_refs(stmt, refs_a);
+            for (const RegisterRef* ref : refs_a) {
+                shape = mix(shape, static_cast<uint64_t>(static_cast<int64_t>(ref->index)));
+            }
+            return shape;
+        }
+
+        static uint64_t mul(uint64_t a, uint64_t b) {
+            unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            uint64_t low = static_cast<uint64_t>(product & MOD);
+            uint64_t high = static_cast<uint64_t>(product >> 61);
+            return add(low, high);
+        }
+
+        static uint64_t add(uint64_t a, uint64_t b) {
+            uint64_t sum = a + b;
+            return sum >= MOD ? sum - MOD : sum;
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,89 @@
+#pragma once
+#include <cmath>
+#include <optional>
+#include <string>
+#include <vector>
+#include "expression.hpp"
+
+namespace qarser {
+
+    /**
+     * @brief Evaluates a parameter expression to a number.
+     *
+     * Identifiers are looked up in `names` and take the value at the same
+     * position in `values`; an identifier that is unknown or has no value
+     * makes the whole expression non-constant (std::nullopt).
+     */
+    class ExpressionEvaluator : public BaseVisitor {
+    private:
+        const std::vector<std::string>& names;
+        const std::vector<std::optional<double>>& values;
+        std::optional<double> result;
+
+    public:
+        ExpressionEvaluator(const std::vector<std::string>& names,
+                            const std::vector<std::optional<double>>& values)
+            : names(names), values(values) {}
+
+        std::optional<double> evaluate(const Expression& expr) {
+            // Visitors take mutable nodes, evaluation never modifies them
+            const_cast<Expression&>(expr).accept(*this);
+            return result;
+        }
+
+        // Evaluates an expression that may not reference any identifier
+        static std::optional<double> evaluate_constant(const Expression& expr) {
+            static const std::vector<std::string> no_names;
+            static const std::vector<std::optional<double>> no_values;
+            return ExpressionEvaluator(no_names, no_values).evaluate(expr);
+        }
+
+        void visit(NumberExpr& expr) override {
+            result = expr.value;
+        }
+
+        void visit(IdentifierExpr& expr) override {
+            result = std::nullopt;
+            for (size_t i = 0; i < names.size(); ++i) {
+                if (names[i] == expr.name) {
+                    result = i < values.size() ? values[i] : std::nullopt;
+                    return;
+                }
+            }
+        }
+
+        void visit(UnaryExpr& expr) override {
+            expr.operand->accept(*this);
+            if (!result) {
+                return;
+            }
+            double v = *result;
+            switch (expr.op) {
+                case UnaryExpr::Op::Neg: result = -v; break;
+                case UnaryExpr::Op::Pos: result = v; break;
+                case UnaryExpr::Op::Sin: result = std::sin(v); break;
+                case UnaryExpr::Op::Cos: result = std::cos(v); break;
+                case UnaryExpr::Op::Tan: result = std::tan(v); break;
+                case UnaryExpr::Op::Exp: result = std::exp(v); break;
+                case UnaryExpr::Op::Ln:  result = std::log(v); break;
+            }
+        }
+
+        void visit(BinaryExpr& expr) override {
+            expr.left->accept(*this);
+            std::optional<double> left = result;
+            expr.right->accept(*this);
+            if (!left || !result) {
+                result = std::nullopt;
+                return;
+            }
+            switch (expr.op) {
+                case BinaryExpr::Op::Add: result = *left + *result; break;
+                case BinaryExpr::Op::Sub: result = *left - *result; break;
+                case BinaryExpr::Op::Mul: result = *left * *result; break;
+                case BinaryExpr::Op::Div: result = *left / *result; break;
+            }
+        }
+    };
+
+}; // namespace qarser
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <unordered_map>
 #include "ast.hpp"
 #include "expression.hpp"
 
@@ -42,8 +44,8 @@ namespace qarser {
         )
             : Statement(line), 
                 name(name), 
-                params(std::move(params)),
-                qubits(qubits) {}
+                qubits(qubits),
+                params(std::move(params)) {}
 
 
         void accept(AstVisitor& visitor) override {
@@ -72,8 +74,8 @@ namespace qarser {
         )
             : Statement(line), 
                 name(name), 
-                params(std::move(params)),
                 qubits(qubits),
+                params(std::move(params)),
                 body(std::move(body)) {}
 
 
@@ -106,6 +108,23 @@ namespace qarser {
     };
 
 
+    class Reset : public Statement {
+    public:
+        RegisterRef qubit;
+    public:
+        Reset(int line, const RegisterRef& qubit)
+            : Statement(line), qubit(qubit) {}
+
+        void accept(AstVisitor& visitor) override {
+            visitor.visit(*this);
+        }
+
+        Kind kind() const override {
+            return Kind::RESET;
+        }
+    };
+
+
     class Barrier : public Statement {
     public:
         std::vector<RegisterRef> qubits;
@@ -123,6 +142,174 @@ namespace qarser {
     };
 
 
+    /**
+     * @brief A block of statements run `count` times in a row.
+     *
+     * Iteration k runs the body with the indexed operands of every register
+     * in `shifts` moved by k times its stride, so one block also covers
+     * ladders and other translated copies. Registers referenced whole never
+     * move. Every iteration lays out its lines like the first, moved by its
+     * entry in `line_offsets`, so diagnostics can name the original line.
+     * Built by RepeatCompressor, the parser has no syntax for it.
+     */
+    class Repeat : public Statement {
+    public:
+        struct Shift {
+            std::string name;
+            int stride;
+        };
+
+        std::vector<std::unique_ptr<Statement>> body;
+        int count;
+        std::vector<Shift> shifts;
+        std::vector<int> line_offsets;      // iteration -> its line minus the first iteration's
+
+    public:
+        Repeat(int line,
+            std::vector<std::unique_ptr<Statement>>&& body,
+            int count,
+            std::vector<Shift>&& shifts,
+            std::vector<int>&& line_offsets
+        )
+            : Statement(line),
+                body(std::move(body)),
+                count(count),
+                shifts(std::move(shifts)),
+                line_offsets(std::move(line_offsets)) {}
+
+        void accept(AstVisitor& visitor) override {
+            visitor.visit(*this);
+        }
+
+        Kind kind() const override {
+            return Kind::REPEAT;
+        }
+
+        int stride_of(const std::string& name) const {
+            for (const auto& shift : shifts) {
+                if (shift.name == name) {
+                    return shift.stride;
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Moves the body by `iterations` iterations and its lines by `lines`.
+         *
+         * Rewrites the body in place, nested repeats included, so that it
+         * reads like a later iteration of the original program; shifting
+         * back by the same amounts restores it.
+         */
+        void shift(int iterations, int lines) {
+            shift_body(body, shifts, iterations, lines);
+        }
+
+        /**
+         * @brief Calls fn(ref, low, high) for every register operand in the body.
+         *
+         * Nested repeats are included; low and high are the smallest and
+         * largest index the operand takes over all iterations, both equal to
+         * ref.index for operands that do not move.
+         */
+        template <typename Fn>
+        void for_each_operand(Fn&& fn) const {
+            std::unordered_map<std::string, std::pair<long long, long long>> ranges;
+            walk(*this, ranges, fn);
+        }
+
+    private:
+        static void shift_body(std::vector<std::unique_ptr<Statement>>& body, const std::vector<Shift>& shifts,
+                               int iterations, int lines) {
+            auto move = [&](RegisterRef& ref) {
+                for (const auto& shift : shifts) {
+                    if (shift.name == ref.name && !ref.isRefWholeRegister()) {
+                        ref.index += iterations * shift.stride;
+                    }
+                }
+            };
+            auto move_refs = [&](std::vector<RegisterRef>& refs) {
+                for (auto& ref : refs) {
+                    move(ref);
+                }
+            };
+            for (auto& stmt : body) {
+                stmt->line += lines;
+                switch (stmt->kind()) {
+                    case Kind::GATE:
+                        move_refs(static_cast<Gate&>(*stmt).qubits);
+                        break;
+                    case Kind::MEASURE:
+                        move_refs(static_cast<Measure&>(*stmt).qubits);
+                        move_refs(static_cast<Measure&>(*stmt).cbits);
+                        break;
+                    case Kind::RESET:
+                        move(static_cast<Reset&>(*stmt).qubit);
+                        break;
+                    case Kind::BARRIER:
+                        move_refs(static_cast<Barrier&>(*stmt).qubits);
+                        break;
+                    case Kind::REPEAT:
+                        shift_body(static_cast<Repeat&>(*stmt).body, shifts, iterations, lines);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        template <typename Fn>
+        static void walk(const Repeat& repeat,
+                         std::unordered_map<std::string, std::pair<long long, long long>>& ranges, Fn& fn) {
+            for (const auto& shift : repeat.shifts) {
+                long long span = static_cast<long long>(repeat.count - 1) * shift.stride;
+                auto& range = ranges[shift.name];
+                range.first += std::min(span, 0LL);
+                range.second += std::max(span, 0LL);
+            }
+            auto visit_refs = [&](const std::vector<RegisterRef>& refs) {
+                for (const auto& ref : refs) {
+                    auto it = ranges.find(ref.name);
+                    long long low = ref.index, high = ref.index;
+                    if (it != ranges.end()) {
+                        low += it->second.first;
+                        high += it->second.second;
+                    }
+                    fn(ref, low, high);
+                }
+            };
+            for (const auto& stmt : repeat.body) {
+                switch (stmt->kind()) {
+                    case Kind::GATE:
+                        visit_refs(static_cast<const Gate&>(*stmt).qubits);
+                        break;
+                    case Kind::MEASURE:
+                        visit_refs(static_cast<const Measure&>(*stmt).qubits);
+                        visit_refs(static_cast<const Measure&>(*stmt).cbits);
+                        break;
+                    case Kind::RESET:
+                        visit_refs({static_cast<const Reset&>(*stmt).qubit});
+                        break;
+                    case Kind::BARRIER:
+                        visit_refs(static_cast<const Barrier&>(*stmt).qubits);
+                        break;
+                    case Kind::REPEAT:
+                        walk(static_cast<const Repeat&>(*stmt), ranges, fn);
+                        break;
+                    default:
+                        break;
+                }
+            }
+            for (const auto& shift : repeat.shifts) {
+                long long span = static_cast<long long>(repeat.count - 1) * shift.stride;
+                auto& range = ranges[shift.name];
+                range.first -= std::min(span, 0LL);
+                range.second -= std::max(span, 0LL);
+            }
+        }
+    };
+
+
 };
 
 
@@ -116,7 +116,23 @@ public:
     }
 
     void visit(Reset& reset) override {
+        std::cout << "Reset(qubit=" << reset.qubit.toString() << ")\n";
+    }
+
+    void visit(Repeat& repeat) override {
+        std::cout << "Repeat(count=" << repeat.count << ", shifts=[";
+        for (size_t i = 0; i < repeat.shifts.size(); ++i) {
+            if (i > 0) std::cout << ", ";
+            std::cout << repeat.shifts[i].name << (repeat.shifts[i].stride < 0 ? "" : "+") << repeat.shifts[i].stride;
+        }
+        std::cout << "])\n";
 
+        indent++;
+        for (const auto& statement : repeat.body) {
+            print_indent();
+            statement->accept(*this);
+        }
+        indent--;
     }
 
 
@@ -10,6 +10,7 @@ namespace qarser {
     class Measure;
     class Reset;
     class Barrier;
+    class Repeat;
     class GateDef;
 
     class NumberExpr;
@@ -29,6 +30,7 @@ namespace qarser {
         virtual void visit(Measure& measure) = 0;
         virtual void visit(Reset& reset) = 0;
         virtual void visit(Barrier& barrier) = 0;
+        virtual void visit(Repeat& repeat) = 0;
         virtual void visit(GateDef& gate_def) = 0;
 
         virtual void visit(NumberExpr& expr) = 0;
@@ -43,20 +45,21 @@ namespace qarser {
 
     class BaseVisitor : public AstVisitor {
     public:
-        void visit(Program& program) override {}
-        void visit(Include& include) override {}
-        void visit(QRegister& qreg) override {}
-        void visit(CRegister& creg) override {}
-        void visit(Gate& gate) override {}
-        void visit(Measure& measure) override {}
-        void visit(Reset& reset) override {}
-        void visit(Barrier& barrier) override {}
-        void visit(GateDef& gate_def) override {}
+        void visit(Program&) override {}
+        void visit(Include&) override {}
+        void visit(QRegister&) override {}
+        void visit(CRegister&) override {}
+        void visit(Gate&) override {}
+        void visit(Measure&) override {}
+        void visit(Reset&) override {}
+        void visit(Barrier&) override {}
+        void visit(Repeat&) override {}
+        void visit(GateDef&) override {}
 
-        void visit(NumberExpr& expr) override {}
-        void visit(IdentifierExpr& expr) override {}
-        void visit(UnaryExpr& expr) override {}
-        void visit(BinaryExpr& expr) override {}
+        void visit(NumberExpr&) override {}
+        void visit(IdentifierExpr&) override {}
+        void visit(UnaryExpr&) override {}
+        void visit(BinaryExpr&) override {}
     };
 
 
@@ -0,0 +1,263 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "opcode.hpp"
+
+
+namespace qarser {
+
+    class GateDef;
+
+    // Non-owning view of a contiguous range
+    template <typename T>
+    struct Span {
+        T* data = nullptr;
+        size_t count = 0;
+
+        T* begin() const { return data; }
+        T* end() const { return data + count; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        T& operator[](size_t i) const { return data[i]; }
+    };
+
+
+    /**
+     * @brief One IR operation.
+     *
+     * Operands live in the circuit's qubit, clbit and parameter pools; an
+     * operation only stores where its range starts and how long it is.
+     */
+    struct Operation {
+        OpCode code;
+        uint32_t gate = 0;          // gate table index for OpCode::GATE
+        uint32_t qubit_offset = 0;
+        uint32_t num_qubits = 0;
+        uint32_t clbit_offset = 0;
+        uint32_t num_clbits = 0;
+        uint32_t param_offset = 0;
+        uint32_t num_params = 0;
+    };
+
+
+    /**
+     * @brief Linear circuit: a flat array of operations on global indices.
+     *
+     * Every quantum register occupies a contiguous range of the global qubit
+     * index space starting at its prefix offset, and likewise for classical
+     * registers and bits. Parameters are resolved to numbers.
+     */
+    class Circuit {
+    public:
+        struct Register {
+            std::string name;
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        struct GateInfo {
+            std::string name;
+            uint32_t num_params;
+            uint32_t num_qubits;
+            const GateDef* definition;  // owned by the Program or gate library lowered from
+        };
+
+    private:
+        std::vector<Operation> operations;
+        std::vector<uint32_t> qubit_pool;
+        std::vector<uint32_t> clbit_pool;
+        std::vector<double> param_pool;
+
+        std::vector<Register> qregs;
+        std::vector<Register> cregs;
+        std::vector<GateInfo> gates;
+        uint32_t num_qubits = 0;
+        uint32_t num_clbits = 0;
+
+    public:
+        uint32_t add_qreg(const std::string& name, uint32_t size) {
+            qregs.push_back(Register{name, num_qubits, size});
+            num_qubits += size;
+            return static_cast<uint32_t>(qregs.size() - 1);
+        }
+
+        uint32_t add_creg(const std::string& name, uint32_t size) {
+            cregs.push_back(Register{name, num_clbits, size});
+            num_clbits += size;
+            return static_cast<uint32_t>(cregs.size() - 1);
+        }
+
+        uint32_t add_gate(const std::string& name, uint32_t num_params, uint32_t num_qubits,
+                          const GateDef* definition = nullptr) {
+            gates.push_back(GateInfo{name, num_params, num_qubits, definition});
+            return static_cast<uint32_t>(gates.size() - 1);
+        }
+
+        /**
+         * @brief Appends an operation, copying its operands into the pools.
+         *
+         * @return index of the new operation
+         */
+        size_t add(OpCode code,
+                   const uint32_t* qubits, size_t qubit_count,
+                   const double* params = nullptr, size_t param_count = 0,
+                   const uint32_t* clbits = nullptr, size_t clbit_count = 0,
+                   uint32_t gate = 0) {
+            Operation op;
+            op.code = code;
+            op.gate = gate;
+            op.qubit_offset = static_cast<uint32_t>(qubit_pool.size());
+            op.num_qubits = static_cast<uint32_t>(qubit_count);
+            op.clbit_offset = static_cast<uint32_t>(clbit_pool.size());
+            op.num_clbits = static_cast<uint32_t>(clbit_count);
+            op.param_offset = static_cast<uint32_t>(param_pool.size());
+            op.num_params = static_cast<uint32_t>(param_count);
+            qubit_pool.insert(qubit_pool.end(), qubits, qubits + qubit_count);
+            clbit_pool.insert(clbit_pool.end(), clbits, clbits + clbit_count);
+            param_pool.insert(param_pool.end(), params, params + param_count);
+            operations.push_back(op);
+            return operations.size() - 1;
+        }
+
+        size_t add(OpCode code, std::initializer_list<uint32_t> qubits,
+                   std::initializer_list<double> params = {}) {
+            return add(code, qubits.begin(), qubits.size(), params.begin(), params.size());
+        }
+
+        // Copies an operation of `source`, which must share this circuit's layout
+        size_t append(const Circuit& source, const Operation& op) {
+            auto q = source.qubits(op);
+            auto p = source.params(op);
+            auto c = source.clbits(op);
+            return add(op.code, q.data, q.size(), p.data, p.size(), c.data, c.size(), op.gate);
+        }
+
+        // Same registers and gate table, no operations
+        Circuit without_operations() const {
+            Circuit circuit;
+            circuit.qregs = qregs;
+            circuit.cregs = cregs;
+            circuit.gates = gates;
+            circuit.num_qubits = num_qubits;
+            circuit.num_clbits = num_clbits;
+            return circuit;
+        }
+
+        void reserve(size_t num_operations, size_t num_qubit_operands, size_t num_params = 0) {
+            operations.reserve(num_operations);
+            qubit_pool.reserve(num_qubit_operands);
+            param_pool.reserve(num_params);
+        }
+
+        /**
+         * @brief Removes every operation for which pred(op) holds.
+         *
+         * Surviving operations keep their order, and the pools are compacted
+         * so they only hold operands of live operations.
+         */
+        template <typename Pred>
+        size_t erase_if(Pred&& pred) {
+            size_t kept = 0;
+            uint32_t qubit_end = 0, clbit_end = 0, param_end = 0;
+            for (size_t i = 0; i < operations.size(); ++i) {
+                Operation op = operations[i];
+                if (pred(static_cast<const Operation&>(op))) {
+                    continue;
+                }
+                move_range(qubit_pool, op.qubit_offset, op.num_qubits, qubit_end);
+                move_range(clbit_pool, op.clbit_offset, op.num_clbits, clbit_end);
+                move_range(param_pool, op.param_offset, op.num_params, param_end);
+                operations[kept++] = op;
+            }
+            size_t removed = operations.size() - kept;
+            operations.resize(kept);
+            qubit_pool.resize(qubit_end);
+            clbit_pool.resize(clbit_end);
+            param_pool.resize(param_end);
+            return removed;
+        }
+
+        size_t size() const {
+            return operations.size();
+        }
+
+        bool empty() const {
+            return operations.empty();
+        }
+
+        // Heap memory held by the operations and operand pools
+        size_t memory_bytes() const {
+            return operations.capacity() * sizeof(Operation) +
+                   (qubit_pool.capacity() + clbit_pool.capacity()) * sizeof(uint32_t) +
+                   param_pool.capacity() * sizeof(double);
+        }
+
+        const std::vector<Operation>& get_operations() const {
+            return operations;
+        }
+
+        const Operation& operator[](size_t i) const {
+            return operations[i];
+        }
+
+        Span<const uint32_t> qubits(const Operation& op) const {
+            return {qubit_pool.data() + op.qubit_offset, op.num_qubits};
+        }
+
+        Span<const uint32_t> clbits(const Operation& op) const {
+            return {clbit_pool.data() + op.clbit_offset, op.num_clbits};
+        }
+
+        Span<const double> params(const Operation& op) const {
+            return {param_pool.data() + op.param_offset, op.num_params};
+        }
+
+        Span<double> params(const Operation& op) {
+            return {param_pool.data() + op.param_offset, op.num_params};
+        }
+
+        uint32_t get_num_qubits() const {
+            return num_qubits;
+        }
+
+        uint32_t get_num_clbits() const {
+            return num_clbits;
+        }
+
+        const std::vector<Register>& get_qregs() const {
+            return qregs;
+        }
+
+        const std::vector<Register>& get_cregs() const {
+            return cregs;
+        }
+
+        const std::vector<GateInfo>& get_gates() const {
+            return gates;
+        }
+
+        const GateInfo& get_gate(uint32_t id) const {
+            return gates.at(id);
+        }
+
+        // Name of the operation as written in OpenQASM
+        const char* name(const Operation& op) const {
+            return op.code == OpCode::GATE ? gates[op.gate].name.c_str() : op_info(op.code).name;
+        }
+
+    private:
+        template <typename T>
+        static void move_range(std::vector<T>& pool, uint32_t& offset, uint32_t count, uint32_t& end) {
+            if (offset != end) {
+                std::copy(pool.begin() + offset, pool.begin() + offset + count, pool.begin() + end);
+            }
+            offset = end;
+            end += count;
+        }
+    };
+
+}; // namespace qarser
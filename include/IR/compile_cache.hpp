@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include "structural_hash.hpp"
+
+
+namespace qarser {
+
+    struct CacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+
+        double hit_rate() const {
+            uint64_t lookups = hits + misses;
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        }
+    };
+
+
+    /**
+     * @brief In-process LRU cache of compile results keyed by structural hash.
+     *
+     * Holds at most `capacity` results and evicts the least recently used
+     * one to make room. Results are shared and immutable, so one handed
+     * out stays valid after its entry is evicted. All members take a lock
+     * and can be called from several threads.
+     *
+     * Since the key ignores names, a cached result keeps the register and
+     * gate names of the program that produced it.
+     */
+    template <typename Result>
+    class CompileCache {
+    private:
+        using Entry = std::pair<Hash128, std::shared_ptr<const Result>>;
+
+        size_t capacity;
+        std::list<Entry> entries;       // most recently used first
+        std::unordered_map<Hash128, typename std::list<Entry>::iterator, Hash128Hasher> index;
+        CacheStats stats;
+        mutable std::mutex mutex;
+
+    public:
+        explicit CompileCache(size_t capacity = 256)
+            : capacity(capacity) {
+            if (capacity == 0) {
+                throw std::invalid_argument("Cache capacity must be positive");
+            }
+        }
+
+        // Cached result for `key`, nullptr on a miss
+        std::shared_ptr<const Result> find(const Hash128& key) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it == index.end()) {
+                ++stats.misses;
+                return nullptr;
+            }
+            ++stats.hits;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+
+        std::shared_ptr<const Result> insert(const Hash128& key, Result result) {
+            auto shared = std::make_shared<const Result>(std::move(result));
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it != index.end()) {
+                it->second->second = shared;
+                entries.splice(entries.begin(), entries, it->second);
+                return shared;
+            }
+            if (entries.size() == capacity) {
+                index.erase(entries.back().first);
+                entries.pop_back();
+                ++stats.evictions;
+            }
+            entries.emplace_front(key, shared);
+            index.emplace(key, entries.begin());
+            return shared;
+        }
+
+        /**
+         * @brief Cached result for `key`, computed by `compile()` on a miss.
+         *
+         * The lock is not held while compiling, so two threads missing on
+         * the same key both compile it and the later insert wins.
+         */
+        template <typename Compile>
+        std::shared_ptr<const Result> get_or_compile(const Hash128& key, Compile&& compile) {
+            if (auto cached = find(key)) {
+                return cached;
+            }
+            return insert(key, compile());
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.clear();
+            index.clear();
+        }
+
+        CacheStats get_stats() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            CacheStats current = stats;
+            current.entries = entries.size();
+            return current;
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,228 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "circuit.hpp"
+#include "utils/thread_pool.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Connectivity of a device's physical qubits.
+     *
+     * Edges are treated as undirected: routing only needs two qubits to be
+     * adjacent, fixing the direction of a CX is a separate concern. The
+     * shortest-path distance between every pair of qubits is computed once
+     * on construction (one BFS per qubit, run on the thread pool) and kept
+     * as a dense row-major matrix.
+     */
+    class CouplingMap {
+    public:
+        static constexpr uint32_t UNREACHABLE = std::numeric_limits<uint32_t>::max();
+
+    private:
+        uint32_t num_qubits = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        std::vector<uint32_t> neighbor_offsets;
+        std::vector<uint32_t> neighbor_list;
+        std::vector<uint32_t> distances;
+
+    public:
+        CouplingMap(uint32_t num_qubits, std::vector<std::pair<uint32_t, uint32_t>> edge_list,
+                    ThreadPool& pool = ThreadPool::shared())
+            : num_qubits(num_qubits), edges(std::move(edge_list)) {
+            std::vector<std::pair<uint32_t, uint32_t>> arcs;
+            for (const auto& [a, b] : edges) {
+                if (a >= num_qubits || b >= num_qubits || a == b) {
+                    throw std::invalid_argument("Invalid coupling edge " + std::to_string(a) + " " + std::to_string(b));
+                }
+                arcs.emplace_back(a, b);
+                arcs.emplace_back(b, a);
+            }
+            std::sort(arcs.begin(), arcs.end());
+            arcs.erase(std::unique(arcs.begin(), arcs.end()), arcs.end());
+
+            neighbor_offsets.assign(num_qubits + 1, 0);
+            for (const auto& arc : arcs) {
+                ++neighbor_offsets[arc.first + 1];
+                neighbor_list.push_back(arc.second);
+            }
+            for (uint32_t p = 0; p < num_qubits; ++p) {
+                neighbor_offsets[p + 1] += neighbor_offsets[p];
+            }
+
+            distances.assign(size_t(num_qubits) * num_qubits, UNREACHABLE);
+            pool.parallel_for(num_qubits, 16, [&](size_t, size_t begin, size_t end) {
+                std::vector<uint32_t> queue;
+                for (size_t source = begin; source < end; ++source) {
+                    bfs(static_cast<uint32_t>(source), queue);
+                }
+            });
+        }
+
+        /**
+         * @brief Reads an edge list, one "a b" pair of physical qubits per line.
+         *
+         * Blank lines and anything after '#' or "//" are ignored. The
+         * number of qubits is one more than the largest index.
+         */
+        static CouplingMap parse(std::istream& input) {
+            std::vector<std::pair<uint32_t, uint32_t>> edge_list;
+            uint32_t num_qubits = 0;
+            std::string line;
+            for (size_t number = 1; std::getline(input, line); ++number) {
+                line = line.substr(0, std::min(line.find('#'), line.find("//")));
+                std::istringstream fields(line);
+                long long a, b;
+                if (!(fields >> a)) {
+                    continue;
+                }
+                std::string rest;
+                if (!(fields >> b) || (fields >> rest) || a < 0 || b < 0 ||
+                    a >= UNREACHABLE || b >= UNREACHABLE) {
+                    throw std::runtime_error("Invalid coupling map edge at line " + std::to_string(number));
+                }
+                edge_list.emplace_back(static_cast<uint32_t>(a), static_cast<uint32_t>(b));
+                num_qubits = std::max<uint32_t>(num_qubits, static_cast<uint32_t>(std::max(a, b)) + 1);
+            }
+            return CouplingMap(num_qubits, std::move(edge_list));
+        }
+
+        static CouplingMap from_file(const std::string& path) {
+            std::ifstream file(path);
+            if (!file) {
+                throw std::runtime_error("Cannot open coupling map " + path);
+            }
+            return parse(file);
+        }
+
+        // Qubits 0 - 1 - ... - n-1
+        static CouplingMap line(uint32_t num_qubits) {
+            std::vector<std::pair<uint32_t, uint32_t>> edge_list;
+            for (uint32_t p = 0; p + 1 < num_qubits; ++p) {
+                edge_list.emplace_back(p, p + 1);
+            }
+            return CouplingMap(num_qubits, std::move(edge_list));
+        }
+
+        // Row-major grid with nearest-neighbour edges
+        static CouplingMap grid(uint32_t rows, uint32_t columns) {
+            std::vector<std::pair<uint32_t, uint32_t>> edge_list;
+            for (uint32_t r = 0; r < rows; ++r) {
+                for (uint32_t c = 0; c < columns; ++c) {
+                    uint32_t p = r * columns + c;
+                    if (c + 1 < columns) edge_list.emplace_back(p, p + 1);
+                    if (r + 1 < rows) edge_list.emplace_back(p, p + columns);
+                }
+            }
+            return CouplingMap(rows * columns, std::move(edge_list));
+        }
+
+        uint32_t size() const {
+            return num_qubits;
+        }
+
+        const std::vector<std::pair<uint32_t, uint32_t>>& get_edges() const {
+            return edges;
+        }
+
+        Span<const uint32_t> neighbors(uint32_t qubit) const {
+            return {neighbor_list.data() + neighbor_offsets[qubit],
+                    neighbor_offsets[qubit + 1] - neighbor_offsets[qubit]};
+        }
+
+        uint32_t degree(uint32_t qubit) const {
+            return neighbor_offsets[qubit + 1] - neighbor_offsets[qubit];
+        }
+
+        uint32_t distance(uint32_t a, uint32_t b) const {
+            return distances[size_t(a) * num_qubits + b];
+        }
+
+        bool adjacent(uint32_t a, uint32_t b) const {
+            return distance(a, b) == 1;
+        }
+
+        bool is_connected() const {
+            for (uint32_t p = 0; p < num_qubits; ++p) {
+                if (distance(0, p) == UNREACHABLE) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        void bfs(uint32_t source, std::vector<uint32_t>& queue) {
+            uint32_t* row = distances.data() + size_t(source) * num_qubits;
+            queue.clear();
+            queue.push_back(source);
+            row[source] = 0;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                uint32_t p = queue[head];
+                for (uint32_t next : neighbors(p)) {
+                    if (row[next] == UNREACHABLE) {
+                        row[next] = row[p] + 1;
+                        queue.push_back(next);
+                    }
+                }
+            }
+        }
+    };
+
+
+    /**
+     * @brief Bijection between logical and physical qubits.
+     *
+     * Both directions have one entry per physical qubit; logical qubits
+     * beyond the circuit's own are idle ancillas, so a swap always
+     * exchanges two logical qubits.
+     */
+    struct Layout {
+        std::vector<uint32_t> to_physical;      // logical -> physical
+        std::vector<uint32_t> to_logical;       // physical -> logical
+
+        static Layout trivial(uint32_t num_qubits) {
+            Layout layout;
+            layout.to_physical.resize(num_qubits);
+            for (uint32_t q = 0; q < num_qubits; ++q) {
+                layout.to_physical[q] = q;
+            }
+            layout.to_logical = layout.to_physical;
+            return layout;
+        }
+
+        static Layout from_physical(std::vector<uint32_t> to_physical) {
+            Layout layout;
+            layout.to_logical.assign(to_physical.size(), CouplingMap::UNREACHABLE);
+            for (uint32_t q = 0; q < to_physical.size(); ++q) {
+                if (to_physical[q] >= to_physical.size() ||
+                    layout.to_logical[to_physical[q]] != CouplingMap::UNREACHABLE) {
+                    throw std::invalid_argument("Layout is not a permutation");
+                }
+                layout.to_logical[to_physical[q]] = q;
+            }
+            layout.to_physical = std::move(to_physical);
+            return layout;
+        }
+
+        uint32_t size() const {
+            return static_cast<uint32_t>(to_physical.size());
+        }
+
+        void swap_physical(uint32_t a, uint32_t b) {
+            std::swap(to_logical[a], to_logical[b]);
+            to_physical[to_logical[a]] = a;
+            to_physical[to_logical[b]] = b;
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,160 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "circuit.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Dependency DAG over the operations of a Circuit.
+     *
+     * Node i is operation i. There is an edge u -> v when v is the next
+     * operation after u on one of v's wires (qubits, then clbits after
+     * them), so measure depends on both its qubit and its clbit, and a
+     * barrier on every qubit it spans. Parallel edges are merged.
+     *
+     * Both adjacency directions are stored in CSR form: one offset array per
+     * direction and one flat array of uint32 node ids, i.e. 8 bytes per edge
+     * plus 8 bytes per node. Operations are in program order, so every edge
+     * points forward and the node order already is a topological order.
+     */
+    class DependencyDag {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint32_t> pred_offsets;
+        std::vector<uint32_t> preds;
+        std::vector<uint32_t> succ_offsets;
+        std::vector<uint32_t> succs;
+
+    public:
+        DependencyDag() = default;
+
+        explicit DependencyDag(const Circuit& circuit) {
+            build(circuit);
+        }
+
+        void build(const Circuit& circuit) {
+            const auto& ops = circuit.get_operations();
+            size_t num_nodes = ops.size();
+            uint32_t num_qubits = circuit.get_num_qubits();
+
+            // Both passes walk the per-wire last operation; the first one
+            // counts the edges so the CSR arrays are allocated at their size
+            std::vector<uint32_t> last;
+            std::vector<uint32_t> scratch;
+            auto for_each_pred = [&](auto&& fn) {
+                last.assign(num_qubits + circuit.get_num_clbits(), NONE);
+                for (uint32_t node = 0; node < num_nodes; ++node) {
+                    scratch.clear();
+                    auto depend = [&](uint32_t wire) {
+                        if (last[wire] != NONE) {
+                            scratch.push_back(last[wire]);
+                        }
+                        last[wire] = node;
+                    };
+                    for (uint32_t q : circuit.qubits(ops[node])) {
+                        depend(q);
+                    }
+                    for (uint32_t c : circuit.clbits(ops[node])) {
+                        depend(num_qubits + c);
+                    }
+                    if (scratch.size() > 1) {
+                        std::sort(scratch.begin(), scratch.end());
+                        scratch.erase(std::unique(scratch.begin(), scratch.end()), scratch.end());
+                    }
+                    for (uint32_t pred : scratch) {
+                        fn(pred, node);
+                    }
+                }
+            };
+
+            pred_offsets.assign(num_nodes + 1, 0);
+            succ_offsets.assign(num_nodes + 1, 0);
+            for_each_pred([&](uint32_t pred, uint32_t node) {
+                ++pred_offsets[node + 1];
+                ++succ_offsets[pred + 1];
+            });
+            for (size_t i = 0; i < num_nodes; ++i) {
+                pred_offsets[i + 1] += pred_offsets[i];
+                succ_offsets[i + 1] += succ_offsets[i];
+            }
+
+            // Nodes come in order, so each list fills in ascending order
+            preds.assign(pred_offsets[num_nodes], 0);
+            succs.assign(pred_offsets[num_nodes], 0);
+            size_t next = 0;
+            std::vector<uint32_t> succ_fill(succ_offsets.begin(), succ_offsets.end() - 1);
+            for_each_pred([&](uint32_t pred, uint32_t node) {
+                preds[next++] = pred;
+                succs[succ_fill[pred]++] = node;
+            });
+        }
+
+        size_t size() const {
+            return pred_offsets.empty() ? 0 : pred_offsets.size() - 1;
+        }
+
+        size_t num_edges() const {
+            return preds.size();
+        }
+
+        Span<const uint32_t> predecessors(uint32_t node) const {
+            return {preds.data() + pred_offsets[node], pred_offsets[node + 1] - pred_offsets[node]};
+        }
+
+        Span<const uint32_t> successors(uint32_t node) const {
+            return {succs.data() + succ_offsets[node], succ_offsets[node + 1] - succ_offsets[node]};
+        }
+
+        uint32_t in_degree(uint32_t node) const {
+            return pred_offsets[node + 1] - pred_offsets[node];
+        }
+
+        uint32_t out_degree(uint32_t node) const {
+            return succ_offsets[node + 1] - succ_offsets[node];
+        }
+
+        // Nodes without predecessors
+        std::vector<uint32_t> sources() const {
+            std::vector<uint32_t> nodes;
+            for (uint32_t node = 0; node < size(); ++node) {
+                if (in_degree(node) == 0) nodes.push_back(node);
+            }
+            return nodes;
+        }
+
+        /**
+         * @brief Topological order that visits the DAG front by front (Kahn).
+         *
+         * Program order is also topological; this order instead groups
+         * operations that become ready together.
+         */
+        std::vector<uint32_t> topological_order() const {
+            std::vector<uint32_t> order = sources();
+            order.reserve(size());
+            std::vector<uint32_t> remaining(size());
+            for (uint32_t node = 0; node < size(); ++node) {
+                remaining[node] = in_degree(node);
+            }
+            for (size_t head = 0; head < order.size(); ++head) {
+                for (uint32_t succ : successors(order[head])) {
+                    if (--remaining[succ] == 0) {
+                        order.push_back(succ);
+                    }
+                }
+            }
+            return order;
+        }
+
+        // Heap memory held by the adjacency arrays
+        size_t memory_bytes() const {
+            return (pred_offsets.capacity() + preds.capacity() +
+                    succ_offsets.capacity() + succs.capacity()) * sizeof(uint32_t);
+        }
+    };
+
+}; // namespace qarser
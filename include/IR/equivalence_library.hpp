@@ -0,0 +1,132 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "opcode.hpp"
+#include "SA/library/gate_library.hpp"
+
+
+namespace qarser {
+
+    // Equivalences besides the qelib1 definitions, each named after the gate it implements
+    inline constexpr const char* EQUIVALENCES_SOURCE = R"(OPENQASM 2.0;
+// Identities
+gate id a { }
+gate u0(gamma) a { }
+
+// Euler forms of U
+gate u3(theta,phi,lambda) q { rz(lambda) q; ry(theta) q; rz(phi) q; }
+gate u3(theta,phi,lambda) q { rz(lambda) q; sx q; rz(theta+pi) q; sx q; rz(phi+pi) q; }
+gate u2(phi,lambda) q { rz(lambda-pi/2) q; sx q; rz(phi+pi/2) q; }
+
+// Phases as Z rotations
+gate u1(lambda) q { rz(lambda) q; }
+gate p(lambda) q { rz(lambda) q; }
+gate z a { rz(pi) a; }
+gate s a { rz(pi/2) a; }
+gate sdg a { rz(-pi/2) a; }
+gate t a { rz(pi/4) a; }
+gate tdg a { rz(-pi/4) a; }
+
+// Rotations through each other
+gate rx(theta) a { h a; rz(theta) a; h a; }
+gate ry(theta) a { sx a; rz(theta) a; sxdg a; }
+gate ry(theta) a { rz(-pi/2) a; rx(theta) a; rz(pi/2) a; }
+gate x a { rx(pi) a; }
+gate x a { sx a; sx a; }
+gate y a { ry(pi) a; }
+gate y a { rz(pi) a; x a; }
+gate sx a { rx(pi/2) a; }
+gate sxdg a { rx(-pi/2) a; }
+gate sxdg a { rz(pi) a; sx a; rz(pi) a; }
+gate h a { rz(pi/2) a; sx a; rz(pi/2) a; }
+
+// Two-qubit gates
+gate cx a,b { h b; cz a,b; h b; }
+)";
+
+
+    /**
+     * @brief Rewrite rules between the builtin and qelib1 gates.
+     *
+     * A rule states that a gate equals the body of a gate definition up to
+     * global phase. The rules are the qelib1 definitions themselves plus
+     * EQUIVALENCES_SOURCE, which adds the directions needed to reach other
+     * native sets (Euler forms of U, rotations through each other, CX
+     * through CZ). The library is built once on first use and never
+     * modified afterwards.
+     */
+    class EquivalenceLibrary {
+    public:
+        struct Rule {
+            OpCode target;
+            const GateDef* definition;
+            std::vector<OpCode> calls;      // gates the body calls, in order
+        };
+
+    private:
+        std::unique_ptr<Program> program;
+        std::vector<Rule> rules;
+
+    public:
+        EquivalenceLibrary(EquivalenceLibrary&&) = default;
+        EquivalenceLibrary(const EquivalenceLibrary&) = delete;
+        EquivalenceLibrary& operator=(const EquivalenceLibrary&) = delete;
+
+        const std::vector<Rule>& get_rules() const {
+            return rules;
+        }
+
+        static const EquivalenceLibrary& standard() {
+            static const EquivalenceLibrary library = build();
+            return library;
+        }
+
+    private:
+        EquivalenceLibrary() = default;
+
+        static EquivalenceLibrary build() {
+            EquivalenceLibrary library;
+            const GateLibrary& qelib1 = GateLibrary::qelib1();
+            for (size_t i = 0; i < static_cast<size_t>(OpCode::GATE); ++i) {
+                OpCode code = static_cast<OpCode>(i);
+                if (const GateDef* def = qelib1.find_definition(op_info(code).name)) {
+                    library.add(code, *def);
+                }
+            }
+
+            library.program = Parser(EQUIVALENCES_SOURCE).parse();
+            for (const auto& stmt : library.program->statements) {
+                if (stmt->kind() != Statement::Kind::GATE_DEF) {
+                    continue;
+                }
+                const auto& def = static_cast<const GateDef&>(*stmt);
+                auto code = opcode_from_name(def.name);
+                if (!code) {
+                    throw std::logic_error("Equivalence for unknown gate '" + def.name + "'");
+                }
+                library.add(*code, def);
+            }
+            return library;
+        }
+
+        void add(OpCode target, const GateDef& def) {
+            Rule rule{target, &def, {}};
+            for (const auto& stmt : def.body) {
+                if (stmt->kind() != Statement::Kind::GATE) {
+                    continue;
+                }
+                const auto& call = static_cast<const Gate&>(*stmt);
+                auto code = opcode_from_name(call.name);
+                if (!code) {
+                    throw std::logic_error("Unknown gate '" + call.name + "' in equivalence for '" + def.name + "'");
+                }
+                rule.calls.push_back(*code);
+            }
+            rules.push_back(std::move(rule));
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,423 @@
+#pragma once
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "circuit.hpp"
+#include "AST/gate.hpp"
+#include "AST/expression.hpp"
+#include "SA/library/gate_library.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Stack bytecode for a parameter expression over parameter slots.
+     */
+    struct ParamInstr {
+        enum class Op : uint8_t { CONST, LOAD, NEG, ADD, SUB, MUL, DIV, SIN, COS, TAN, EXP, LN };
+
+        Op op;
+        uint32_t slot = 0;      // LOAD
+        double value = 0.0;     // CONST
+    };
+
+
+    // Compiles an expression inside a gate definition, identifiers load parameter slots
+    class ParamCompiler : public BaseVisitor {
+    private:
+        const GateDef& def;
+        std::vector<ParamInstr>& code;
+
+    public:
+        ParamCompiler(const GateDef& def, std::vector<ParamInstr>& code)
+            : def(def), code(code) {}
+
+        void visit(NumberExpr& expr) override {
+            code.push_back(ParamInstr{ParamInstr::Op::CONST, 0, expr.value});
+        }
+
+        void visit(IdentifierExpr& expr) override {
+            for (size_t i = 0; i < def.params.size(); ++i) {
+                if (def.params[i] == expr.name) {
+                    code.push_back(ParamInstr{ParamInstr::Op::LOAD, static_cast<uint32_t>(i)});
+                    return;
+                }
+            }
+            throw std::runtime_error("Undeclared parameter '" + expr.name + "' in gate '" + def.name + "'");
+        }
+
+        void visit(UnaryExpr& expr) override {
+            expr.operand->accept(*this);
+            switch (expr.op) {
+                case UnaryExpr::Op::Neg: code.push_back({ParamInstr::Op::NEG}); break;
+                case UnaryExpr::Op::Pos: break;
+                case UnaryExpr::Op::Sin: code.push_back({ParamInstr::Op::SIN}); break;
+                case UnaryExpr::Op::Cos: code.push_back({ParamInstr::Op::COS}); break;
+                case UnaryExpr::Op::Tan: code.push_back({ParamInstr::Op::TAN}); break;
+                case UnaryExpr::Op::Exp: code.push_back({ParamInstr::Op::EXP}); break;
+                case UnaryExpr::Op::Ln:  code.push_back({ParamInstr::Op::LN}); break;
+            }
+        }
+
+        void visit(BinaryExpr& expr) override {
+            expr.left->accept(*this);
+            expr.right->accept(*this);
+            switch (expr.op) {
+                case BinaryExpr::Op::Add: code.push_back({ParamInstr::Op::ADD}); break;
+                case BinaryExpr::Op::Sub: code.push_back({ParamInstr::Op::SUB}); break;
+                case BinaryExpr::Op::Mul: code.push_back({ParamInstr::Op::MUL}); break;
+                case BinaryExpr::Op::Div: code.push_back({ParamInstr::Op::DIV}); break;
+            }
+        }
+    };
+
+
+    /**
+     * @brief Expansion of one gate definition into primitive operations.
+     *
+     * Qubits refer to the definition's qubit arguments by position, and
+     * every parameter is a bytecode range evaluated against the call's
+     * parameter values; constant parameters are folded to a single CONST.
+     */
+    struct ExpansionTemplate {
+        struct Op {
+            OpCode code;
+            uint32_t qubit_offset;
+            uint32_t num_qubits;
+            uint32_t param_offset;
+            uint32_t num_params;
+        };
+
+        struct Param {
+            uint32_t code_offset;
+            uint32_t code_size;
+        };
+
+        // Buffers reused across instantiations
+        struct Workspace {
+            std::vector<uint32_t> qubits;
+            std::vector<double> values;
+            std::vector<double> stack;
+        };
+
+        std::vector<Op> ops;
+        std::vector<uint32_t> qubit_slots;
+        std::vector<Param> params;
+        std::vector<ParamInstr> code;
+
+        // One operation on the slots in order with the parameters passed through
+        static ExpansionTemplate single(OpCode op_code, uint32_t num_qubits, uint32_t num_params) {
+            ExpansionTemplate expansion;
+            std::vector<uint32_t> args(num_qubits);
+            std::vector<std::vector<ParamInstr>> param_code(num_params);
+            for (uint32_t q = 0; q < num_qubits; ++q) {
+                args[q] = q;
+            }
+            for (uint32_t p = 0; p < num_params; ++p) {
+                param_code[p].push_back(ParamInstr{ParamInstr::Op::LOAD, p});
+            }
+            expansion.add(op_code, args, param_code);
+            return expansion;
+        }
+
+        /**
+         * @brief Expands the body of a gate definition.
+         *
+         * resolve(call) returns the template of the gate each statement of
+         * the body calls. Barriers have no effect inside a gate and are dropped.
+         */
+        template <typename Resolve>
+        static ExpansionTemplate compose(const GateDef& def, Resolve&& resolve) {
+            ExpansionTemplate expansion;
+            for (const auto& stmt : def.body) {
+                if (stmt->kind() != Statement::Kind::GATE) {
+                    continue;
+                }
+                const auto& call = static_cast<const Gate&>(*stmt);
+
+                // Qubit and parameter arguments in terms of this definition's slots
+                std::vector<uint32_t> args;
+                for (const auto& ref : call.qubits) {
+                    args.push_back(qubit_slot(def, ref));
+                }
+                std::vector<std::vector<ParamInstr>> arg_code;
+                for (const auto& param : call.params) {
+                    arg_code.emplace_back();
+                    ParamCompiler compiler(def, arg_code.back());
+                    param->accept(compiler);
+                }
+                expansion.add(resolve(call), args, arg_code);
+            }
+            return expansion;
+        }
+
+        // Appends `inner` applied to the given slots and parameter code
+        void add(const ExpansionTemplate& inner, const std::vector<uint32_t>& args,
+                 const std::vector<std::vector<ParamInstr>>& arg_code) {
+            for (const auto& op : inner.ops) {
+                std::vector<uint32_t> op_args;
+                for (uint32_t q = 0; q < op.num_qubits; ++q) {
+                    op_args.push_back(args[inner.qubit_slots[op.qubit_offset + q]]);
+                }
+                std::vector<std::vector<ParamInstr>> op_code;
+                for (uint32_t p = 0; p < op.num_params; ++p) {
+                    const auto& param = inner.params[op.param_offset + p];
+                    op_code.emplace_back();
+                    for (uint32_t i = 0; i < param.code_size; ++i) {
+                        const ParamInstr& instr = inner.code[param.code_offset + i];
+                        if (instr.op == ParamInstr::Op::LOAD) {
+                            const auto& sub = arg_code[instr.slot];
+                            op_code.back().insert(op_code.back().end(), sub.begin(), sub.end());
+                        }
+                        else {
+                            op_code.back().push_back(instr);
+                        }
+                    }
+                }
+                add(op.code, op_args, op_code);
+            }
+        }
+
+        void add(OpCode op_code, const std::vector<uint32_t>& args,
+                 std::vector<std::vector<ParamInstr>>& param_code) {
+            Op op;
+            op.code = op_code;
+            op.qubit_offset = static_cast<uint32_t>(qubit_slots.size());
+            op.num_qubits = static_cast<uint32_t>(args.size());
+            op.param_offset = static_cast<uint32_t>(params.size());
+            op.num_params = static_cast<uint32_t>(param_code.size());
+            qubit_slots.insert(qubit_slots.end(), args.begin(), args.end());
+            for (auto& code_range : param_code) {
+                fold(code_range);
+                params.push_back(Param{static_cast<uint32_t>(code.size()),
+                                       static_cast<uint32_t>(code_range.size())});
+                code.insert(code.end(), code_range.begin(), code_range.end());
+            }
+            ops.push_back(op);
+        }
+
+        // Appends the operations of one call site to `result`
+        void instantiate(Span<const uint32_t> call_qubits, Span<const double> call_params,
+                         Circuit& result, Workspace& workspace) const {
+            for (const auto& op : ops) {
+                workspace.qubits.resize(op.num_qubits);
+                for (uint32_t q = 0; q < op.num_qubits; ++q) {
+                    workspace.qubits[q] = call_qubits[qubit_slots[op.qubit_offset + q]];
+                }
+                workspace.values.resize(op.num_params);
+                for (uint32_t p = 0; p < op.num_params; ++p) {
+                    const auto& param = params[op.param_offset + p];
+                    workspace.values[p] = evaluate(code.data() + param.code_offset, param.code_size,
+                                                   call_params, workspace.stack);
+                }
+                result.add(op.code, workspace.qubits.data(), workspace.qubits.size(),
+                           workspace.values.data(), workspace.values.size());
+            }
+        }
+
+        static double evaluate(const ParamInstr* code, uint32_t size, Span<const double> slots,
+                               std::vector<double>& stack) {
+            if (size == 1) {
+                return code->op == ParamInstr::Op::CONST ? code->value : slots[code->slot];
+            }
+            stack.clear();
+            for (uint32_t i = 0; i < size; ++i) {
+                const ParamInstr& instr = code[i];
+                if (instr.op == ParamInstr::Op::CONST) {
+                    stack.push_back(instr.value);
+                    continue;
+                }
+                if (instr.op == ParamInstr::Op::LOAD) {
+                    stack.push_back(slots[instr.slot]);
+                    continue;
+                }
+                double right = stack.back();
+                if (instr.op >= ParamInstr::Op::ADD && instr.op <= ParamInstr::Op::DIV) {
+                    stack.pop_back();
+                }
+                double& top = stack.back();
+                switch (instr.op) {
+                    case ParamInstr::Op::NEG: top = -top; break;
+                    case ParamInstr::Op::ADD: top = top + right; break;
+                    case ParamInstr::Op::SUB: top = top - right; break;
+                    case ParamInstr::Op::MUL: top = top * right; break;
+                    case ParamInstr::Op::DIV: top = top / right; break;
+                    case ParamInstr::Op::SIN: top = std::sin(top); break;
+                    case ParamInstr::Op::COS: top = std::cos(top); break;
+                    case ParamInstr::Op::TAN: top = std::tan(top); break;
+                    case ParamInstr::Op::EXP: top = std::exp(top); break;
+                    case ParamInstr::Op::LN:  top = std::log(top); break;
+                    default: break;
+                }
+            }
+            return stack.back();
+        }
+
+    private:
+        // Replaces code that does not load any slot by its value
+        static void fold(std::vector<ParamInstr>& code) {
+            if (code.size() <= 1) {
+                return;
+            }
+            for (const auto& instr : code) {
+                if (instr.op == ParamInstr::Op::LOAD) {
+                    return;
+                }
+            }
+            std::vector<double> stack;
+            double value = evaluate(code.data(), static_cast<uint32_t>(code.size()), {}, stack);
+            code.assign(1, ParamInstr{ParamInstr::Op::CONST, 0, value});
+        }
+
+        static uint32_t qubit_slot(const GateDef& def, const RegisterRef& ref) {
+            for (size_t i = 0; i < def.qubits.size(); ++i) {
+                if (def.qubits[i].name == ref.name) {
+                    return static_cast<uint32_t>(i);
+                }
+            }
+            throw std::runtime_error("Undefined qubit '" + ref.name + "' in gate '" + def.name + "'");
+        }
+    };
+
+
+    /**
+     * @brief Flattens a Circuit to U, CX and non-unitary operations.
+     *
+     * Each gate definition is compiled once into an ExpansionTemplate, built
+     * bottom-up from the templates of the gates its body calls. A call site
+     * then only copies its template, mapping qubit slots to the call's
+     * qubits and evaluating the (usually constant) parameter slots.
+     * Barriers inside gate bodies have no effect once inlined and are dropped.
+     */
+    class Inliner {
+    private:
+        const GateLibrary& library;
+        std::unordered_map<const GateDef*, ExpansionTemplate> templates;
+        std::unordered_set<const GateDef*> in_progress;
+        std::unordered_map<std::string, const GateDef*> definitions;
+        std::vector<const ExpansionTemplate*> by_opcode;
+        std::vector<const ExpansionTemplate*> by_gate;
+        const ExpansionTemplate u = ExpansionTemplate::single(OpCode::U, 1, 3);
+        const ExpansionTemplate cx = ExpansionTemplate::single(OpCode::CX, 2, 0);
+        ExpansionTemplate::Workspace workspace;
+
+    public:
+        explicit Inliner(const GateLibrary& library)
+            : library(library) {}
+
+        Circuit inline_circuit(const Circuit& circuit) {
+            add_definitions(circuit);
+            by_opcode.assign(static_cast<size_t>(OpCode::GATE), nullptr);
+            by_gate.assign(circuit.get_gates().size(), nullptr);
+
+            Circuit result;
+            for (const auto& reg : circuit.get_qregs()) result.add_qreg(reg.name, reg.size);
+            for (const auto& reg : circuit.get_cregs()) result.add_creg(reg.name, reg.size);
+
+            // Size the output exactly so instantiation never reallocates
+            size_t num_ops = 0, num_qubits = 0, num_params = 0;
+            for (const auto& op : circuit.get_operations()) {
+                const ExpansionTemplate* expansion = expansion_of(circuit, op);
+                if (!expansion) {
+                    num_ops += 1;
+                    num_qubits += op.num_qubits;
+                    num_params += op.num_params;
+                    continue;
+                }
+                num_ops += expansion->ops.size();
+                num_qubits += expansion->qubit_slots.size();
+                num_params += expansion->params.size();
+            }
+            result.reserve(num_ops, num_qubits, num_params);
+
+            for (const auto& op : circuit.get_operations()) {
+                const ExpansionTemplate* expansion = expansion_of(circuit, op);
+                if (!expansion) {
+                    auto q = circuit.qubits(op);
+                    auto p = circuit.params(op);
+                    auto c = circuit.clbits(op);
+                    result.add(op.code, q.data, q.size(), p.data, p.size(), c.data, c.size());
+                    continue;
+                }
+                expansion->instantiate(circuit.qubits(op), circuit.params(op), result, workspace);
+            }
+            return result;
+        }
+
+        // Makes the circuit's own gates callable from the definitions compiled next,
+        // replacing those of the previous circuit along with their templates
+        void add_definitions(const Circuit& circuit) {
+            for (const auto& [name, def] : definitions) {
+                templates.erase(def);
+            }
+            definitions.clear();
+            for (const auto& gate : circuit.get_gates()) {
+                if (gate.definition) {
+                    definitions.emplace(gate.name, gate.definition);
+                }
+            }
+        }
+
+        // Template of a gate definition, compiled on first use
+        const ExpansionTemplate& compile(const GateDef& def) {
+            auto it = templates.find(&def);
+            if (it != templates.end()) {
+                return it->second;
+            }
+            if (!in_progress.insert(&def).second) {
+                throw std::runtime_error("Recursive gate definition '" + def.name + "'");
+            }
+
+            auto resolve = [&](const Gate& call) -> const ExpansionTemplate& {
+                if (call.name == "U" || call.name == "CX") {
+                    return call.name == "U" ? u : cx;
+                }
+                const GateDef* callee = find_definition(call.name);
+                if (!callee) {
+                    throw std::runtime_error("Cannot inline undeclared gate '" + call.name + "'");
+                }
+                return compile(*callee);
+            };
+            ExpansionTemplate expansion = ExpansionTemplate::compose(def, resolve);
+
+            in_progress.erase(&def);
+            return templates.emplace(&def, std::move(expansion)).first->second;
+        }
+
+    private:
+        const GateDef* find_definition(const std::string& name) const {
+            auto it = definitions.find(name);
+            if (it != definitions.end()) {
+                return it->second;
+            }
+            return library.find_definition(name);
+        }
+
+        // Template for a gate operation, nullptr if it is kept as is
+        const ExpansionTemplate* expansion_of(const Circuit& circuit, const Operation& op) {
+            if (op.code == OpCode::GATE) {
+                const ExpansionTemplate*& cached = by_gate[op.gate];
+                if (!cached) {
+                    cached = &compile(*circuit.get_gate(op.gate).definition);
+                }
+                return cached;
+            }
+            if (!is_unitary(op.code) || op.code == OpCode::U || op.code == OpCode::CX) {
+                return nullptr;
+            }
+            const ExpansionTemplate*& cached = by_opcode[static_cast<size_t>(op.code)];
+            if (!cached) {
+                const GateDef* def = library.find_definition(op_info(op.code).name);
+                if (!def) {
+                    throw std::runtime_error(std::string("No definition for gate '") + op_info(op.code).name + "'");
+                }
+                cached = &compile(*def);
+            }
+            return cached;
+        }
+    };
+
+}; // namespace qarser
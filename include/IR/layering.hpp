@@ -0,0 +1,284 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "circuit.hpp"
+#include "dag.hpp"
+#include "utils/thread_pool.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Duration of each operation in integer time units.
+     *
+     * Defaults to one unit per operation and zero for barriers, which makes
+     * ASAP start times equal to moment indices.
+     */
+    struct GateDurations {
+        uint32_t by_code[static_cast<size_t>(OpCode::BARRIER) + 1];
+        std::vector<uint32_t> by_gate;      // OpCode::GATE by gate id, 1 if missing
+
+        GateDurations() {
+            for (auto& duration : by_code) duration = 1;
+            set(OpCode::BARRIER, 0);
+        }
+
+        void set(OpCode code, uint32_t duration) {
+            by_code[static_cast<size_t>(code)] = duration;
+        }
+
+        uint32_t of(const Operation& op) const {
+            if (op.code == OpCode::GATE && op.gate < by_gate.size()) {
+                return by_gate[op.gate];
+            }
+            return by_code[static_cast<size_t>(op.code)];
+        }
+    };
+
+
+    struct Layers {
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint64_t> asap;             // earliest start time per operation
+        std::vector<uint64_t> alap;             // latest start time that keeps the depth
+        std::vector<uint32_t> critical_pred;    // predecessor that determines the ASAP start
+        uint64_t depth = 0;
+        std::vector<uint32_t> critical_path;    // operations in program order
+        std::vector<uint64_t> layer_starts;     // distinct ASAP starts of operations with a non-zero duration
+        std::vector<uint32_t> parallelism;      // operations starting at each of layer_starts
+
+        uint64_t slack(uint32_t op) const {
+            return alap[op] - asap[op];
+        }
+    };
+
+
+    /**
+     * @brief ASAP/ALAP scheduling, depth and critical path.
+     *
+     * `compute` processes the dependency DAG wavefront by wavefront: all
+     * operations whose predecessors are done are scheduled together, split
+     * into chunks of at least MIN_GRAIN operations, about four per thread;
+     * wavefronts that fit in one chunk run on the calling thread. Each operation reads only finished predecessors, so
+     * the result is identical to the serial per-qubit timeline sweep of
+     * `compute_serial`. Ties for the critical predecessor go to the lowest
+     * operation index.
+     */
+    class Layering {
+    private:
+        static constexpr size_t GRAIN = 4096;
+        static constexpr size_t MIN_GRAIN = 64;
+
+        const Circuit& circuit;
+        GateDurations durations;
+        ThreadPool& pool;
+
+    public:
+        Layering(const Circuit& circuit, GateDurations durations = {},
+                 ThreadPool& pool = ThreadPool::shared())
+            : circuit(circuit), durations(std::move(durations)), pool(pool) {}
+
+        Layers compute(const DependencyDag& dag) const {
+            size_t n = circuit.size();
+            Layers layers;
+            layers.asap.assign(n, 0);
+            layers.alap.assign(n, 0);
+            layers.critical_pred.assign(n, Layers::NONE);
+
+            std::vector<uint32_t> duration(n);
+            pool.parallel_for(n, GRAIN, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) duration[i] = durations.of(circuit[i]);
+            });
+
+            // Forward wavefronts
+            std::unique_ptr<std::atomic<uint32_t>[]> remaining(new std::atomic<uint32_t>[n]);
+            for (uint32_t v = 0; v < n; ++v) remaining[v].store(dag.in_degree(v), std::memory_order_relaxed);
+            wavefronts(dag.sources(), remaining.get(), [&](uint32_t v) {
+                uint64_t start = 0;
+                uint32_t critical = Layers::NONE;
+                for (uint32_t p : dag.predecessors(v)) {
+                    uint64_t finish = layers.asap[p] + duration[p];
+                    if (critical == Layers::NONE || finish > start) {
+                        start = finish;
+                        critical = p;
+                    }
+                }
+                layers.asap[v] = start;
+                layers.critical_pred[v] = critical;
+                return dag.successors(v);
+            });
+
+            for (uint32_t v = 0; v < n; ++v) {
+                layers.depth = std::max(layers.depth, layers.asap[v] + duration[v]);
+            }
+
+            // Backward wavefronts
+            std::vector<uint32_t> sinks;
+            for (uint32_t v = 0; v < n; ++v) {
+                remaining[v].store(dag.out_degree(v), std::memory_order_relaxed);
+                if (dag.out_degree(v) == 0) sinks.push_back(v);
+            }
+            wavefronts(std::move(sinks), remaining.get(), [&](uint32_t v) {
+                uint64_t end = layers.depth;
+                for (uint32_t s : dag.successors(v)) {
+                    end = std::min(end, layers.alap[s]);
+                }
+                layers.alap[v] = end - duration[v];
+                return dag.predecessors(v);
+            });
+
+            finish(layers, duration);
+            return layers;
+        }
+
+        Layers compute() const {
+            return compute(DependencyDag(circuit));
+        }
+
+        // Reference implementation: one sweep per direction over per-wire timelines
+        Layers compute_serial() const {
+            size_t n = circuit.size();
+            uint32_t num_qubits = circuit.get_num_qubits();
+            size_t num_wires = num_qubits + circuit.get_num_clbits();
+            Layers layers;
+            layers.asap.assign(n, 0);
+            layers.alap.assign(n, 0);
+            layers.critical_pred.assign(n, Layers::NONE);
+
+            std::vector<uint32_t> duration(n);
+            for (size_t i = 0; i < n; ++i) duration[i] = durations.of(circuit[i]);
+
+            std::vector<uint32_t> last(num_wires, Layers::NONE);
+            std::vector<uint32_t> wires;
+            for (uint32_t v = 0; v < n; ++v) {
+                wires_of(v, num_qubits, wires);
+                uint64_t start = 0;
+                uint32_t critical = Layers::NONE;
+                for (uint32_t w : wires) {
+                    uint32_t p = last[w];
+                    if (p == Layers::NONE) continue;
+                    uint64_t finish = layers.asap[p] + duration[p];
+                    if (critical == Layers::NONE || finish > start || (finish == start && p < critical)) {
+                        start = finish;
+                        critical = p;
+                    }
+                }
+                layers.asap[v] = start;
+                layers.critical_pred[v] = critical;
+                layers.depth = std::max(layers.depth, start + duration[v]);
+                for (uint32_t w : wires) last[w] = v;
+            }
+
+            std::vector<uint64_t> latest(num_wires, layers.depth);
+            for (size_t i = n; i-- > 0;) {
+                uint32_t v = static_cast<uint32_t>(i);
+                wires_of(v, num_qubits, wires);
+                uint64_t end = layers.depth;
+                for (uint32_t w : wires) end = std::min(end, latest[w]);
+                layers.alap[v] = end - duration[v];
+                for (uint32_t w : wires) latest[w] = layers.alap[v];
+            }
+
+            finish(layers, duration);
+            return layers;
+        }
+
+    private:
+        /**
+         * @brief Runs visit(v) on every node, one wavefront at a time.
+         *
+         * visit returns the nodes that depend on v; the last of their
+         * dependencies to finish moves them into the next wavefront.
+         */
+        template <typename Visit>
+        void wavefronts(std::vector<uint32_t> front, std::atomic<uint32_t>* remaining, Visit&& visit) const {
+            std::vector<std::vector<uint32_t>> ready;
+            std::vector<uint32_t> next;
+            while (!front.empty()) {
+                next.clear();
+                size_t grain = std::max(MIN_GRAIN, front.size() / (4 * pool.size()));
+                if (front.size() <= grain || pool.size() == 1) {
+                    for (uint32_t v : front) {
+                        for (uint32_t u : visit(v)) {
+                            if (remaining[u].fetch_sub(1, std::memory_order_relaxed) == 1) next.push_back(u);
+                        }
+                    }
+                }
+                else {
+                    ready.assign((front.size() + grain - 1) / grain, {});
+                    pool.parallel_for(front.size(), grain, [&](size_t chunk, size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; ++i) {
+                            for (uint32_t u : visit(front[i])) {
+                                if (remaining[u].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                                    ready[chunk].push_back(u);
+                                }
+                            }
+                        }
+                    });
+                    for (const auto& nodes : ready) {
+                        next.insert(next.end(), nodes.begin(), nodes.end());
+                    }
+                }
+                front.swap(next);
+            }
+        }
+
+        void wires_of(uint32_t v, uint32_t num_qubits, std::vector<uint32_t>& wires) const {
+            wires.clear();
+            for (uint32_t q : circuit.qubits(circuit[v])) wires.push_back(q);
+            for (uint32_t c : circuit.clbits(circuit[v])) wires.push_back(num_qubits + c);
+        }
+
+        void finish(Layers& layers, const std::vector<uint32_t>& duration) const {
+            size_t n = layers.asap.size();
+            uint32_t last = Layers::NONE;
+            for (uint32_t v = 0; v < n; ++v) {
+                if (last == Layers::NONE && duration[v] > 0 && layers.asap[v] + duration[v] == layers.depth) {
+                    last = v;
+                }
+            }
+            count_starts(layers, duration);
+            for (uint32_t v = last; v != Layers::NONE; v = layers.critical_pred[v]) {
+                layers.critical_path.push_back(v);
+            }
+            std::reverse(layers.critical_path.begin(), layers.critical_path.end());
+        }
+
+        // Histogram of ASAP starts, dense while the depth is at most one slot per operation
+        static void count_starts(Layers& layers, const std::vector<uint32_t>& duration) {
+            size_t n = layers.asap.size();
+            layers.layer_starts.clear();
+            layers.parallelism.clear();
+            if (layers.depth <= n) {
+                std::vector<uint32_t> count(layers.depth, 0);
+                for (size_t v = 0; v < n; ++v) {
+                    if (duration[v] > 0) ++count[layers.asap[v]];
+                }
+                for (uint64_t start = 0; start < count.size(); ++start) {
+                    if (count[start] > 0) {
+                        layers.layer_starts.push_back(start);
+                        layers.parallelism.push_back(count[start]);
+                    }
+                }
+                return;
+            }
+            std::vector<uint64_t> starts;
+            for (size_t v = 0; v < n; ++v) {
+                if (duration[v] > 0) starts.push_back(layers.asap[v]);
+            }
+            std::sort(starts.begin(), starts.end());
+            for (size_t i = 0; i < starts.size(); ++i) {
+                if (i == 0 || starts[i] != starts[i - 1]) {
+                    layers.layer_starts.push_back(starts[i]);
+                    layers.parallelism.push_back(0);
+                }
+                ++layers.parallelism.back();
+            }
+        }
+    };
+
+}; // namespace qarser
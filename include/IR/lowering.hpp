@@ -0,0 +1,352 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "circuit.hpp"
+#include "AST/gate.hpp"
+#include "AST/evaluator.hpp"
+#include "SA/library/gate_library.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Lowers an analyzed Program to a linear Circuit.
+     *
+     * Lowering runs in two passes. The first resolves names once per
+     * statement into a step: every operand becomes a base global index plus
+     * a stride (1 for a whole register, 0 for a single qubit) and parameters
+     * are evaluated once. The second reserves the exact pool sizes and
+     * expands broadcasts in a tight loop over integers.
+     *
+     * A repeat is lowered once, as a loop over the steps of its body; each
+     * iteration adds its register shifts to the operands during expansion,
+     * so only the output grows with the repeat count.
+     *
+     * The program must have passed semantic analysis with `library` active;
+     * anything that cannot be resolved throws std::runtime_error.
+     */
+    class CircuitLowering : public BaseVisitor {
+    private:
+        struct Operand {
+            uint32_t base;
+            uint32_t stride;
+            uint32_t slot;              // register, indexes `shift` during expansion
+        };
+
+        struct Target {
+            OpCode code;
+            uint32_t gate;
+        };
+
+        // One statement with its names resolved
+        struct Step {
+            Target target;
+            uint32_t width;             // number of operations it expands to
+            uint32_t operand_offset;
+            uint32_t num_operands;
+            uint32_t param_offset;
+            uint32_t num_params;
+            bool has_clbit;
+            Operand clbit;
+        };
+
+        // Steps [begin, end) run `count` times
+        struct Loop {
+            uint32_t begin;
+            uint32_t end;
+            uint32_t count;
+            uint32_t shift_offset;      // into loop_shifts
+            uint32_t num_shifts;
+        };
+
+        const GateLibrary& library;
+        Circuit circuit;
+
+        std::unordered_map<std::string, uint32_t> qreg_ids;
+        std::unordered_map<std::string, uint32_t> creg_ids;
+        std::unordered_map<std::string, Target> targets;
+        std::unordered_map<std::string, uint32_t> slots;
+
+        std::vector<Loop> loops;
+        std::vector<std::pair<uint32_t, long long>> loop_shifts;    // slot, stride
+        std::vector<long long> shift;                               // slot -> offset of the current iterations
+        int repeat_depth = 0;
+
+        std::vector<Step> steps;
+        std::vector<Operand> operands;
+        std::vector<double> params;
+        std::vector<uint32_t> qubits;
+        size_t num_operations = 0;
+        size_t num_qubit_operands = 0;
+        size_t num_param_operands = 0;
+
+    public:
+        explicit CircuitLowering(const GateLibrary& library)
+            : library(library) {}
+
+        Circuit lower(Program& program) {
+            program.accept(*this);
+            return std::move(circuit);
+        }
+
+        void visit(Program& program) override {
+            for (const auto& stmt : program.statements) {
+                stmt->accept(*this);
+            }
+            circuit.reserve(num_operations, num_qubit_operands, num_param_operands);
+            shift.assign(slots.size(), 0);
+            size_t loop = 0;
+            expand_range(0, static_cast<uint32_t>(steps.size()), loop);
+        }
+
+        void visit(QRegister& qreg) override {
+            qreg_ids.emplace(qreg.name, circuit.add_qreg(qreg.name, qreg.size));
+            slots.emplace(qreg.name, static_cast<uint32_t>(slots.size()));
+        }
+
+        void visit(CRegister& creg) override {
+            creg_ids.emplace(creg.name, circuit.add_creg(creg.name, creg.size));
+            slots.emplace(creg.name, static_cast<uint32_t>(slots.size()));
+        }
+
+        void visit(GateDef& gate_def) override {
+            uint32_t id = circuit.add_gate(gate_def.name, gate_def.params.size(),
+                                           gate_def.qubits.size(), &gate_def);
+            targets.emplace(gate_def.name, Target{OpCode::GATE, id});
+        }
+
+        void visit(Gate& gate) override {
+            Step step = begin_step(resolve_gate(gate.name, gate.line));
+            for (const auto& param : gate.params) {
+                auto value = ExpressionEvaluator::evaluate_constant(*param);
+                if (!value) {
+                    throw std::runtime_error("Non-constant parameter of gate '" + gate.name +
+                                             "' at line " + std::to_string(gate.line));
+                }
+                params.push_back(*value);
+            }
+            step.width = resolve_operands(gate.qubits, qreg_ids, circuit.get_qregs(), gate.line);
+            end_step(step);
+        }
+
+        void visit(Measure& measure) override {
+            Step step = begin_step(Target{OpCode::MEASURE, 0});
+            uint32_t cwidth = resolve_operands(measure.cbits, creg_ids, circuit.get_cregs(), measure.line);
+            step.has_clbit = true;
+            step.clbit = operands.back();
+            operands.pop_back();
+            step.width = resolve_operands(measure.qubits, qreg_ids, circuit.get_qregs(), measure.line);
+            if (step.width != cwidth) {
+                throw std::runtime_error("Measure operands of different sizes at line " +
+                                         std::to_string(measure.line));
+            }
+            end_step(step);
+        }
+
+        void visit(Reset& reset) override {
+            Step step = begin_step(Target{OpCode::RESET, 0});
+            step.width = resolve_operands({reset.qubit}, qreg_ids, circuit.get_qregs(), reset.line);
+            end_step(step);
+        }
+
+        void visit(Barrier& barrier) override {
+            // A single operation over every named qubit
+            Step step = begin_step(Target{OpCode::BARRIER, 0});
+            step.width = 1;
+            for (const auto& ref : barrier.qubits) {
+                const auto& reg = circuit.get_qregs()[find_register(ref, qreg_ids, barrier.line)];
+                if (ref.isRefWholeRegister()) {
+                    for (uint32_t i = 0; i < reg.size; ++i) {
+                        operands.push_back(Operand{reg.offset + i, 0, slots.at(ref.name)});
+                    }
+                }
+                else {
+                    operands.push_back(Operand{reg.offset + checked_index(ref, reg, barrier.line), 0,
+                                               slots.at(ref.name)});
+                }
+            }
+            end_step(step);
+        }
+
+        void visit(Repeat& repeat) override {
+            if (repeat.count <= 0) {
+                return;
+            }
+            if (repeat_depth == 0) {
+                check_shifts(repeat);
+            }
+            Loop loop{static_cast<uint32_t>(steps.size()), 0, static_cast<uint32_t>(repeat.count),
+                      static_cast<uint32_t>(loop_shifts.size()), 0};
+            for (const auto& s : repeat.shifts) {
+                auto it = slots.find(s.name);
+                if (it == slots.end()) {
+                    throw std::runtime_error("Cannot lower undeclared register '" + s.name +
+                                             "' at line " + std::to_string(repeat.line));
+                }
+                loop_shifts.emplace_back(it->second, s.stride);
+            }
+            loop.num_shifts = static_cast<uint32_t>(loop_shifts.size()) - loop.shift_offset;
+            size_t index = loops.size();
+            loops.push_back(loop);
+
+            size_t operations_before = num_operations;
+            size_t qubit_operands_before = num_qubit_operands;
+            size_t param_operands_before = num_param_operands;
+            ++repeat_depth;
+            for (const auto& stmt : repeat.body) {
+                stmt->accept(*this);
+            }
+            --repeat_depth;
+            loops[index].end = static_cast<uint32_t>(steps.size());
+            if (loops[index].begin == loops[index].end) {
+                loops.erase(loops.begin() + index);
+                loop_shifts.resize(loop.shift_offset);
+                return;
+            }
+            size_t extra = repeat.count - 1;
+            num_operations += extra * (num_operations - operations_before);
+            num_qubit_operands += extra * (num_qubit_operands - qubit_operands_before);
+            num_param_operands += extra * (num_param_operands - param_operands_before);
+        }
+
+    private:
+        Target resolve_gate(const std::string& name, int line) {
+            auto it = targets.find(name);
+            if (it != targets.end()) {
+                return it->second;
+            }
+            auto code = opcode_from_name(name);
+            bool known = name == "U" || name == "CX" || library.find_definition(name);
+            if (!code || !known) {
+                throw std::runtime_error("Cannot lower undeclared gate '" + name +
+                                         "' at line " + std::to_string(line));
+            }
+            Target target{*code, 0};
+            targets.emplace(name, target);
+            return target;
+        }
+
+        Step begin_step(Target target) {
+            Step step{};
+            step.target = target;
+            step.operand_offset = static_cast<uint32_t>(operands.size());
+            step.param_offset = static_cast<uint32_t>(params.size());
+            return step;
+        }
+
+        void end_step(Step& step) {
+            step.num_operands = static_cast<uint32_t>(operands.size()) - step.operand_offset;
+            step.num_params = static_cast<uint32_t>(params.size()) - step.param_offset;
+            num_operations += step.width;
+            num_qubit_operands += size_t(step.width) * step.num_operands;
+            num_param_operands += size_t(step.width) * step.num_params;
+            steps.push_back(step);
+        }
+
+        // Expands steps [begin, end), running the loops starting at `loop` that lie inside
+        void expand_range(uint32_t begin, uint32_t end, size_t& loop) {
+            for (uint32_t s = begin; s < end;) {
+                if (loop < loops.size() && loops[loop].begin == s) {
+                    const Loop& current = loops[loop++];
+                    size_t nested = loop;
+                    for (uint32_t k = 0; k < current.count; ++k) {
+                        loop = nested;
+                        expand_range(current.begin, current.end, loop);
+                        for (uint32_t i = 0; i < current.num_shifts; ++i) {
+                            const auto& [slot, stride] = loop_shifts[current.shift_offset + i];
+                            shift[slot] += stride;
+                        }
+                    }
+                    for (uint32_t i = 0; i < current.num_shifts; ++i) {
+                        const auto& [slot, stride] = loop_shifts[current.shift_offset + i];
+                        shift[slot] -= stride * current.count;
+                    }
+                    s = current.end;
+                    continue;
+                }
+                expand(steps[s++]);
+            }
+        }
+
+        void expand(const Step& step) {
+            const Operand* ops = operands.data() + step.operand_offset;
+            const double* values = params.data() + step.param_offset;
+            qubits.resize(step.num_operands);
+            for (uint32_t i = 0; i < step.width; ++i) {
+                for (uint32_t q = 0; q < step.num_operands; ++q) {
+                    qubits[q] = ops[q].base + ops[q].stride * i + static_cast<uint32_t>(shift[ops[q].slot]);
+                }
+                uint32_t clbit = step.clbit.base + step.clbit.stride * i +
+                                 (step.has_clbit ? static_cast<uint32_t>(shift[step.clbit.slot]) : 0);
+                circuit.add(step.target.code, qubits.data(), step.num_operands,
+                            values, step.num_params,
+                            &clbit, step.has_clbit ? 1 : 0, step.target.gate);
+            }
+        }
+
+        // Appends to `operands` and returns the broadcast width
+        uint32_t resolve_operands(const std::vector<RegisterRef>& refs,
+                                  const std::unordered_map<std::string, uint32_t>& ids,
+                                  const std::vector<Circuit::Register>& registers, int line) {
+            uint32_t width = 1;
+            bool whole = false;
+            for (const auto& ref : refs) {
+                const auto& reg = registers[find_register(ref, ids, line)];
+                if (!ref.isRefWholeRegister()) {
+                    operands.push_back(Operand{reg.offset + checked_index(ref, reg, line), 0, slots.at(ref.name)});
+                    continue;
+                }
+                if (whole && reg.size != width) {
+                    throw std::runtime_error("Broadcast over registers of different sizes at line " +
+                                             std::to_string(line));
+                }
+                whole = true;
+                width = reg.size;
+                operands.push_back(Operand{reg.offset, 1, slots.at(ref.name)});
+            }
+            return width;
+        }
+
+        static uint32_t find_register(const RegisterRef& ref,
+                                      const std::unordered_map<std::string, uint32_t>& ids, int line) {
+            auto it = ids.find(ref.name);
+            if (it == ids.end()) {
+                throw std::runtime_error("Cannot lower undeclared register '" + ref.name +
+                                         "' at line " + std::to_string(line));
+            }
+            return it->second;
+        }
+
+        // Moving operands must stay inside their register in every iteration
+        void check_shifts(const Repeat& repeat) const {
+            repeat.for_each_operand([&](const RegisterRef& ref, long long low, long long high) {
+                if (low == ref.index && high == ref.index) {
+                    return;
+                }
+                const Circuit::Register* reg = nullptr;
+                if (auto it = qreg_ids.find(ref.name); it != qreg_ids.end()) {
+                    reg = &circuit.get_qregs()[it->second];
+                }
+                else if (auto it = creg_ids.find(ref.name); it != creg_ids.end()) {
+                    reg = &circuit.get_cregs()[it->second];
+                }
+                if (reg && !ref.isRefWholeRegister() && low >= 0 && high < static_cast<long long>(reg->size)) {
+                    return;
+                }
+                throw std::runtime_error("Index out of range for '" + ref.toString() +
+                                         "' in repeat at line " + std::to_string(repeat.line));
+            });
+        }
+
+        static uint32_t checked_index(const RegisterRef& ref, const Circuit::Register& reg, int line) {
+            if (ref.index < 0 || static_cast<uint32_t>(ref.index) >= reg.size) {
+                throw std::runtime_error("Index out of range for '" + ref.toString() +
+                                         "' at line " + std::to_string(line));
+            }
+            return static_cast<uint32_t>(ref.index);
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,125 @@
+#pragma once
+#include <cmath>
+#include <complex>
+#include "opcode.hpp"
+
+
+namespace qarser {
+
+    using Complex = std::complex<double>;
+
+    // 2x2 complex matrix [[a, b], [c, d]]
+    struct Matrix2 {
+        Complex a, b, c, d;
+
+        static Matrix2 identity() {
+            return {1.0, 0.0, 0.0, 1.0};
+        }
+
+        // OpenQASM U(theta, phi, lambda)
+        static Matrix2 u(double theta, double phi, double lambda) {
+            double cos = std::cos(theta / 2), sin = std::sin(theta / 2);
+            return {cos, -std::polar(sin, lambda), std::polar(sin, phi), std::polar(cos, phi + lambda)};
+        }
+
+        Matrix2 operator*(const Matrix2& m) const {
+            return {a * m.a + b * m.c, a * m.b + b * m.d,
+                    c * m.a + d * m.c, c * m.b + d * m.d};
+        }
+    };
+
+
+    struct EulerAngles {
+        double theta;
+        double phi;
+        double lambda;
+    };
+
+
+    // Whether `code` is a single-qubit gate with a known matrix
+    inline bool has_single_qubit_matrix(OpCode code) {
+        switch (code) {
+            case OpCode::U: case OpCode::U2: case OpCode::U1: case OpCode::P:
+            case OpCode::ID: case OpCode::U0:
+            case OpCode::X: case OpCode::Y: case OpCode::Z: case OpCode::H:
+            case OpCode::S: case OpCode::SDG: case OpCode::T: case OpCode::TDG:
+            case OpCode::RX: case OpCode::RY: case OpCode::RZ: case OpCode::SX: case OpCode::SXDG:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @brief Matrix of a single-qubit standard gate.
+     *
+     * Rotations are returned up to a global phase. Gates without parameters
+     * come from a precomputed table.
+     *
+     * @return false if `code` is not a single-qubit gate with a known matrix
+     */
+    inline bool single_qubit_matrix(OpCode code, const double* params, Matrix2& out) {
+        const double pi = M_PI;
+        static const Matrix2 fixed[] = {
+            Matrix2::u(pi, 0, pi),              // X
+            Matrix2::u(pi, pi / 2, pi / 2),     // Y
+            Matrix2::u(0, 0, pi),               // Z
+            Matrix2::u(pi / 2, 0, pi),          // H
+            Matrix2::u(0, 0, pi / 2),           // S
+            Matrix2::u(0, 0, -pi / 2),          // SDG
+            Matrix2::u(0, 0, pi / 4),           // T
+            Matrix2::u(0, 0, -pi / 4),          // TDG
+        };
+        switch (code) {
+            case OpCode::U:    out = Matrix2::u(params[0], params[1], params[2]); return true;
+            case OpCode::U2:   out = Matrix2::u(pi / 2, params[0], params[1]); return true;
+            case OpCode::U1:
+            case OpCode::P:
+            case OpCode::RZ:   out = {1.0, 0.0, 0.0, std::polar(1.0, params[0])}; return true;
+            case OpCode::ID:
+            case OpCode::U0:   out = Matrix2::identity(); return true;
+            case OpCode::X:    out = fixed[0]; return true;
+            case OpCode::Y:    out = fixed[1]; return true;
+            case OpCode::Z:    out = fixed[2]; return true;
+            case OpCode::H:    out = fixed[3]; return true;
+            case OpCode::S:    out = fixed[4]; return true;
+            case OpCode::SDG:  out = fixed[5]; return true;
+            case OpCode::T:    out = fixed[6]; return true;
+            case OpCode::TDG:  out = fixed[7]; return true;
+            case OpCode::RX:   out = Matrix2::u(params[0], -pi / 2, pi / 2); return true;
+            case OpCode::RY:   out = Matrix2::u(params[0], 0, 0); return true;
+            case OpCode::SX:   out = {{0.5, 0.5}, {0.5, -0.5}, {0.5, -0.5}, {0.5, 0.5}}; return true;
+            case OpCode::SXDG: out = {{0.5, -0.5}, {0.5, 0.5}, {0.5, 0.5}, {0.5, -0.5}}; return true;
+            default: return false;
+        }
+    }
+
+    // Whether m equals the identity up to a global phase, within `tolerance`.
+    // The distance compared is sqrt(max(0, 1 - |tr m| / 2)), which is linear
+    // in the rotation angle; it equals half the Frobenius distance from m to
+    // the nearest phase times I, computed that way so that roundoff in the
+    // trace does not keep exact identities alive.
+    inline bool is_identity_up_to_phase(const Matrix2& m, double tolerance) {
+        Complex trace = m.a + m.d;
+        if (std::abs(trace) < 1.0) {
+            return false;
+        }
+        Complex phase = trace / std::abs(trace);
+        double distance = std::norm(m.a - phase) + std::norm(m.b) + std::norm(m.c) + std::norm(m.d - phase);
+        return std::sqrt(distance) / 2 < tolerance;
+    }
+
+    // Angles with U(theta, phi, lambda) equal to m up to a global phase
+    inline EulerAngles zyz_angles(const Matrix2& m) {
+        const double eps = 1e-12;
+        double theta = 2 * std::atan2(std::abs(m.c), std::abs(m.a));
+        if (std::abs(m.c) < eps) {
+            return {0.0, 0.0, std::arg(m.d) - std::arg(m.a)};
+        }
+        if (std::abs(m.a) < eps) {
+            return {theta, std::arg(m.c) - std::arg(-m.b), 0.0};
+        }
+        return {theta, std::arg(m.c) - std::arg(m.a), std::arg(-m.b) - std::arg(m.a)};
+    }
+
+}; // namespace qarser
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+
+namespace qarser {
+
+    /**
+     * @brief Operation codes of the circuit IR.
+     *
+     * Builtins and every qelib1 gate have their own code so passes can
+     * switch on it; gates the program defines itself use GATE and refer to
+     * the circuit's gate table. The qelib1 aliases of the builtins (u3, u
+     * and cx) lower to U and CX.
+     */
+    enum class OpCode : uint8_t {
+        // Builtins
+        U, CX,
+
+        // qelib1.inc
+        U2, U1, ID, U0, P,
+        X, Y, Z, H, S, SDG, T, TDG,
+        RX, RY, RZ, SX, SXDG,
+        CZ, CY, SWAP, CH, CCX, CSWAP,
+        CRX, CRY, CRZ, CU1, CP, CU3, CSX, CU,
+        RXX, RZZ, RCCX, RC3X, C3X, C3SQRTX, C4X,
+
+        // Program defined gate, see Circuit::get_gate
+        GATE,
+
+        // Non-unitary
+        MEASURE,
+        RESET,
+        BARRIER,
+    };
+
+
+    struct OpInfo {
+        const char* name;
+        uint8_t num_params;
+        uint8_t num_qubits;     // 0 for operations with a variable qubit count
+    };
+
+    inline const OpInfo& op_info(OpCode code) {
+        static constexpr OpInfo table[] = {
+            {"U", 3, 1}, {"CX", 0, 2},
+
+            {"u2", 2, 1}, {"u1", 1, 1}, {"id", 0, 1}, {"u0", 1, 1}, {"p", 1, 1},
+            {"x", 0, 1}, {"y", 0, 1}, {"z", 0, 1}, {"h", 0, 1},
+            {"s", 0, 1}, {"sdg", 0, 1}, {"t", 0, 1}, {"tdg", 0, 1},
+            {"rx", 1, 1}, {"ry", 1, 1}, {"rz", 1, 1}, {"sx", 0, 1}, {"sxdg", 0, 1},
+            {"cz", 0, 2}, {"cy", 0, 2}, {"swap", 0, 2}, {"ch", 0, 2},
+            {"ccx", 0, 3}, {"cswap", 0, 3},
+            {"crx", 1, 2}, {"cry", 1, 2}, {"crz", 1, 2}, {"cu1", 1, 2}, {"cp", 1, 2},
+            {"cu3", 3, 2}, {"csx", 0, 2}, {"cu", 4, 2},
+            {"rxx", 1, 2}, {"rzz", 1, 2}, {"rccx", 0, 3}, {"rc3x", 0, 4},
+            {"c3x", 0, 4}, {"c3sqrtx", 0, 4}, {"c4x", 0, 5},
+
+            {"gate", 0, 0},
+
+            {"measure", 0, 1},
+            {"reset", 0, 1},
+            {"barrier", 0, 0},
+        };
+        static_assert(sizeof(table) / sizeof(table[0]) == static_cast<size_t>(OpCode::BARRIER) + 1);
+        return table[static_cast<size_t>(code)];
+    }
+
+    inline bool is_unitary(OpCode code) {
+        return code < OpCode::MEASURE;
+    }
+
+    // Code of a builtin or qelib1 gate name, std::nullopt for anything else
+    inline std::optional<OpCode> opcode_from_name(std::string_view name) {
+        if (name == "u3" || name == "u") return OpCode::U;
+        if (name == "cx") return OpCode::CX;
+        for (size_t i = 0; i < static_cast<size_t>(OpCode::GATE); ++i) {
+            OpCode code = static_cast<OpCode>(i);
+            if (name == op_info(code).name) {
+                return code;
+            }
+        }
+        return std::nullopt;
+    }
+
+}; // namespace qarser
@@ -0,0 +1,363 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iomanip>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "circuit.hpp"
+#include "dag.hpp"
+#include "layering.hpp"
+#include "passes/vf2_layout.hpp"
+
+
+namespace qarser {
+
+    enum class Analysis : uint8_t {
+        DAG,            // DependencyDag
+        LAYERS,         // Layers, computed from the DAG
+        INTERACTIONS,   // InteractionGraph of the two-qubit gates
+        WIRE_USAGE,     // WireUsage
+    };
+
+
+    class AnalysisSet {
+    private:
+        uint32_t bits = 0;
+
+        explicit AnalysisSet(uint32_t bits) : bits(bits) {}
+
+    public:
+        AnalysisSet() = default;
+
+        AnalysisSet(std::initializer_list<Analysis> analyses) {
+            for (Analysis analysis : analyses) {
+                bits |= 1u << static_cast<uint32_t>(analysis);
+            }
+        }
+
+        static AnalysisSet all() {
+            return AnalysisSet(~0u);
+        }
+
+        bool contains(Analysis analysis) const {
+            return bits & (1u << static_cast<uint32_t>(analysis));
+        }
+    };
+
+
+    // Operations on each qubit, barriers aside
+    struct WireUsage {
+        std::vector<uint32_t> operations;
+        uint32_t active = 0;        // qubits with at least one operation
+
+        explicit WireUsage(const Circuit& circuit)
+            : operations(circuit.get_num_qubits(), 0) {
+            for (const auto& op : circuit.get_operations()) {
+                if (op.code == OpCode::BARRIER) {
+                    continue;
+                }
+                for (uint32_t q : circuit.qubits(op)) {
+                    active += operations[q]++ == 0;
+                }
+            }
+        }
+    };
+
+
+    /**
+     * @brief Analyses of one circuit, computed on first request and kept until invalidated.
+     *
+     * The cache does not watch the circuit: whoever changes it must call
+     * `invalidate` with what the change preserved. Layers are derived from
+     * the DAG, so they never outlive it.
+     */
+    class AnalysisCache {
+    public:
+        struct Counters {
+            uint32_t computed = 0;
+            uint32_t reused = 0;        // required while still cached
+            double milliseconds = 0;    // spent computing
+        };
+
+    private:
+        std::unique_ptr<DependencyDag> dag;
+        std::unique_ptr<Layers> layers;
+        std::unique_ptr<InteractionGraph> interactions;
+        std::unique_ptr<WireUsage> usage;
+        GateDurations durations;
+        Counters counters;
+
+    public:
+        const DependencyDag& get_dag(const Circuit& circuit) {
+            return get(dag, [&] { return std::make_unique<DependencyDag>(circuit); });
+        }
+
+        const Layers& get_layers(const Circuit& circuit) {
+            if (layers) {
+                return *layers;
+            }
+            const DependencyDag& graph = get_dag(circuit);
+            return get(layers, [&] { return std::make_unique<Layers>(Layering(circuit, durations).compute(graph)); });
+        }
+
+        const InteractionGraph& get_interactions(const Circuit& circuit) {
+            return get(interactions, [&] { return std::make_unique<InteractionGraph>(circuit); });
+        }
+
+        const WireUsage& get_usage(const Circuit& circuit) {
+            return get(usage, [&] { return std::make_unique<WireUsage>(circuit); });
+        }
+
+        // Computes every analysis in `analyses` that is not cached yet
+        void require(const Circuit& circuit, AnalysisSet analyses) {
+            for (Analysis analysis : {Analysis::DAG, Analysis::LAYERS, Analysis::INTERACTIONS, Analysis::WIRE_USAGE}) {
+                if (analyses.contains(analysis) && is_cached(analysis)) {
+                    ++counters.reused;
+                }
+            }
+            if (analyses.contains(Analysis::DAG)) get_dag(circuit);
+            if (analyses.contains(Analysis::LAYERS)) get_layers(circuit);
+            if (analyses.contains(Analysis::INTERACTIONS)) get_interactions(circuit);
+            if (analyses.contains(Analysis::WIRE_USAGE)) get_usage(circuit);
+        }
+
+        bool is_cached(Analysis analysis) const {
+            switch (analysis) {
+                case Analysis::DAG: return dag != nullptr;
+                case Analysis::LAYERS: return layers != nullptr;
+                case Analysis::INTERACTIONS: return interactions != nullptr;
+                case Analysis::WIRE_USAGE: return usage != nullptr;
+            }
+            return false;
+        }
+
+        // Drops every analysis not in `preserved`
+        void invalidate(AnalysisSet preserved = {}) {
+            if (!preserved.contains(Analysis::DAG)) dag.reset();
+            if (!preserved.contains(Analysis::LAYERS) || !dag) layers.reset();
+            if (!preserved.contains(Analysis::INTERACTIONS)) interactions.reset();
+            if (!preserved.contains(Analysis::WIRE_USAGE)) usage.reset();
+        }
+
+        void set_durations(GateDurations value) {
+            durations = std::move(value);
+            layers.reset();
+        }
+
+        const Counters& get_counters() const {
+            return counters;
+        }
+
+        // Heap memory held by the cached analyses
+        size_t memory_bytes() const {
+            size_t bytes = 0;
+            if (dag) bytes += dag->memory_bytes();
+            if (layers) {
+                bytes += (layers->asap.capacity() + layers->alap.capacity() +
+                          layers->layer_starts.capacity()) * sizeof(uint64_t) +
+                         (layers->critical_pred.capacity() + layers->critical_path.capacity() +
+                          layers->parallelism.capacity()) * sizeof(uint32_t);
+            }
+            if (interactions) bytes += interactions->memory_bytes();
+            if (usage) bytes += usage->operations.capacity() * sizeof(uint32_t);
+            return bytes;
+        }
+
+    private:
+        template <typename T, typename Compute>
+        const T& get(std::unique_ptr<T>& slot, Compute&& compute) {
+            if (slot) {
+                return *slot;
+            }
+            auto start = std::chrono::steady_clock::now();
+            slot = compute();
+            auto end = std::chrono::steady_clock::now();
+            ++counters.computed;
+            counters.milliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+            return *slot;
+        }
+    };
+
+
+    /**
+     * @brief One step of a PassManager pipeline.
+     *
+     * `required` analyses are computed before the pass runs and fetched by
+     * it from the cache. `run` returns whether it changed the circuit; when
+     * it did, only the `preserved` analyses stay cached.
+     */
+    class CircuitPass {
+    public:
+        virtual ~CircuitPass() = default;
+
+        virtual std::string name() const = 0;
+
+        virtual AnalysisSet required() const {
+            return {};
+        }
+
+        virtual AnalysisSet preserved() const {
+            return {};
+        }
+
+        virtual bool run(Circuit& circuit, AnalysisCache& analyses) = 0;
+    };
+
+
+    // A pass given by a function and its declarations
+    class FunctionPass : public CircuitPass {
+    public:
+        using Function = std::function<bool(Circuit&, AnalysisCache&)>;
+
+    private:
+        std::string pass_name;
+        AnalysisSet needs;
+        AnalysisSet keeps;
+        Function function;
+
+    public:
+        FunctionPass(std::string name, AnalysisSet required, AnalysisSet preserved, Function function)
+            : pass_name(std::move(name)), needs(required), keeps(preserved), function(std::move(function)) {}
+
+        std::string name() const override {
+            return pass_name;
+        }
+
+        AnalysisSet required() const override {
+            return needs;
+        }
+
+        AnalysisSet preserved() const override {
+            return keeps;
+        }
+
+        bool run(Circuit& circuit, AnalysisCache& analyses) override {
+            return function(circuit, analyses);
+        }
+    };
+
+
+    struct PassRecord {
+        std::string name;
+        double milliseconds = 0;            // the pass itself
+        double analysis_milliseconds = 0;   // analyses computed for it
+        uint32_t analyses_computed = 0;
+        uint32_t analyses_reused = 0;
+        bool changed = false;
+        size_t operations_before = 0;
+        size_t operations_after = 0;
+        size_t circuit_bytes = 0;           // after the pass
+        size_t analysis_bytes = 0;          // cached after the pass
+        std::optional<long> peak_growth_kb; // growth of the process's peak resident size, if probed
+    };
+
+
+    /**
+     * @brief Runs passes over a circuit, sharing analyses between them.
+     *
+     * Analyses live in one AnalysisCache for the whole pipeline. A pass
+     * that reports no change keeps all of them; one that changed the
+     * circuit keeps only those it declares preserved. Every run is
+     * recorded with its wall time, split between the pass and the
+     * analyses computed for it, the memory held by the circuit and the
+     * cache afterwards, and how much the process's peak resident size
+     * grew during it, which is zero when the pass stayed below an
+     * earlier peak. Reading the peak is platform specific, so it only
+     * happens through a probe set with `set_peak_probe`; without one the
+     * growth is reported as n/a.
+     */
+    class PassManager {
+    public:
+        using PeakProbe = std::function<long()>;       // peak resident size of the process in KB
+
+    private:
+        std::vector<std::unique_ptr<CircuitPass>> passes;
+        AnalysisCache analyses;
+        std::vector<PassRecord> records;
+        PeakProbe peak_probe;
+
+    public:
+        PassManager& add(std::unique_ptr<CircuitPass> pass) {
+            passes.push_back(std::move(pass));
+            return *this;
+        }
+
+        PassManager& add(std::string name, AnalysisSet required, AnalysisSet preserved,
+                         FunctionPass::Function function) {
+            return add(std::make_unique<FunctionPass>(std::move(name), required, preserved, std::move(function)));
+        }
+
+        PassManager& set_peak_probe(PeakProbe probe) {
+            peak_probe = std::move(probe);
+            return *this;
+        }
+
+        void run(Circuit& circuit) {
+            analyses.invalidate();
+            for (const auto& pass : passes) {
+                PassRecord record;
+                record.name = pass->name();
+                record.operations_before = circuit.size();
+                AnalysisCache::Counters before = analyses.get_counters();
+                long peak_before = peak_probe ? peak_probe() : 0;
+
+                auto start = std::chrono::steady_clock::now();
+                analyses.require(circuit, pass->required());
+                record.changed = pass->run(circuit, analyses);
+                auto end = std::chrono::steady_clock::now();
+                if (record.changed) {
+                    analyses.invalidate(pass->preserved());
+                }
+
+                const AnalysisCache::Counters& after = analyses.get_counters();
+                record.analysis_milliseconds = after.milliseconds - before.milliseconds;
+                record.milliseconds = std::chrono::duration<double, std::milli>(end - start).count() -
+                                      record.analysis_milliseconds;
+                record.analyses_computed = after.computed - before.computed;
+                record.analyses_reused = after.reused - before.reused;
+                record.operations_after = circuit.size();
+                record.circuit_bytes = circuit.memory_bytes();
+                record.analysis_bytes = analyses.memory_bytes();
+                if (peak_probe) {
+                    record.peak_growth_kb = peak_probe() - peak_before;
+                }
+                records.push_back(std::move(record));
+            }
+        }
+
+        AnalysisCache& get_analyses() {
+            return analyses;
+        }
+
+        const std::vector<PassRecord>& get_records() const {
+            return records;
+        }
+
+        void print(std::ostream& out) const {
+            std::ios_base::fmtflags flags = out.flags();
+            std::streamsize precision = out.precision();
+            out << std::left << std::setw(24) << "pass" << std::right << std::setw(10) << "ms"
+                << std::setw(12) << "analysis ms" << std::setw(10) << "computed" << std::setw(8) << "reused"
+                << std::setw(12) << "operations" << std::setw(12) << "circuit KB" << std::setw(13) << "analyses KB"
+                << std::setw(10) << "peak +KB" << "\n";
+            out << std::fixed << std::setprecision(2);
+            for (const auto& record : records) {
+                out << std::left << std::setw(24) << record.name << std::right
+                    << std::setw(10) << record.milliseconds << std::setw(12) << record.analysis_milliseconds
+                    << std::setw(10) << record.analyses_computed << std::setw(8) << record.analyses_reused
+                    << std::setw(12) << record.operations_after << std::setw(12) << record.circuit_bytes / 1024
+                    << std::setw(13) << record.analysis_bytes / 1024 << std::setw(10)
+                    << (record.peak_growth_kb ? std::to_string(*record.peak_growth_kb) : "n/a") << "\n";
+            }
+            out.flags(flags);
+            out.precision(precision);
+        }
+    };
+
+}; // namespace qarser
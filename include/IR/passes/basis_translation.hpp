@@ -0,0 +1,229 @@
+#pragma once
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "IR/inliner.hpp"
+#include "IR/equivalence_library.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Rewrites a Circuit into a native gate set such as {rz, sx, x, cx}.
+     *
+     * On construction every builtin and qelib1 gate gets the decomposition
+     * with the fewest basis operations the equivalence library allows. The
+     * search is Dijkstra over rules: a rule becomes usable once every gate
+     * its body calls has a final cost, and then offers its target the sum
+     * of those costs. Winning rules are composed bottom-up into one
+     * ExpansionTemplate per gate, and program-defined gates are composed
+     * from their bodies on first use. Each gate is therefore expanded once
+     * per basis, and translating a call site is one table lookup plus a
+     * template copy.
+     *
+     * Gates already in the basis and non-unitary operations are copied.
+     */
+    class BasisTranslator {
+    private:
+        static constexpr size_t NUM_GATES = static_cast<size_t>(OpCode::GATE);
+        static constexpr uint32_t UNREACHABLE = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t NO_RULE = std::numeric_limits<uint32_t>::max();
+
+        const EquivalenceLibrary& library;
+        std::vector<bool> in_basis;
+        std::vector<uint32_t> costs;                // basis operations per gate
+        std::vector<ExpansionTemplate> by_opcode;
+
+        std::unordered_map<std::string, const GateDef*> definitions;
+        std::unordered_map<const GateDef*, ExpansionTemplate> by_definition;
+        std::unordered_set<const GateDef*> in_progress;
+        std::vector<const ExpansionTemplate*> by_gate;
+        ExpansionTemplate::Workspace workspace;
+
+    public:
+        explicit BasisTranslator(const std::vector<OpCode>& basis,
+                                 const EquivalenceLibrary& library = EquivalenceLibrary::standard())
+            : library(library), in_basis(NUM_GATES, false), costs(NUM_GATES, UNREACHABLE), by_opcode(NUM_GATES) {
+            for (OpCode code : basis) {
+                if (!is_unitary(code) || code == OpCode::GATE) {
+                    throw std::invalid_argument(std::string("Gate '") + op_info(code).name + "' cannot be in a basis");
+                }
+                in_basis[static_cast<size_t>(code)] = true;
+            }
+            search();
+        }
+
+        // Whether the gate can be expressed in the basis
+        bool supports(OpCode code) const {
+            return costs[static_cast<size_t>(code)] != UNREACHABLE;
+        }
+
+        // Basis operations per occurrence of the gate
+        uint32_t cost(OpCode code) const {
+            return costs[static_cast<size_t>(code)];
+        }
+
+        const ExpansionTemplate& translation(OpCode code) const {
+            if (!supports(code)) {
+                throw std::runtime_error(std::string("Cannot translate gate '") + op_info(code).name +
+                                         "' to the target basis");
+            }
+            return by_opcode[static_cast<size_t>(code)];
+        }
+
+        Circuit translate(const Circuit& circuit) {
+            for (const auto& gate : circuit.get_gates()) {
+                if (gate.definition) {
+                    definitions.emplace(gate.name, gate.definition);
+                }
+            }
+            by_gate.assign(circuit.get_gates().size(), nullptr);
+
+            // Size the output exactly so instantiation never reallocates
+            size_t num_ops = 0, num_qubits = 0, num_params = 0;
+            for (const auto& op : circuit.get_operations()) {
+                const ExpansionTemplate* expansion = expansion_of(circuit, op);
+                if (!expansion) {
+                    num_ops += 1;
+                    num_qubits += op.num_qubits;
+                    num_params += op.num_params;
+                    continue;
+                }
+                num_ops += expansion->ops.size();
+                num_qubits += expansion->qubit_slots.size();
+                num_params += expansion->params.size();
+            }
+            Circuit result = circuit.without_operations();
+            result.reserve(num_ops, num_qubits, num_params);
+
+            for (const auto& op : circuit.get_operations()) {
+                const ExpansionTemplate* expansion = expansion_of(circuit, op);
+                if (!expansion) {
+                    result.append(circuit, op);
+                    continue;
+                }
+                expansion->instantiate(circuit.qubits(op), circuit.params(op), result, workspace);
+            }
+            return result;
+        }
+
+        // Translation of a program-defined gate, composed on first use
+        const ExpansionTemplate& translate(const GateDef& def) {
+            auto it = by_definition.find(&def);
+            if (it != by_definition.end()) {
+                return it->second;
+            }
+            if (!in_progress.insert(&def).second) {
+                throw std::runtime_error("Recursive gate definition '" + def.name + "'");
+            }
+
+            auto resolve = [&](const Gate& call) -> const ExpansionTemplate& {
+                auto callee = definitions.find(call.name);
+                if (callee != definitions.end()) {
+                    return translate(*callee->second);
+                }
+                auto code = opcode_from_name(call.name);
+                if (!code) {
+                    throw std::runtime_error("Cannot translate undeclared gate '" + call.name + "'");
+                }
+                return translation(*code);
+            };
+            ExpansionTemplate expansion = ExpansionTemplate::compose(def, resolve);
+
+            in_progress.erase(&def);
+            return by_definition.emplace(&def, std::move(expansion)).first->second;
+        }
+
+    private:
+        /**
+         * @brief Cheapest decomposition of every gate into the basis.
+         *
+         * Gates are finalized in increasing cost, so the rule chosen for a
+         * gate only calls gates finalized before it and the templates can
+         * be composed in finalization order.
+         */
+        void search() {
+            const auto& rules = library.get_rules();
+            std::vector<uint32_t> waiting(rules.size());     // calls without a final cost
+            std::vector<std::vector<uint32_t>> callers(NUM_GATES);
+
+            using Candidate = std::tuple<uint32_t, uint32_t, uint32_t>;    // cost, gate, rule
+            std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+            for (uint32_t r = 0; r < rules.size(); ++r) {
+                waiting[r] = static_cast<uint32_t>(rules[r].calls.size());
+                for (OpCode call : rules[r].calls) {
+                    callers[static_cast<size_t>(call)].push_back(r);
+                }
+                if (rules[r].calls.empty()) {
+                    queue.emplace(0, static_cast<uint32_t>(rules[r].target), r);
+                }
+            }
+            for (uint32_t gate = 0; gate < NUM_GATES; ++gate) {
+                if (in_basis[gate]) {
+                    queue.emplace(1, gate, NO_RULE);
+                }
+            }
+
+            while (!queue.empty()) {
+                auto [cost, gate, rule] = queue.top();
+                queue.pop();
+                if (costs[gate] != UNREACHABLE) {
+                    continue;
+                }
+                costs[gate] = cost;
+                build_template(static_cast<OpCode>(gate), rule);
+
+                for (uint32_t r : callers[gate]) {
+                    if (--waiting[r] > 0) {
+                        continue;
+                    }
+                    uint32_t total = 0;
+                    for (OpCode call : rules[r].calls) {
+                        total += costs[static_cast<size_t>(call)];
+                    }
+                    queue.emplace(total, static_cast<uint32_t>(rules[r].target), r);
+                }
+            }
+        }
+
+        void build_template(OpCode code, uint32_t rule) {
+            const OpInfo& info = op_info(code);
+            ExpansionTemplate& expansion = by_opcode[static_cast<size_t>(code)];
+            if (rule == NO_RULE) {
+                expansion = ExpansionTemplate::single(code, info.num_qubits, info.num_params);
+                return;
+            }
+            auto resolve = [&](const Gate& call) -> const ExpansionTemplate& {
+                return by_opcode[static_cast<size_t>(*opcode_from_name(call.name))];
+            };
+            expansion = ExpansionTemplate::compose(*library.get_rules()[rule].definition, resolve);
+        }
+
+        // Template for an operation, nullptr if it is copied as is
+        const ExpansionTemplate* expansion_of(const Circuit& circuit, const Operation& op) {
+            if (op.code == OpCode::GATE) {
+                const ExpansionTemplate*& cached = by_gate[op.gate];
+                if (!cached) {
+                    const auto& gate = circuit.get_gate(op.gate);
+                    if (!gate.definition) {
+                        throw std::runtime_error("Cannot translate opaque gate '" + gate.name + "'");
+                    }
+                    cached = &translate(*gate.definition);
+                }
+                return cached;
+            }
+            if (!is_unitary(op.code) || in_basis[static_cast<size_t>(op.code)]) {
+                return nullptr;
+            }
+            return &translation(op.code);
+        }
+    };
+
+}; // namespace qarser
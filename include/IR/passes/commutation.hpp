@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "IR/circuit.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief How an operation acts on one of its qubits.
+     *
+     * Two operations commute when, on every qubit they share, both are
+     * Z-type (diagonal in the computational basis) or both are X-type
+     * (diagonal in the Hadamard basis).
+     */
+    enum class WireAction : uint8_t {
+        Z,
+        X,
+        OTHER,
+    };
+
+    // Action of `code` on its qubit operand `k`
+    inline WireAction wire_action(OpCode code, uint32_t k) {
+        switch (code) {
+            case OpCode::ID:
+            case OpCode::Z: case OpCode::S: case OpCode::SDG: case OpCode::T: case OpCode::TDG:
+            case OpCode::RZ: case OpCode::U1: case OpCode::P:
+            case OpCode::CZ: case OpCode::CU1: case OpCode::CP: case OpCode::CRZ: case OpCode::RZZ:
+                return WireAction::Z;
+
+            case OpCode::X: case OpCode::SX: case OpCode::SXDG: case OpCode::RX: case OpCode::RXX:
+                return WireAction::X;
+
+            // Controls are diagonal, X-like targets are diagonal in the Hadamard basis
+            case OpCode::CX: case OpCode::CRX: case OpCode::CSX:
+                return k == 0 ? WireAction::Z : WireAction::X;
+            case OpCode::CCX:
+                return k < 2 ? WireAction::Z : WireAction::X;
+            case OpCode::C3X:
+                return k < 3 ? WireAction::Z : WireAction::X;
+            case OpCode::C4X:
+                return k < 4 ? WireAction::Z : WireAction::X;
+            case OpCode::CY: case OpCode::CH: case OpCode::CRY:
+            case OpCode::CU3: case OpCode::CU: case OpCode::CSWAP:
+                return k == 0 ? WireAction::Z : WireAction::OTHER;
+
+            default:
+                return WireAction::OTHER;
+        }
+    }
+
+}; // namespace qarser
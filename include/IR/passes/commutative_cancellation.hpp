@@ -0,0 +1,204 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "commutation.hpp"
+#include "peephole.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Cancels and merges gates that become adjacent after commuting.
+     *
+     * Every qubit remembers the last operation that is not Z-type and the
+     * last that is not X-type on it. An operation v commutes with everything
+     * on a wire after the blocker for its own action there, so an earlier
+     * gate u is a valid partner when it lies after the blockers on all of
+     * v's qubits: v can then be moved back next to u. Partners are looked up
+     * among the last `window` live operations on v's first qubit, which
+     * keeps each sweep linear. Partners are found with the PeepholeRules
+     * inverse and merge rules; sweeps repeat until one removes nothing.
+     */
+    class CommutativeCancellation {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        static constexpr double TOLERANCE = 1e-9;
+
+        PeepholeRules rules;
+        uint32_t window;
+
+        std::vector<uint32_t> recent;       // qubit * window + slot -> operation, ring buffer
+        std::vector<uint32_t> recent_count;
+        std::vector<uint32_t> not_z;        // qubit -> last operation that is not Z-type on it
+        std::vector<uint32_t> not_x;
+        std::vector<uint8_t> removed;
+
+    public:
+        explicit CommutativeCancellation(uint32_t window = 32, PeepholeRules rules = PeepholeRules::standard())
+            : rules(std::move(rules)), window(std::max<uint32_t>(window, 1)) {}
+
+        PeepholeRules& get_rules() {
+            return rules;
+        }
+
+        // Runs sweeps to a fixed point and returns the number of removed operations
+        size_t run(Circuit& circuit) {
+            size_t total = 0;
+            while (size_t count = sweep(circuit)) {
+                total += count;
+            }
+            return total;
+        }
+
+        size_t sweep(Circuit& circuit) {
+            size_t n = circuit.size();
+            uint32_t num_qubits = circuit.get_num_qubits();
+            recent.assign(size_t(num_qubits) * window, NONE);
+            recent_count.assign(num_qubits, 0);
+            not_z.assign(num_qubits, NONE);
+            not_x.assign(num_qubits, NONE);
+            removed.assign(n, 0);
+
+            size_t count = 0;
+            for (uint32_t v = 0; v < n; ++v) {
+                const Operation& op = circuit[v];
+                const PeepholeRules::Rule* rule = rules.find(OpKey::of(op));
+
+                if (rule && rule->param != PeepholeRules::NO_PARAM && rule->param < op.num_params &&
+                    is_identity(circuit.params(op)[rule->param], rule->period)) {
+                    removed[v] = 1;
+                    ++count;
+                    continue;
+                }
+
+                uint32_t u = partner(circuit, v);
+                if (u != NONE) {
+                    const Operation& prev = circuit[u];
+                    const PeepholeRules::Rule* prev_rule = rules.find(OpKey::of(prev));
+                    removed[v] = 1;
+                    ++count;
+                    if (prev_rule->has_inverse && prev_rule->inverse == OpKey::of(op).value()) {
+                        removed[u] = 1;
+                        ++count;
+                        continue;
+                    }
+                    double& angle = circuit.params(prev)[prev_rule->param];
+                    angle += circuit.params(op)[prev_rule->param];
+                    if (is_identity(angle, prev_rule->period)) {
+                        removed[u] = 1;
+                        ++count;
+                    }
+                    continue;
+                }
+                push(circuit, v);
+            }
+
+            if (count > 0) {
+                size_t i = 0;
+                circuit.erase_if([&](const Operation&) { return removed[i++] != 0; });
+            }
+            return count;
+        }
+
+    private:
+        // Earlier live operation v can be moved next to and cancel or merge with, or NONE
+        uint32_t partner(const Circuit& circuit, uint32_t v) const {
+            const Operation& op = circuit[v];
+            if (op.num_qubits == 0 || op.num_clbits != 0 || !is_unitary(op.code)) {
+                return NONE;
+            }
+            auto qubits = circuit.qubits(op);
+            uint32_t limit = 0;     // partners must come after every blocker
+            bool blocked = false;
+            for (uint32_t k = 0; k < op.num_qubits; ++k) {
+                uint32_t blocker = blocker_for(op.code, k, qubits[k]);
+                if (blocker != NONE) {
+                    limit = blocked ? std::max(limit, blocker) : blocker;
+                    blocked = true;
+                }
+            }
+
+            uint32_t q = qubits[0];
+            uint32_t size = std::min(recent_count[q], window);
+            for (uint32_t i = 0; i < size; ++i) {
+                uint32_t u = recent[size_t(q) * window + (recent_count[q] - 1 - i) % window];
+                if (blocked && u <= limit) {
+                    break;
+                }
+                if (!removed[u] && matches(circuit, circuit[u], op)) {
+                    return u;
+                }
+            }
+            return NONE;
+        }
+
+        uint32_t blocker_for(OpCode code, uint32_t k, uint32_t qubit) const {
+            switch (wire_action(code, k)) {
+                case WireAction::Z: return not_z[qubit];
+                case WireAction::X: return not_x[qubit];
+                default: return before_last_live(qubit);
+            }
+        }
+
+        // Only the last live operation on the wire is reachable without commuting
+        uint32_t before_last_live(uint32_t qubit) const {
+            uint32_t size = std::min(recent_count[qubit], window);
+            for (uint32_t i = 0; i < size; ++i) {
+                uint32_t u = recent[size_t(qubit) * window + (recent_count[qubit] - 1 - i) % window];
+                if (!removed[u]) {
+                    return u == 0 ? NONE : u - 1;
+                }
+            }
+            return recent_count[qubit] ? recent[size_t(qubit) * window + (recent_count[qubit] - 1) % window] : NONE;
+        }
+
+        bool matches(const Circuit& circuit, const Operation& prev, const Operation& op) const {
+            if (prev.num_qubits != op.num_qubits || prev.num_clbits != 0) {
+                return false;
+            }
+            auto a = circuit.qubits(prev);
+            auto b = circuit.qubits(op);
+            for (uint32_t k = 0; k < op.num_qubits; ++k) {
+                if (a[k] != b[k]) return false;
+            }
+            const PeepholeRules::Rule* rule = rules.find(OpKey::of(prev));
+            if (!rule) {
+                return false;
+            }
+            if (rule->has_inverse && rule->inverse == OpKey::of(op).value()) {
+                return prev.num_params == 0 && op.num_params == 0;
+            }
+            if (rule->param == PeepholeRules::NO_PARAM || OpKey::of(prev).value() != OpKey::of(op).value() ||
+                prev.num_params != op.num_params || rule->param >= op.num_params) {
+                return false;
+            }
+            auto pa = circuit.params(prev);
+            auto pb = circuit.params(op);
+            for (uint32_t i = 0; i < op.num_params; ++i) {
+                if (i != rule->param && pa[i] != pb[i]) return false;
+            }
+            return true;
+        }
+
+        void push(const Circuit& circuit, uint32_t v) {
+            const Operation& op = circuit[v];
+            auto qubits = circuit.qubits(op);
+            for (uint32_t k = 0; k < op.num_qubits; ++k) {
+                uint32_t q = qubits[k];
+                recent[size_t(q) * window + recent_count[q] % window] = v;
+                ++recent_count[q];
+                WireAction action = is_unitary(op.code) ? wire_action(op.code, k) : WireAction::OTHER;
+                if (action != WireAction::Z) not_z[q] = v;
+                if (action != WireAction::X) not_x[q] = v;
+            }
+        }
+
+        static bool is_identity(double angle, double period) {
+            double rest = std::fmod(std::abs(angle), period);
+            return rest < TOLERANCE || period - rest < TOLERANCE;
+        }
+    };
+
+}; // namespace qarser
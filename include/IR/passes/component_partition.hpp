@@ -0,0 +1,266 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "utils/disjoint_sets.hpp"
+
+
+namespace qarser {
+
+    struct CircuitComponent {
+        Circuit circuit;                // compacted, registers keep their names
+        std::vector<uint32_t> qubits;   // local qubit -> original qubit
+        std::vector<uint32_t> clbits;   // local bit -> original bit
+    };
+
+
+    /**
+     * @brief Independent parts of a circuit and the way back to the whole.
+     *
+     * `recombine` maps circuits produced from the components, which must
+     * keep their qubit and bit counts, back onto the original registers,
+     * one component after the other; gates they define are matched by
+     * name. `combine_clbits` does the same for measured bit values.
+     */
+    class ComponentPartition {
+    private:
+        Circuit layout;                 // original registers and gates, no operations
+
+    public:
+        std::vector<CircuitComponent> components;
+        std::vector<uint32_t> idle_qubits;      // touched by nothing but barriers
+
+        explicit ComponentPartition(Circuit layout = {})
+            : layout(std::move(layout)) {}
+
+        Circuit recombine(const std::vector<Circuit>& circuits) const {
+            if (circuits.size() != components.size()) {
+                throw std::invalid_argument("Expected " + std::to_string(components.size()) +
+                                            " component circuits, got " + std::to_string(circuits.size()));
+            }
+            Circuit result = layout;
+            std::unordered_map<std::string, uint32_t> gate_ids;
+            for (uint32_t g = 0; g < result.get_gates().size(); ++g) {
+                gate_ids.emplace(result.get_gate(g).name, g);
+            }
+            size_t num_ops = 0, num_qubits = 0, num_params = 0;
+            for (size_t i = 0; i < circuits.size(); ++i) {
+                const Circuit& part = circuits[i];
+                if (part.get_num_qubits() != components[i].qubits.size() ||
+                    part.get_num_clbits() != components[i].clbits.size()) {
+                    throw std::invalid_argument("Component " + std::to_string(i) + " changed its width");
+                }
+                for (const auto& op : part.get_operations()) {
+                    num_qubits += op.num_qubits;
+                    num_params += op.num_params;
+                }
+                num_ops += part.size();
+            }
+            result.reserve(num_ops, num_qubits, num_params);
+
+            std::vector<uint32_t> gates, qubits, clbits;
+            for (size_t i = 0; i < circuits.size(); ++i) {
+                const Circuit& part = circuits[i];
+                const CircuitComponent& component = components[i];
+                gates.clear();
+                for (const auto& gate : part.get_gates()) {
+                    auto it = gate_ids.find(gate.name);
+                    if (it == gate_ids.end()) {
+                        uint32_t id = result.add_gate(gate.name, gate.num_params, gate.num_qubits, gate.definition);
+                        it = gate_ids.emplace(gate.name, id).first;
+                    }
+                    gates.push_back(it->second);
+                }
+                for (const auto& op : part.get_operations()) {
+                    qubits.clear();
+                    clbits.clear();
+                    for (uint32_t q : part.qubits(op)) {
+                        qubits.push_back(component.qubits[q]);
+                    }
+                    for (uint32_t c : part.clbits(op)) {
+                        clbits.push_back(component.clbits[c]);
+                    }
+                    auto params = part.params(op);
+                    result.add(op.code, qubits.data(), qubits.size(), params.data, params.size(),
+                               clbits.data(), clbits.size(), op.code == OpCode::GATE ? gates[op.gate] : 0);
+                }
+            }
+            return result;
+        }
+
+        // Values of the original bits from those of each component; unmeasured bits stay false
+        std::vector<bool> combine_clbits(const std::vector<std::vector<bool>>& values) const {
+            if (values.size() != components.size()) {
+                throw std::invalid_argument("Expected bit values of " + std::to_string(components.size()) +
+                                            " components, got " + std::to_string(values.size()));
+            }
+            std::vector<bool> result(layout.get_num_clbits(), false);
+            for (size_t i = 0; i < values.size(); ++i) {
+                const auto& clbits = components[i].clbits;
+                if (values[i].size() != clbits.size()) {
+                    throw std::invalid_argument("Component " + std::to_string(i) + " has " +
+                                                std::to_string(clbits.size()) + " bits");
+                }
+                for (size_t c = 0; c < clbits.size(); ++c) {
+                    result[clbits[c]] = values[i][c];
+                }
+            }
+            return result;
+        }
+    };
+
+
+    /**
+     * @brief Splits a circuit into parts that share no qubit or bit.
+     *
+     * Union-find over qubits and bits joins the operands of every
+     * operation, so a multi-qubit gate merges its qubits and a measurement
+     * merges its qubit with its bit. Barriers join nothing; each component
+     * gets the part of a barrier on its own qubits. Components are
+     * numbered by their lowest qubit, keep their qubits and bits in the
+     * original order and carry the whole gate table. Qubits only barriers
+     * touch belong to no component, and neither do bits never measured.
+     */
+    class ComponentPartitioner {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    public:
+        ComponentPartition split(const Circuit& circuit) const {
+            uint32_t num_qubits = circuit.get_num_qubits();
+            uint32_t num_clbits = circuit.get_num_clbits();
+            DisjointSets sets(num_qubits + num_clbits);
+            std::vector<bool> touched(num_qubits, false);
+            for (const auto& op : circuit.get_operations()) {
+                if (op.code == OpCode::BARRIER) {
+                    continue;
+                }
+                auto qubits = circuit.qubits(op);
+                for (uint32_t q : qubits) {
+                    touched[q] = true;
+                    sets.unite(qubits[0], q);
+                }
+                for (uint32_t c : circuit.clbits(op)) {
+                    sets.unite(qubits[0], num_qubits + c);
+                }
+            }
+
+            // Component and local index of every qubit and bit
+            ComponentPartition partition(circuit.without_operations());
+            std::vector<uint32_t> component_of_root(num_qubits + num_clbits, NONE);
+            std::vector<uint32_t> component_of(num_qubits + num_clbits, NONE);
+            std::vector<uint32_t> local(num_qubits + num_clbits, NONE);
+            for (uint32_t q = 0; q < num_qubits; ++q) {
+                if (!touched[q]) {
+                    partition.idle_qubits.push_back(q);
+                    continue;
+                }
+                uint32_t& id = component_of_root[sets.find(q)];
+                if (id == NONE) {
+                    id = static_cast<uint32_t>(partition.components.size());
+                    partition.components.emplace_back();
+                }
+                auto& qubits = partition.components[id].qubits;
+                component_of[q] = id;
+                local[q] = static_cast<uint32_t>(qubits.size());
+                qubits.push_back(q);
+            }
+            for (uint32_t c = 0; c < num_clbits; ++c) {
+                uint32_t id = component_of_root[sets.find(num_qubits + c)];
+                if (id == NONE) {
+                    continue;
+                }
+                auto& clbits = partition.components[id].clbits;
+                component_of[num_qubits + c] = id;
+                local[num_qubits + c] = static_cast<uint32_t>(clbits.size());
+                clbits.push_back(c);
+            }
+
+            std::vector<size_t> num_ops(partition.components.size(), 0);
+            std::vector<size_t> num_operands(partition.components.size(), 0);
+            std::vector<size_t> num_params(partition.components.size(), 0);
+            for (const auto& op : circuit.get_operations()) {
+                if (op.code == OpCode::BARRIER) {
+                    continue;
+                }
+                uint32_t id = component_of[circuit.qubits(op)[0]];
+                ++num_ops[id];
+                num_operands[id] += op.num_qubits;
+                num_params[id] += op.num_params;
+            }
+            for (size_t i = 0; i < partition.components.size(); ++i) {
+                CircuitComponent& component = partition.components[i];
+                cut_registers(circuit.get_qregs(), component.qubits, [&](const std::string& name, uint32_t size) {
+                    component.circuit.add_qreg(name, size);
+                });
+                cut_registers(circuit.get_cregs(), component.clbits, [&](const std::string& name, uint32_t size) {
+                    component.circuit.add_creg(name, size);
+                });
+                for (const auto& gate : circuit.get_gates()) {
+                    component.circuit.add_gate(gate.name, gate.num_params, gate.num_qubits, gate.definition);
+                }
+                component.circuit.reserve(num_ops[i], num_operands[i], num_params[i]);    // barriers aside
+            }
+
+            std::vector<uint32_t> qubits, clbits;
+            std::vector<std::pair<uint32_t, uint32_t>> barrier;     // component, local qubit
+            for (const auto& op : circuit.get_operations()) {
+                if (op.code == OpCode::BARRIER) {
+                    barrier.clear();
+                    for (uint32_t q : circuit.qubits(op)) {
+                        if (component_of[q] != NONE) {
+                            barrier.emplace_back(component_of[q], local[q]);
+                        }
+                    }
+                    std::stable_sort(barrier.begin(), barrier.end(),
+                                     [](const auto& a, const auto& b) { return a.first < b.first; });
+                    for (size_t begin = 0, end = 0; begin < barrier.size(); begin = end) {
+                        qubits.clear();
+                        for (end = begin; end < barrier.size() && barrier[end].first == barrier[begin].first; ++end) {
+                            qubits.push_back(barrier[end].second);
+                        }
+                        partition.components[barrier[begin].first].circuit.add(OpCode::BARRIER, qubits.data(), qubits.size());
+                    }
+                    continue;
+                }
+                qubits.clear();
+                clbits.clear();
+                for (uint32_t q : circuit.qubits(op)) {
+                    qubits.push_back(local[q]);
+                }
+                for (uint32_t c : circuit.clbits(op)) {
+                    clbits.push_back(local[num_qubits + c]);
+                }
+                auto params = circuit.params(op);
+                partition.components[component_of[circuit.qubits(op)[0]]].circuit.add(
+                    op.code, qubits.data(), qubits.size(), params.data, params.size(),
+                    clbits.data(), clbits.size(), op.gate);
+            }
+            return partition;
+        }
+
+    private:
+        // Registers cut down to the ascending `indices`, empty ones dropped
+        template <typename Add>
+        static void cut_registers(const std::vector<Circuit::Register>& registers,
+                                  const std::vector<uint32_t>& indices, Add&& add) {
+            size_t i = 0;
+            for (const auto& reg : registers) {
+                uint32_t size = 0;
+                for (; i < indices.size() && indices[i] < reg.offset + reg.size; ++i) {
+                    ++size;
+                }
+                if (size > 0) {
+                    add(reg.name, size);
+                }
+            }
+        }
+    };
+
+}; // namespace qarser
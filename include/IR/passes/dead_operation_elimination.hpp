@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "liveness.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Removes operations no measured result depends on.
+     *
+     * Every classical bit is observed, plus the qubits given on
+     * construction, and one Liveness sweep keeps their causal past. This
+     * deletes gates after a qubit's last measurement, whole histories of
+     * qubits that never reach a measurement, measurements overwritten
+     * before anything read them and resets of qubits still in |0>.
+     * Barriers stay, on all their qubits, while one of them is live.
+     *
+     * A circuit without any measurement is taken to output its final
+     * state, so all its qubits are observed.
+     */
+    class DeadOperationElimination {
+    private:
+        std::vector<uint32_t> observed_qubits;
+
+    public:
+        explicit DeadOperationElimination(std::vector<uint32_t> observed_qubits = {})
+            : observed_qubits(std::move(observed_qubits)) {}
+
+        // Returns the number of removed operations
+        size_t run(Circuit& circuit) const {
+            Liveness liveness(circuit);
+            bool measured = false;
+            for (const auto& op : circuit.get_operations()) {
+                if (op.code == OpCode::MEASURE) {
+                    measured = true;
+                    break;
+                }
+            }
+            for (uint32_t c = 0; c < circuit.get_num_clbits(); ++c) {
+                liveness.observe_clbit(c);
+            }
+            for (uint32_t q = 0; q < circuit.get_num_qubits() && !measured; ++q) {
+                liveness.observe_qubit(q);
+            }
+            for (uint32_t q : observed_qubits) {
+                liveness.observe_qubit(q);
+            }
+            liveness.run(circuit);
+
+            const DynamicBitset& needed = liveness.get_needed();
+            size_t count = circuit.size() - needed.count();
+            if (count > 0) {
+                size_t i = 0;
+                circuit.erase_if([&](const Operation&) { return !needed.test(i++); });
+            }
+            return count;
+        }
+    };
+
+}; // namespace qarser
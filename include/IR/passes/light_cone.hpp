@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "liveness.hpp"
+
+
+namespace qarser {
+
+    struct LightConeSlice {
+        Circuit circuit;                // sliced and compacted
+        std::vector<uint32_t> qubits;   // sliced qubit -> original qubit
+        size_t operations_before = 0;
+    };
+
+
+    /**
+     * @brief Keeps only the operations in the causal past of chosen outputs.
+     *
+     * Outputs are classical bits, meaning the last measurement into each,
+     * and qubits, meaning their state at the end of the circuit; the
+     * operations they depend on come from one Liveness sweep, which holds
+     * one bit per operation, qubit and bit. Sliced qubits are renumbered in
+     * order, keeping their registers (empty ones are dropped), and barriers
+     * keep only sliced qubits. Classical registers and the gate table are
+     * copied unchanged.
+     */
+    class LightConeSlicer {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    public:
+        LightConeSlice slice(const Circuit& circuit, const std::vector<uint32_t>& clbits,
+                             const std::vector<uint32_t>& qubits = {}) const {
+            Liveness liveness(circuit);
+            for (uint32_t c : clbits) {
+                liveness.observe_clbit(c);
+            }
+            for (uint32_t q : qubits) {
+                liveness.observe_qubit(q);
+            }
+            liveness.run(circuit);
+            const DynamicBitset& needed = liveness.get_needed();
+            const DynamicBitset& sliced = liveness.get_used();
+
+            LightConeSlice result;
+            result.operations_before = circuit.size();
+            result.qubits.reserve(sliced.count());
+            std::vector<uint32_t> renamed(circuit.get_num_qubits(), NONE);
+            for (const auto& reg : circuit.get_qregs()) {
+                uint32_t size = 0;
+                for (uint32_t q = reg.offset; q < reg.offset + reg.size; ++q) {
+                    if (sliced.test(q)) {
+                        renamed[q] = static_cast<uint32_t>(result.qubits.size());
+                        result.qubits.push_back(q);
+                        ++size;
+                    }
+                }
+                if (size > 0) {
+                    result.circuit.add_qreg(reg.name, size);
+                }
+            }
+            for (const auto& reg : circuit.get_cregs()) {
+                result.circuit.add_creg(reg.name, reg.size);
+            }
+            for (const auto& gate : circuit.get_gates()) {
+                result.circuit.add_gate(gate.name, gate.num_params, gate.num_qubits, gate.definition);
+            }
+
+            size_t num_operands = 0;
+            size_t num_params = 0;
+            needed.for_each([&](size_t v) {
+                num_operands += circuit[v].num_qubits;
+                num_params += circuit[v].num_params;
+            });
+            result.circuit.reserve(needed.count(), num_operands, num_params);
+            std::vector<uint32_t> wires;
+            needed.for_each([&](size_t v) {
+                const Operation& op = circuit[v];
+                wires.clear();
+                for (uint32_t q : circuit.qubits(op)) {
+                    if (renamed[q] != NONE) {
+                        wires.push_back(renamed[q]);
+                    }
+                }
+                auto params = circuit.params(op);
+                auto bits = circuit.clbits(op);
+                result.circuit.add(op.code, wires.data(), wires.size(), params.data, params.size(),
+                                   bits.data, bits.size(), op.gate);
+            });
+            return result;
+        }
+    };
+
+}; // namespace qarser
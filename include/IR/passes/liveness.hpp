@@ -0,0 +1,132 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "IR/circuit.hpp"
+#include "utils/bitset.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Backward liveness of qubits and classical bits.
+     *
+     * Observed qubits stand for their state at the end of the circuit and
+     * observed bits for the last measurement into them. One backward sweep
+     * marks the operations in their causal past:
+     *
+     *  - a gate touching a live qubit is needed and makes all its qubits live;
+     *  - a measurement is needed when its qubit or its bit is live, then the
+     *    qubit is live and the bit is not, earlier writes being overwritten;
+     *  - a reset of a live qubit is needed and ends its liveness, since the
+     *    qubit's state before it no longer matters;
+     *  - a barrier is needed when one of its qubits is live, and changes
+     *    nothing else.
+     *
+     * This is reachability in the dependency DAG without building it, and
+     * the sweep stops as soon as nothing is live. A forward pass over the
+     * needed operations then drops resets of qubits none of them touched
+     * yet, those are still in |0>.
+     */
+    class Liveness {
+    private:
+        DynamicBitset live_qubits;
+        DynamicBitset live_clbits;
+        size_t live = 0;
+        DynamicBitset needed;       // operation -> in the causal past
+        DynamicBitset used;         // qubit -> observed, or touched by a needed non-barrier
+
+    public:
+        explicit Liveness(const Circuit& circuit)
+            : live_qubits(circuit.get_num_qubits()), live_clbits(circuit.get_num_clbits()),
+              used(circuit.get_num_qubits()) {}
+
+        void observe_qubit(uint32_t qubit) {
+            if (qubit >= live_qubits.size()) {
+                throw std::invalid_argument("Qubit " + std::to_string(qubit) + " out of range");
+            }
+            live += !live_qubits.test_and_set(qubit);
+            used.set(qubit);
+        }
+
+        void observe_clbit(uint32_t clbit) {
+            if (clbit >= live_clbits.size()) {
+                throw std::invalid_argument("Classical bit " + std::to_string(clbit) + " out of range");
+            }
+            live += !live_clbits.test_and_set(clbit);
+        }
+
+        void run(const Circuit& circuit) {
+            needed = DynamicBitset(circuit.size());
+            for (size_t v = circuit.size(); v-- > 0 && live > 0;) {
+                const Operation& op = circuit[v];
+                auto qubits = circuit.qubits(op);
+                bool relevant = false;
+                for (uint32_t q : qubits) {
+                    relevant |= live_qubits.test(q);
+                }
+                if (op.code == OpCode::MEASURE) {
+                    for (uint32_t c : circuit.clbits(op)) {
+                        relevant |= live_clbits.test(c);
+                    }
+                }
+                if (!relevant) {
+                    continue;
+                }
+                needed.set(v);
+                if (op.code == OpCode::BARRIER) {
+                    continue;
+                }
+                if (op.code == OpCode::RESET) {
+                    for (uint32_t q : qubits) {
+                        if (live_qubits.test(q)) {
+                            live_qubits.reset(q);
+                            --live;
+                        }
+                    }
+                    continue;
+                }
+                for (uint32_t q : qubits) {
+                    live += !live_qubits.test_and_set(q);
+                }
+                if (op.code == OpCode::MEASURE) {
+                    for (uint32_t c : circuit.clbits(op)) {
+                        if (live_clbits.test(c)) {
+                            live_clbits.reset(c);
+                            --live;
+                        }
+                    }
+                }
+            }
+
+            DynamicBitset touched(circuit.get_num_qubits());
+            needed.for_each([&](size_t v) {
+                const Operation& op = circuit[v];
+                if (op.code == OpCode::BARRIER) {
+                    return;
+                }
+                bool fresh = op.code == OpCode::RESET;
+                for (uint32_t q : circuit.qubits(op)) {
+                    fresh &= !touched.test(q);
+                }
+                if (fresh) {
+                    needed.reset(v);
+                    return;
+                }
+                for (uint32_t q : circuit.qubits(op)) {
+                    touched.set(q);
+                    used.set(q);
+                }
+            });
+        }
+
+        const DynamicBitset& get_needed() const {
+            return needed;
+        }
+
+        const DynamicBitset& get_used() const {
+            return used;
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,265 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "IR/circuit.hpp"
+
+
+namespace qarser {
+
+    // Identifies a standard operation, or a program defined gate by its id
+    struct OpKey {
+        OpCode code;
+        uint32_t gate = 0;
+
+        OpKey(OpCode code, uint32_t gate = 0)
+            : code(code), gate(code == OpCode::GATE ? gate : 0) {}
+
+        static OpKey of(const Operation& op) {
+            return OpKey(op.code, op.gate);
+        }
+
+        uint64_t value() const {
+            return (static_cast<uint64_t>(gate) << 8) | static_cast<uint8_t>(code);
+        }
+    };
+
+
+    /**
+     * @brief Inverse and merge rules for peephole optimization.
+     *
+     * An inverse rule says that `a` directly followed by `b` on the same
+     * qubits (in the same order) is the identity. A merge rule says that
+     * two consecutive `a` with otherwise equal parameters combine by adding
+     * parameter `param`, and that the result is the identity when that
+     * angle is a multiple of `period`.
+     */
+    class PeepholeRules {
+    public:
+        static constexpr uint32_t NO_PARAM = std::numeric_limits<uint32_t>::max();
+
+        struct Rule {
+            bool has_inverse = false;
+            uint64_t inverse = 0;
+            uint32_t param = NO_PARAM;
+            double period = 0.0;
+        };
+
+    private:
+        // Standard operations are indexed directly, program gates are hashed
+        Rule by_code[static_cast<size_t>(OpCode::BARRIER) + 1];
+        std::unordered_map<uint32_t, Rule> by_gate;
+
+    public:
+        void add_inverse(OpKey a, OpKey b) {
+            rule(a).has_inverse = true;
+            rule(a).inverse = b.value();
+            rule(b).has_inverse = true;
+            rule(b).inverse = a.value();
+        }
+
+        void add_self_inverse(OpKey a) {
+            add_inverse(a, a);
+        }
+
+        void add_merge(OpKey a, uint32_t param, double period) {
+            rule(a).param = param;
+            rule(a).period = period;
+        }
+
+        const Rule* find(OpKey key) const {
+            if (key.code != OpCode::GATE) {
+                return &by_code[static_cast<size_t>(key.code)];
+            }
+            auto it = by_gate.find(key.gate);
+            return it != by_gate.end() ? &it->second : nullptr;
+        }
+
+        // Rules for the builtin and qelib1 gates
+        static PeepholeRules standard() {
+            PeepholeRules rules;
+            for (OpCode code : {OpCode::CX, OpCode::X, OpCode::Y, OpCode::Z, OpCode::H,
+                                OpCode::CZ, OpCode::CY, OpCode::SWAP, OpCode::CH,
+                                OpCode::CCX, OpCode::CSWAP, OpCode::C3X, OpCode::C4X}) {
+                rules.add_self_inverse(code);
+            }
+            rules.add_inverse(OpCode::S, OpCode::SDG);
+            rules.add_inverse(OpCode::T, OpCode::TDG);
+            rules.add_inverse(OpCode::SX, OpCode::SXDG);
+
+            // Uncontrolled rotations are the identity up to a global phase at 2*pi
+            const double turn = 2 * M_PI;
+            for (OpCode code : {OpCode::RX, OpCode::RY, OpCode::RZ, OpCode::U1, OpCode::P,
+                                OpCode::RXX, OpCode::RZZ, OpCode::CU1, OpCode::CP}) {
+                rules.add_merge(code, 0, turn);
+            }
+            for (OpCode code : {OpCode::CRX, OpCode::CRY, OpCode::CRZ}) {
+                rules.add_merge(code, 0, 2 * turn);
+            }
+            return rules;
+        }
+
+    private:
+        Rule& rule(OpKey key) {
+            return key.code == OpCode::GATE ? by_gate[key.gate] : by_code[static_cast<size_t>(key.code)];
+        }
+    };
+
+
+    /**
+     * @brief Cancels adjacent inverse pairs and merges adjacent rotations.
+     *
+     * Operations are visited in order while each qubit keeps its frontier,
+     * the last surviving operation on that wire. An operation interacts
+     * with the frontier only when it is the frontier of all of its qubits
+     * and acts on exactly the same qubits. Every operation records its
+     * predecessor on each wire, so after a cancellation the frontier falls
+     * back to what came before and nested pairs such as `h; x; x; h` vanish
+     * in the same sweep. Each sweep is linear; sweeps repeat until one
+     * removes nothing.
+     */
+    class PeepholeOptimizer {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        static constexpr double TOLERANCE = 1e-9;
+
+        PeepholeRules rules;
+
+        std::vector<uint32_t> frontier;     // qubit -> last surviving operation
+        std::vector<uint32_t> previous;     // qubit operand slot -> operation before it on the wire
+        std::vector<uint8_t> removed;
+
+    public:
+        explicit PeepholeOptimizer(PeepholeRules rules = PeepholeRules::standard())
+            : rules(std::move(rules)) {}
+
+        PeepholeRules& get_rules() {
+            return rules;
+        }
+
+        // Runs sweeps to a fixed point and returns the number of removed operations
+        size_t run(Circuit& circuit) {
+            size_t total = 0;
+            while (size_t count = sweep(circuit)) {
+                total += count;
+            }
+            return total;
+        }
+
+        size_t sweep(Circuit& circuit) {
+            size_t n = circuit.size();
+            size_t slots = 0;
+            for (const auto& op : circuit.get_operations()) {
+                slots = std::max<size_t>(slots, op.qubit_offset + op.num_qubits);
+            }
+            frontier.assign(circuit.get_num_qubits(), NONE);
+            previous.assign(slots, NONE);
+            removed.assign(n, 0);
+
+            size_t count = 0;
+            for (uint32_t v = 0; v < n; ++v) {
+                const Operation& op = circuit[v];
+                uint32_t u = candidate(circuit, op);
+                if (u != NONE) {
+                    const Operation& prev = circuit[u];
+                    const PeepholeRules::Rule* rule = rules.find(OpKey::of(prev));
+                    if (rule && rule->has_inverse && rule->inverse == OpKey::of(op).value() &&
+                        prev.num_params == 0 && op.num_params == 0) {
+                        pop(circuit, u);
+                        removed[v] = 1;
+                        count += 2;
+                        continue;
+                    }
+                    if (rule && rule->param != PeepholeRules::NO_PARAM &&
+                        OpKey::of(prev).value() == OpKey::of(op).value() && mergeable(circuit, prev, op, rule->param)) {
+                        double& angle = circuit.params(prev)[rule->param];
+                        angle += circuit.params(op)[rule->param];
+                        removed[v] = 1;
+                        ++count;
+                        if (is_identity(angle, rule->period)) {
+                            pop(circuit, u);
+                            ++count;
+                        }
+                        continue;
+                    }
+                }
+
+                // A lone rotation by a multiple of its period is dropped
+                const PeepholeRules::Rule* rule = rules.find(OpKey::of(op));
+                if (rule && rule->param != PeepholeRules::NO_PARAM && rule->param < op.num_params &&
+                    is_identity(circuit.params(op)[rule->param], rule->period)) {
+                    removed[v] = 1;
+                    ++count;
+                    continue;
+                }
+                push(circuit, v);
+            }
+
+            if (count > 0) {
+                size_t i = 0;
+                circuit.erase_if([&](const Operation&) { return removed[i++] != 0; });
+            }
+            return count;
+        }
+
+    private:
+        // Frontier operation shared by all of op's qubits in the same order, or NONE
+        uint32_t candidate(const Circuit& circuit, const Operation& op) const {
+            if (op.num_qubits == 0 || op.num_clbits != 0) {
+                return NONE;
+            }
+            auto qubits = circuit.qubits(op);
+            uint32_t u = frontier[qubits[0]];
+            if (u == NONE || circuit[u].num_qubits != op.num_qubits) {
+                return NONE;
+            }
+            auto prev = circuit.qubits(circuit[u]);
+            for (uint32_t k = 0; k < op.num_qubits; ++k) {
+                if (prev[k] != qubits[k] || frontier[qubits[k]] != u) {
+                    return NONE;
+                }
+            }
+            return u;
+        }
+
+        static bool mergeable(const Circuit& circuit, const Operation& a, const Operation& b, uint32_t param) {
+            if (a.num_params != b.num_params || param >= a.num_params) {
+                return false;
+            }
+            auto pa = circuit.params(a);
+            auto pb = circuit.params(b);
+            for (uint32_t i = 0; i < a.num_params; ++i) {
+                if (i != param && pa[i] != pb[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool is_identity(double angle, double period) {
+            double rest = std::fmod(std::abs(angle), period);
+            return rest < TOLERANCE || period - rest < TOLERANCE;
+        }
+
+        void push(const Circuit& circuit, uint32_t v) {
+            const Operation& op = circuit[v];
+            auto qubits = circuit.qubits(op);
+            for (uint32_t k = 0; k < op.num_qubits; ++k) {
+                previous[op.qubit_offset + k] = frontier[qubits[k]];
+                frontier[qubits[k]] = v;
+            }
+        }
+
+        void pop(const Circuit& circuit, uint32_t u) {
+            const Operation& op = circuit[u];
+            auto qubits = circuit.qubits(op);
+            for (uint32_t k = 0; k < op.num_qubits; ++k) {
+                frontier[qubits[k]] = previous[op.qubit_offset + k];
+            }
+            removed[u] = 1;
+        }
+    };
+
+}; // namespace qarser
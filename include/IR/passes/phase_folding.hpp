@@ -0,0 +1,285 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "IR/passes/peephole.hpp"
+
+
+namespace qarser {
+
+    struct PhaseFoldingReport {
+        size_t t_count_before = 0;
+        size_t t_count_after = 0;
+        size_t cx_count_before = 0;
+        size_t cx_count_after = 0;
+    };
+
+
+    /**
+     * @brief Merges phase gates that act on the same parity of {CX, phase} regions.
+     *
+     * Inside a region made of CX and diagonal phase gates (z, s, sdg, t,
+     * tdg, rz, u1, p) every wire holds a parity of the region's input
+     * variables, and the region is a phase polynomial: the sum of the
+     * phase angles applied to each parity. Any other operation on a qubit
+     * ends the region there and gives the qubit a fresh variable; phases
+     * on equal parities still add up across such cuts, since each phase
+     * is a scalar factor in the sum over paths.
+     *
+     * Parities are bit-packed with one bit per variable, so a CX is one
+     * XOR per 64 variables, and every wire also keeps a Zobrist hash of
+     * its parity to look terms up in constant time. When the variables
+     * run out, all wires are rebased onto fresh variables and terms seen
+     * so far are no longer merged with later ones, which keeps the
+     * vectors at 2 bits per qubit and bounds the parities kept for terms.
+     *
+     * Each merged term is resynthesized at its first occurrence, as t, s,
+     * z and their inverses when the angle is a multiple of pi/4 and as a
+     * rotation otherwise; the CX network is kept, and CX pairs left
+     * adjacent by removed phases are cancelled afterwards.
+     */
+    class PhaseFolding {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        static constexpr double TOLERANCE = 1e-9;
+
+        struct Term {
+            uint32_t first;         // operation where the term is emitted
+            uint32_t next;          // next term with the same hash
+            uint32_t parity;        // offset into term_parities, until the next rebase
+            OpCode code;            // rotation to emit, GATE if only fixed phases
+            double angle;
+        };
+
+        size_t words = 0;
+        uint32_t num_variables = 0;
+        uint32_t next_variable = 0;
+        std::vector<uint64_t> parities;         // qubit -> words of its parity
+        std::vector<uint64_t> hashes;           // qubit -> hash of its parity
+        std::vector<uint64_t> keys;             // variable -> hash key
+
+        std::vector<Term> terms;
+        std::vector<uint64_t> term_parities;
+        std::unordered_map<uint64_t, uint32_t> index;   // hash -> first term
+        std::vector<uint32_t> term_of;                  // operation -> term, NONE if not a phase
+
+    public:
+        PhaseFoldingReport run(Circuit& circuit) {
+            PhaseFoldingReport report;
+            report.t_count_before = t_count(circuit);
+            report.cx_count_before = cx_count(circuit);
+
+            fold(circuit);
+            PeepholeRules cancel_cx;
+            cancel_cx.add_self_inverse(OpCode::CX);
+            PeepholeOptimizer(cancel_cx).run(circuit);
+
+            report.t_count_after = t_count(circuit);
+            report.cx_count_after = cx_count(circuit);
+            return report;
+        }
+
+        // Returns the number of phase gates removed
+        size_t fold(Circuit& circuit) {
+            collect_terms(circuit);
+
+            Circuit result = circuit.without_operations();
+            result.reserve(circuit.size(), circuit.size() * 2, circuit.size());
+            size_t num_phases = 0, num_emitted = 0;
+            for (uint32_t v = 0; v < circuit.size(); ++v) {
+                const Operation& op = circuit[v];
+                uint32_t t = term_of[v];
+                if (t == NONE) {
+                    result.append(circuit, op);
+                    continue;
+                }
+                ++num_phases;
+                if (terms[t].first == v) {
+                    num_emitted += emit(terms[t], circuit.qubits(op)[0], result);
+                }
+            }
+            circuit = std::move(result);
+            return num_phases - num_emitted;
+        }
+
+        // Angle of a diagonal single-qubit phase gate, up to global phase
+        static std::optional<double> phase_angle(OpCode code, const double* params) {
+            switch (code) {
+                case OpCode::Z:   return M_PI;
+                case OpCode::S:   return M_PI / 2;
+                case OpCode::SDG: return -M_PI / 2;
+                case OpCode::T:   return M_PI / 4;
+                case OpCode::TDG: return -M_PI / 4;
+                case OpCode::RZ:
+                case OpCode::U1:
+                case OpCode::P:   return params[0];
+                default:          return std::nullopt;
+            }
+        }
+
+        // T gates, counting rotations by odd multiples of pi/4 as one
+        static size_t t_count(const Circuit& circuit) {
+            size_t count = 0;
+            for (const auto& op : circuit.get_operations()) {
+                if (op.num_qubits != 1) {
+                    continue;
+                }
+                auto angle = phase_angle(op.code, circuit.params(op).data);
+                if (angle) {
+                    int k = eighth_turns(*angle);
+                    count += k >= 0 && k % 2 == 1;
+                }
+            }
+            return count;
+        }
+
+        static size_t cx_count(const Circuit& circuit) {
+            size_t count = 0;
+            for (const auto& op : circuit.get_operations()) {
+                count += op.code == OpCode::CX;
+            }
+            return count;
+        }
+
+    private:
+        void collect_terms(const Circuit& circuit) {
+            uint32_t num_qubits = circuit.get_num_qubits();
+            words = std::max<size_t>(1, (2 * size_t(num_qubits) + 63) / 64);
+            num_variables = static_cast<uint32_t>(words * 64);
+            parities.assign(num_qubits * words, 0);
+            hashes.assign(num_qubits, 0);
+            keys.resize(num_variables);
+            uint64_t state = 0x9e3779b97f4a7c15ull;
+            for (auto& key : keys) {
+                key = splitmix64(state);
+            }
+            terms.clear();
+            term_parities.clear();
+            term_of.assign(circuit.size(), NONE);
+            rebase(num_qubits);
+
+            for (uint32_t v = 0; v < circuit.size(); ++v) {
+                const Operation& op = circuit[v];
+                auto qubits = circuit.qubits(op);
+                if (op.code == OpCode::CX) {
+                    uint64_t* target = parity(qubits[1]);
+                    const uint64_t* control = parity(qubits[0]);
+                    for (size_t w = 0; w < words; ++w) {
+                        target[w] ^= control[w];
+                    }
+                    hashes[qubits[1]] ^= hashes[qubits[0]];
+                    continue;
+                }
+                if (op.num_qubits == 1 && op.num_clbits == 0) {
+                    auto angle = phase_angle(op.code, circuit.params(op).data);
+                    if (angle) {
+                        add_phase(v, op.code, *angle, qubits[0]);
+                        continue;
+                    }
+                }
+                for (uint32_t q : qubits) {
+                    cut(q, num_qubits);
+                }
+            }
+        }
+
+        uint64_t* parity(uint32_t qubit) {
+            return parities.data() + qubit * words;
+        }
+
+        void add_phase(uint32_t v, OpCode code, double angle, uint32_t qubit) {
+            const uint64_t* bits = parity(qubit);
+            uint64_t hash = hashes[qubit];
+            auto it = index.find(hash);
+            uint32_t t = it != index.end() ? it->second : NONE;
+            while (t != NONE && std::memcmp(&term_parities[terms[t].parity], bits, words * sizeof(uint64_t)) != 0) {
+                t = terms[t].next;
+            }
+            if (t == NONE) {
+                t = static_cast<uint32_t>(terms.size());
+                uint32_t offset = static_cast<uint32_t>(term_parities.size());
+                term_parities.insert(term_parities.end(), bits, bits + words);
+                terms.push_back(Term{v, it != index.end() ? it->second : NONE, offset, OpCode::GATE, 0.0});
+                index[hash] = t;
+            }
+            Term& term = terms[t];
+            term.angle += angle;
+            if (term.code == OpCode::GATE && (code == OpCode::RZ || code == OpCode::U1 || code == OpCode::P)) {
+                term.code = code;
+            }
+            term_of[v] = t;
+        }
+
+        // The qubit's value is replaced by a fresh variable
+        void cut(uint32_t qubit, uint32_t num_qubits) {
+            if (next_variable == num_variables) {
+                rebase(num_qubits);
+                return;
+            }
+            uint64_t* bits = parity(qubit);
+            std::fill(bits, bits + words, 0);
+            bits[next_variable / 64] = uint64_t(1) << (next_variable % 64);
+            hashes[qubit] = keys[next_variable];
+            ++next_variable;
+        }
+
+        // Every qubit becomes its own variable, earlier terms are closed
+        void rebase(uint32_t num_qubits) {
+            std::fill(parities.begin(), parities.end(), 0);
+            for (uint32_t q = 0; q < num_qubits; ++q) {
+                parity(q)[q / 64] = uint64_t(1) << (q % 64);
+                hashes[q] = keys[q];
+            }
+            next_variable = num_qubits;
+            index.clear();
+            term_parities.clear();
+        }
+
+        // Appends the gates for a merged term and returns how many
+        size_t emit(const Term& term, uint32_t qubit, Circuit& result) const {
+            int k = eighth_turns(term.angle);
+            if (k < 0) {
+                double angle = std::remainder(term.angle, 2 * M_PI);
+                result.add(term.code, &qubit, 1, &angle, 1);
+                return 1;
+            }
+            static constexpr OpCode gates[8][2] = {
+                {OpCode::GATE, OpCode::GATE}, {OpCode::T, OpCode::GATE},
+                {OpCode::S, OpCode::GATE},    {OpCode::S, OpCode::T},
+                {OpCode::Z, OpCode::GATE},    {OpCode::SDG, OpCode::TDG},
+                {OpCode::SDG, OpCode::GATE},  {OpCode::TDG, OpCode::GATE},
+            };
+            size_t count = 0;
+            for (OpCode code : gates[k]) {
+                if (code != OpCode::GATE) {
+                    result.add(code, &qubit, 1, nullptr, 0);
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        // Angle in multiples of pi/4 modulo 8, -1 if it is not one
+        static int eighth_turns(double angle) {
+            double eighths = angle / (M_PI / 4);
+            double rounded = std::round(eighths);
+            if (std::abs(eighths - rounded) > TOLERANCE) {
+                return -1;
+            }
+            return static_cast<int>(((static_cast<int64_t>(rounded) % 8) + 8) % 8);
+        }
+
+        static uint64_t splitmix64(uint64_t& state) {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+    };
+
+}; // namespace qarser
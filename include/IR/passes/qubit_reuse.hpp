@@ -0,0 +1,256 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "IR/dag.hpp"
+
+
+namespace qarser {
+
+    struct QubitReuseResult {
+        Circuit circuit;                // on a single register "q" of width_after wires
+        uint32_t width_before = 0;
+        uint32_t width_after = 0;
+        size_t resets = 0;              // resets before reused wires, replacing the program's
+        bool reordered = false;         // whether the operations were rescheduled
+        std::vector<std::vector<uint32_t>> wires;   // original qubit -> wire of each segment, empty if idle
+    };
+
+
+    /**
+     * @brief Narrows a circuit by running later qubits on wires freed by measurements.
+     *
+     * Every qubit's history is split into segments at its resets. A
+     * segment frees its wire when its last operation is a measurement or
+     * when a reset follows it, and a segment starting later can then run
+     * on that wire after a reset. Segments that end otherwise keep their
+     * wire to the end of the circuit. The program's own resets are
+     * dropped: a segment on a fresh wire starts in |0> anyway, and one on
+     * a reused wire always gets a reset first.
+     *
+     * For a fixed order of operations the segments are intervals, and
+     * giving each one, in order of start, the lowest freed wire or else a
+     * new one needs exactly as many wires as the most segments alive at
+     * once. Two orders are tried: program order, and a topological order
+     * of the dependency DAG that runs everything not opening a segment
+     * first, so measurements free wires before new qubits need them. The
+     * narrower one wins, program order on ties.
+     *
+     * Barriers neither open nor extend segments; they keep only the
+     * qubits still holding a wire when they run. The result maps every
+     * original qubit to the wires its segments ran on, in program order.
+     */
+    class QubitReuse {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        struct Segment {
+            uint32_t qubit;
+            uint32_t first;         // operation opening the segment
+            uint32_t last;          // last operation on it, barriers aside
+            bool frees;             // ends at a measurement or before a reset
+        };
+
+        struct Assignment {
+            std::vector<uint32_t> wires;        // segment -> wire
+            uint32_t width = 0;
+        };
+
+        std::vector<Segment> segments;
+        std::vector<uint32_t> operand_offsets;  // operation -> first entry in segment_of
+        std::vector<uint32_t> segment_of;       // qubit operand -> segment, NONE if none
+        std::vector<uint32_t> opened;           // operation -> segments it opens
+        std::vector<std::vector<uint32_t>> closed;  // operation -> freeing segments it ends
+
+    public:
+        QubitReuseResult run(const Circuit& circuit) {
+            collect_segments(circuit);
+
+            std::vector<uint32_t> order(circuit.size());
+            for (uint32_t v = 0; v < circuit.size(); ++v) {
+                order[v] = v;
+            }
+            Assignment assignment = assign(order);
+
+            std::vector<uint32_t> deferred = defer_openings(circuit);
+            Assignment alternative = assign(deferred);
+            QubitReuseResult result;
+            if (alternative.width < assignment.width) {
+                order = std::move(deferred);
+                assignment = std::move(alternative);
+                result.reordered = true;
+            }
+
+            result.width_before = circuit.get_num_qubits();
+            result.width_after = assignment.width;
+            result.wires.resize(circuit.get_num_qubits());
+            for (uint32_t s = 0; s < segments.size(); ++s) {
+                result.wires[segments[s].qubit].push_back(assignment.wires[s]);
+            }
+            result.circuit = emit(circuit, order, assignment, result.resets);
+            return result;
+        }
+
+    private:
+        void collect_segments(const Circuit& circuit) {
+            segments.clear();
+            operand_offsets.assign(circuit.size() + 1, 0);
+            segment_of.clear();
+            opened.assign(circuit.size(), 0);
+            closed.assign(circuit.size(), {});
+
+            std::vector<uint32_t> current(circuit.get_num_qubits(), NONE);
+            for (uint32_t v = 0; v < circuit.size(); ++v) {
+                const Operation& op = circuit[v];
+                for (uint32_t q : circuit.qubits(op)) {
+                    if (op.code == OpCode::BARRIER) {
+                        segment_of.push_back(current[q]);
+                        continue;
+                    }
+                    if (op.code == OpCode::RESET) {
+                        if (current[q] != NONE) {
+                            segments[current[q]].frees = true;
+                            current[q] = NONE;
+                        }
+                        segment_of.push_back(NONE);
+                        continue;
+                    }
+                    if (current[q] == NONE) {
+                        current[q] = static_cast<uint32_t>(segments.size());
+                        segments.push_back(Segment{q, v, v, false});
+                        ++opened[v];
+                    }
+                    segments[current[q]].last = v;
+                    segments[current[q]].frees = op.code == OpCode::MEASURE;
+                    segment_of.push_back(current[q]);
+                }
+                operand_offsets[v + 1] = static_cast<uint32_t>(segment_of.size());
+            }
+
+            // Freed wires are released once the segment's last operation ran
+            for (uint32_t s = 0; s < segments.size(); ++s) {
+                if (segments[s].frees) {
+                    closed[segments[s].last].push_back(s);
+                }
+            }
+        }
+
+        // Topological order running operations that open no segment first
+        std::vector<uint32_t> defer_openings(const Circuit& circuit) const {
+            DependencyDag dag(circuit);
+            std::vector<uint32_t> remaining(circuit.size());
+            using Entry = std::pair<uint32_t, uint32_t>;    // segments opened, operation
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> ready;
+            for (uint32_t v = 0; v < circuit.size(); ++v) {
+                remaining[v] = dag.in_degree(v);
+                if (remaining[v] == 0) {
+                    ready.emplace(opened[v], v);
+                }
+            }
+
+            std::vector<uint32_t> order;
+            order.reserve(circuit.size());
+            while (!ready.empty()) {
+                uint32_t v = ready.top().second;
+                ready.pop();
+                order.push_back(v);
+                for (uint32_t u : dag.successors(v)) {
+                    if (--remaining[u] == 0) {
+                        ready.emplace(opened[u], u);
+                    }
+                }
+            }
+            return order;
+        }
+
+        // Greedy interval partitioning of the segments in `order`
+        Assignment assign(const std::vector<uint32_t>& order) const {
+            Assignment assignment;
+            assignment.wires.assign(segments.size(), NONE);
+            std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> available;
+            for (uint32_t v : order) {
+                if (opened[v] > 0) {
+                    for (uint32_t i = operand_offsets[v]; i < operand_offsets[v + 1]; ++i) {
+                        uint32_t s = segment_of[i];
+                        if (segments[s].first != v) {
+                            continue;
+                        }
+                        if (available.empty()) {
+                            assignment.wires[s] = assignment.width++;
+                        }
+                        else {
+                            assignment.wires[s] = available.top();
+                            available.pop();
+                        }
+                    }
+                }
+                for (uint32_t s : closed[v]) {
+                    available.push(assignment.wires[s]);
+                }
+            }
+            return assignment;
+        }
+
+        Circuit emit(const Circuit& circuit, const std::vector<uint32_t>& order,
+                     const Assignment& assignment, size_t& resets) const {
+            Circuit narrowed;
+            narrowed.add_qreg("q", assignment.width);
+            for (const auto& reg : circuit.get_cregs()) {
+                narrowed.add_creg(reg.name, reg.size);
+            }
+            for (const auto& gate : circuit.get_gates()) {
+                narrowed.add_gate(gate.name, gate.num_params, gate.num_qubits, gate.definition);
+            }
+            size_t num_params = 0;
+            for (const auto& op : circuit.get_operations()) {
+                num_params += op.num_params;
+            }
+            narrowed.reserve(circuit.size() + segments.size(), segment_of.size() + segments.size(), num_params);
+
+            std::vector<bool> used(assignment.width, false);       // wire held a segment before
+            std::vector<bool> released(segments.size(), false);
+            std::vector<uint32_t> wires;
+            for (uint32_t v : order) {
+                const Operation& op = circuit[v];
+                if (op.code == OpCode::RESET) {
+                    continue;
+                }
+                wires.clear();
+                for (uint32_t i = operand_offsets[v]; i < operand_offsets[v + 1]; ++i) {
+                    uint32_t s = segment_of[i];
+                    if (op.code == OpCode::BARRIER) {
+                        if (s != NONE && assignment.wires[s] != NONE && !released[s]) {
+                            wires.push_back(assignment.wires[s]);
+                        }
+                        continue;
+                    }
+                    uint32_t wire = assignment.wires[s];
+                    if (segments[s].first == v) {
+                        if (used[wire]) {
+                            narrowed.add(OpCode::RESET, {wire});
+                            ++resets;
+                        }
+                        used[wire] = true;
+                    }
+                    wires.push_back(wire);
+                }
+                if (op.code == OpCode::BARRIER && wires.empty()) {
+                    continue;
+                }
+                auto params = circuit.params(op);
+                auto clbits = circuit.clbits(op);
+                narrowed.add(op.code, wires.data(), wires.size(), params.data, params.size(),
+                             clbits.data, clbits.size(), op.gate);
+                for (uint32_t s : closed[v]) {
+                    released[s] = true;
+                }
+            }
+            return narrowed;
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,471 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "IR/coupling_map.hpp"
+#include "IR/dag.hpp"
+#include "utils/thread_pool.hpp"
+
+
+namespace qarser {
+
+    struct SabreOptions {
+        uint32_t trials = 8;                // independent layouts, trial 0 starts from the given one
+        uint64_t seed = 0;
+        uint32_t refinements = 1;           // forward/backward passes improving the initial layout
+        uint32_t extended_size = 20;        // two-qubit gates looked ahead past the front layer
+        double extended_weight = 0.5;
+        double decay_increment = 0.001;
+        uint32_t decay_reset = 5;           // swaps between decay resets
+    };
+
+
+    struct RoutingResult {
+        Circuit circuit;                    // on a single register "q" of physical qubits
+        Layout initial_layout;
+        Layout final_layout;
+        size_t swaps = 0;
+        uint32_t trial = 0;                 // trial that produced the result
+    };
+
+
+    /**
+     * @brief SABRE routing onto a CouplingMap.
+     *
+     * Operations are scheduled from the front layer of the dependency DAG.
+     * Everything in the front that is executable under the current layout
+     * is emitted; when only non-adjacent two-qubit gates remain, the swap
+     * on an edge touching them that minimizes the mean distance of the
+     * front layer plus a weighted mean over the next `extended_size`
+     * two-qubit gates, scaled by a decay that discourages reusing the same
+     * qubits, is inserted. If no gate gets executed for a while, the
+     * closest front gate is routed along a shortest path.
+     *
+     * Each trial refines its initial layout by routing the circuit forward
+     * and backward before the final forward pass. Trials run in parallel
+     * on the thread pool, each with its own random generator seeded from
+     * the options, and the result with the fewest swaps wins (ties go to
+     * the lowest trial), so the output only depends on the seed.
+     *
+     * Operations on more than two qubits, other than barriers, have to be
+     * decomposed first.
+     */
+    class SabreRouter {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        // An operation to emit, or a swap of two physical qubits if op is NONE
+        struct Step {
+            uint32_t op;
+            uint32_t a;
+            uint32_t b;
+        };
+
+        struct Trial {
+            Layout initial;
+            Layout final;
+            std::vector<Step> steps;
+            size_t swaps = 0;
+        };
+
+        // Per physical qubit, its partners in a set of two-qubit operations
+        struct Links {
+            struct Entry {
+                uint32_t qubit;
+                uint32_t partner;
+                uint32_t next;
+            };
+            std::vector<uint32_t> head;
+            std::vector<Entry> entries;
+
+            void add(uint32_t qubit, uint32_t partner) {
+                entries.push_back(Entry{qubit, partner, head[qubit]});
+                head[qubit] = static_cast<uint32_t>(entries.size() - 1);
+            }
+        };
+
+        // Total distance of a set of operations; a swap only changes the
+        // distances of the operations on its two qubits
+        struct Partners {
+            double total = 0.0;
+            size_t count = 0;
+
+            double mean_after(uint32_t a, uint32_t b, const CouplingMap& coupling, const Links& links) const {
+                if (count == 0) {
+                    return 0.0;
+                }
+                double delta = 0.0;
+                for (uint32_t e = links.head[a]; e != NONE; e = links.entries[e].next) {
+                    uint32_t partner = links.entries[e].partner;
+                    if (partner != b) {
+                        delta += double(coupling.distance(b, partner)) - coupling.distance(a, partner);
+                    }
+                }
+                for (uint32_t e = links.head[b]; e != NONE; e = links.entries[e].next) {
+                    uint32_t partner = links.entries[e].partner;
+                    if (partner != a) {
+                        delta += double(coupling.distance(a, partner)) - coupling.distance(b, partner);
+                    }
+                }
+                return (total + delta) / count;
+            }
+        };
+
+        const CouplingMap& coupling;
+        SabreOptions options;
+        ThreadPool& pool;
+
+    public:
+        SabreRouter(const CouplingMap& coupling, SabreOptions options = {},
+                    ThreadPool& pool = ThreadPool::shared())
+            : coupling(coupling), options(options), pool(pool) {}
+
+        RoutingResult route(const Circuit& circuit) const {
+            return route(circuit, Layout::trivial(coupling.size()));
+        }
+
+        RoutingResult route(const Circuit& circuit, const Layout& initial) const {
+            return route(circuit, initial, DependencyDag(circuit));
+        }
+
+        // Same, from the circuit's dependency DAG built beforehand
+        RoutingResult route(const Circuit& circuit, const Layout& initial, const DependencyDag& dag) const {
+            check(circuit, initial);
+
+            uint32_t num_trials = std::max<uint32_t>(options.trials, 1);
+            std::vector<Trial> trials(num_trials);
+            pool.parallel_for(num_trials, 1, [&](size_t, size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) {
+                    run_trial(circuit, dag, initial, static_cast<uint32_t>(t), trials[t]);
+                }
+            });
+
+            uint32_t best = 0;
+            for (uint32_t t = 1; t < num_trials; ++t) {
+                if (trials[t].swaps < trials[best].swaps) {
+                    best = t;
+                }
+            }
+
+            RoutingResult result;
+            result.circuit = emit(circuit, trials[best]);
+            result.initial_layout = std::move(trials[best].initial);
+            result.final_layout = std::move(trials[best].final);
+            result.swaps = trials[best].swaps;
+            result.trial = best;
+            return result;
+        }
+
+    private:
+        void check(const Circuit& circuit, const Layout& initial) const {
+            if (circuit.get_num_qubits() > coupling.size()) {
+                throw std::runtime_error("Circuit needs " + std::to_string(circuit.get_num_qubits()) +
+                                         " qubits, coupling map has " + std::to_string(coupling.size()));
+            }
+            if (initial.size() != coupling.size()) {
+                throw std::invalid_argument("Initial layout does not match the coupling map");
+            }
+            if (!coupling.is_connected()) {
+                throw std::runtime_error("Coupling map is not connected");
+            }
+            for (const auto& op : circuit.get_operations()) {
+                if (op.num_qubits > 2 && op.code != OpCode::BARRIER) {
+                    throw std::runtime_error(std::string("Cannot route '") + circuit.name(op) +
+                                             "' on more than two qubits, decompose it first");
+                }
+            }
+        }
+
+        void run_trial(const Circuit& circuit, const DependencyDag& dag, const Layout& initial,
+                       uint32_t trial, Trial& result) const {
+            std::mt19937_64 rng(options.seed + trial);
+            Layout layout = initial;
+            if (trial > 0) {
+                std::vector<uint32_t> physical = initial.to_physical;
+                std::shuffle(physical.begin(), physical.end(), rng);
+                layout = Layout::from_physical(std::move(physical));
+            }
+            for (uint32_t i = 0; i < options.refinements; ++i) {
+                Pass(*this, circuit, dag, false, layout, rng, nullptr).run();
+                Pass(*this, circuit, dag, true, layout, rng, nullptr).run();
+            }
+            result.initial = layout;
+            result.swaps = Pass(*this, circuit, dag, false, layout, rng, &result.steps).run();
+            result.final = std::move(layout);
+        }
+
+        Circuit emit(const Circuit& circuit, const Trial& trial) const {
+            Circuit routed;
+            routed.add_qreg("q", coupling.size());
+            for (const auto& reg : circuit.get_cregs()) {
+                routed.add_creg(reg.name, reg.size);
+            }
+            for (const auto& gate : circuit.get_gates()) {
+                routed.add_gate(gate.name, gate.num_params, gate.num_qubits, gate.definition);
+            }
+            routed.reserve(trial.steps.size(), 2 * trial.steps.size(), circuit.size());
+
+            Layout layout = trial.initial;
+            std::vector<uint32_t> qubits;
+            for (const Step& step : trial.steps) {
+                if (step.op == NONE) {
+                    routed.add(OpCode::SWAP, {step.a, step.b});
+                    layout.swap_physical(step.a, step.b);
+                    continue;
+                }
+                const Operation& op = circuit[step.op];
+                qubits.clear();
+                for (uint32_t q : circuit.qubits(op)) {
+                    qubits.push_back(layout.to_physical[q]);
+                }
+                auto params = circuit.params(op);
+                auto clbits = circuit.clbits(op);
+                routed.add(op.code, qubits.data(), qubits.size(), params.data, params.size(),
+                           clbits.data, clbits.size(), op.gate);
+            }
+            return routed;
+        }
+
+        // One routing pass over the DAG, forward or backward
+        class Pass {
+        private:
+            const SabreRouter& router;
+            const CouplingMap& coupling;
+            const Circuit& circuit;
+            const DependencyDag& dag;
+            bool reverse;
+            Layout& layout;
+            std::mt19937_64& rng;
+            std::vector<Step>* steps;
+
+            std::vector<uint32_t> remaining;
+            std::vector<uint32_t> front;
+            std::vector<uint32_t> blocked;
+            std::vector<uint32_t> extended;
+            std::vector<uint32_t> queue;
+            std::vector<uint32_t> seen;         // extended set stamp per operation
+            Links front_links;
+            Links extended_links;
+            std::vector<std::pair<uint32_t, uint32_t>> candidates;
+            std::vector<std::pair<uint32_t, uint32_t>> ties;
+            uint32_t stamp = 0;
+            std::vector<double> decay;
+            size_t swaps = 0;
+
+        public:
+            Pass(const SabreRouter& router, const Circuit& circuit, const DependencyDag& dag, bool reverse,
+                 Layout& layout, std::mt19937_64& rng, std::vector<Step>* steps)
+                : router(router), coupling(router.coupling), circuit(circuit), dag(dag), reverse(reverse),
+                  layout(layout), rng(rng), steps(steps) {}
+
+            // Returns the number of swaps inserted
+            size_t run() {
+                size_t n = circuit.size();
+                remaining.resize(n);
+                seen.assign(n, 0);
+                for (uint32_t v = 0; v < n; ++v) {
+                    remaining[v] = reverse ? dag.out_degree(v) : dag.in_degree(v);
+                    if (remaining[v] == 0) {
+                        front.push_back(v);
+                    }
+                }
+                if (reverse) {
+                    std::reverse(front.begin(), front.end());
+                }
+                if (steps) {
+                    steps->reserve(n);
+                }
+                decay.assign(coupling.size(), 1.0);
+                front_links.head.assign(coupling.size(), NONE);
+                extended_links.head.assign(coupling.size(), NONE);
+
+                const size_t stall_limit = 10 * size_t(coupling.size());
+                size_t stalled = 0;
+                while (!front.empty()) {
+                    if (execute_front()) {
+                        std::fill(decay.begin(), decay.end(), 1.0);
+                        stalled = 0;
+                        continue;
+                    }
+                    if (++stalled > stall_limit) {
+                        route_closest();
+                        stalled = 0;
+                        continue;
+                    }
+                    auto [a, b] = choose_swap();
+                    swap(a, b);
+                    decay[a] += router.options.decay_increment;
+                    decay[b] += router.options.decay_increment;
+                    if (swaps % router.options.decay_reset == 0) {
+                        std::fill(decay.begin(), decay.end(), 1.0);
+                    }
+                }
+                return swaps;
+            }
+
+        private:
+            Span<const uint32_t> next(uint32_t v) const {
+                return reverse ? dag.predecessors(v) : dag.successors(v);
+            }
+
+            bool is_routed(const Operation& op) const {
+                return op.num_qubits == 2 && op.code != OpCode::BARRIER;
+            }
+
+            uint32_t physical(uint32_t v, uint32_t k) const {
+                return layout.to_physical[circuit.qubits(circuit[v])[k]];
+            }
+
+            bool executable(uint32_t v) const {
+                return !is_routed(circuit[v]) || coupling.adjacent(physical(v, 0), physical(v, 1));
+            }
+
+            // Emits every executable operation in or unlocked by the front
+            bool execute_front() {
+                blocked.clear();
+                size_t executed = 0;
+                for (size_t i = 0; i < front.size(); ++i) {
+                    uint32_t v = front[i];
+                    if (!executable(v)) {
+                        blocked.push_back(v);
+                        continue;
+                    }
+                    ++executed;
+                    if (steps) {
+                        steps->push_back(Step{v, 0, 0});
+                    }
+                    for (uint32_t u : next(v)) {
+                        if (--remaining[u] == 0) {
+                            front.push_back(u);
+                        }
+                    }
+                }
+                front.swap(blocked);
+                return executed > 0;
+            }
+
+            std::pair<uint32_t, uint32_t> choose_swap() {
+                collect_extended();
+                Partners front_partners = link(front, front_links);
+                Partners extended_partners = link(extended, extended_links);
+
+                candidates.clear();
+                for (uint32_t v : front) {
+                    if (!is_routed(circuit[v])) {
+                        continue;
+                    }
+                    for (uint32_t k = 0; k < 2; ++k) {
+                        uint32_t p = physical(v, k);
+                        for (uint32_t neighbor : coupling.neighbors(p)) {
+                            // An edge between two front qubits is seen from both ends
+                            if (neighbor > p || front_links.head[neighbor] == NONE) {
+                                candidates.emplace_back(p, neighbor);
+                            }
+                        }
+                    }
+                }
+
+                double best = std::numeric_limits<double>::infinity();
+                ties.clear();
+                for (const auto& [a, b] : candidates) {
+                    double score = std::max(decay[a], decay[b]) *
+                                   (front_partners.mean_after(a, b, coupling, front_links) +
+                                    router.options.extended_weight *
+                                    extended_partners.mean_after(a, b, coupling, extended_links));
+                    if (score < best - 1e-12) {
+                        best = score;
+                        ties.clear();
+                    }
+                    if (score <= best + 1e-12) {
+                        ties.emplace_back(a, b);
+                    }
+                }
+                unlink(front_links);
+                unlink(extended_links);
+                return ties[rng() % ties.size()];
+            }
+
+            // Links the routed operations in `ops` to their physical qubits
+            Partners link(const std::vector<uint32_t>& ops, Links& links) const {
+                Partners partners;
+                for (uint32_t v : ops) {
+                    if (!is_routed(circuit[v])) {
+                        continue;
+                    }
+                    uint32_t p = physical(v, 0), q = physical(v, 1);
+                    links.add(p, q);
+                    links.add(q, p);
+                    partners.total += coupling.distance(p, q);
+                    ++partners.count;
+                }
+                return partners;
+            }
+
+            static void unlink(Links& links) {
+                for (const auto& entry : links.entries) {
+                    links.head[entry.qubit] = NONE;
+                }
+                links.entries.clear();
+            }
+
+            // Next two-qubit operations after the front, breadth first
+            void collect_extended() {
+                extended.clear();
+                ++stamp;
+                queue.assign(front.begin(), front.end());
+                for (size_t head = 0; head < queue.size() && extended.size() < router.options.extended_size; ++head) {
+                    for (uint32_t u : next(queue[head])) {
+                        if (seen[u] == stamp) {
+                            continue;
+                        }
+                        seen[u] = stamp;
+                        queue.push_back(u);
+                        if (is_routed(circuit[u])) {
+                            extended.push_back(u);
+                            if (extended.size() == router.options.extended_size) {
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            void swap(uint32_t a, uint32_t b) {
+                layout.swap_physical(a, b);
+                if (steps) {
+                    steps->push_back(Step{NONE, a, b});
+                }
+                ++swaps;
+            }
+
+            // Moves the closest blocked gate's qubits together along a shortest path
+            void route_closest() {
+                uint32_t target = front[0];
+                for (uint32_t v : front) {
+                    if (is_routed(circuit[v]) &&
+                        (!is_routed(circuit[target]) ||
+                         coupling.distance(physical(v, 0), physical(v, 1)) <
+                         coupling.distance(physical(target, 0), physical(target, 1)))) {
+                        target = v;
+                    }
+                }
+                uint32_t p = physical(target, 0), q = physical(target, 1);
+                while (coupling.distance(p, q) > 1) {
+                    for (uint32_t neighbor : coupling.neighbors(p)) {
+                        if (coupling.distance(neighbor, q) < coupling.distance(p, q)) {
+                            swap(p, neighbor);
+                            p = neighbor;
+                            break;
+                        }
+                    }
+                }
+            }
+        };
+    };
+
+}; // namespace qarser
@@ -0,0 +1,175 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "IR/matrix.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Fuses every maximal run of single-qubit gates into one U.
+     *
+     * Runs are collected per qubit in one sweep and then multiplied in
+     * batches: the accumulators of a batch are kept as separate real and
+     * imaginary arrays per matrix entry, so each step of the product is a
+     * plain loop over the batch that the compiler vectorizes. A run is
+     * replaced by a single U at the position of its last gate, or removed
+     * when its product is the identity up to global phase within the
+     * tolerance. Single gates are only touched if they are the identity.
+     */
+    class SingleQubitFusion {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        static constexpr size_t BATCH = 64;
+
+        double tolerance;
+
+        std::vector<uint32_t> run_of;           // operation -> run, NONE if not fused
+        std::vector<uint32_t> run_ops;          // operations of all runs, run by run
+        std::vector<uint32_t> run_offsets;
+        std::vector<Matrix2> products;
+
+    public:
+        explicit SingleQubitFusion(double tolerance = 1e-9)
+            : tolerance(tolerance) {}
+
+        void set_tolerance(double value) {
+            tolerance = value;
+        }
+
+        // Returns the number of operations removed
+        size_t run(Circuit& circuit) {
+            collect_runs(circuit);
+            multiply_runs(circuit);
+
+            size_t num_runs = run_offsets.size() - 1;
+            std::vector<uint8_t> replace(num_runs, 0);
+            std::vector<uint32_t> emit_at(num_runs);
+            for (uint32_t r = 0; r < num_runs; ++r) {
+                uint32_t length = run_offsets[r + 1] - run_offsets[r];
+                emit_at[r] = run_ops[run_offsets[r + 1] - 1];
+                bool identity = is_identity_up_to_phase(products[r], tolerance);
+                replace[r] = identity ? 2 : (length > 1 ? 1 : 0);
+            }
+
+            Circuit result = circuit.without_operations();
+            result.reserve(circuit.size(), circuit.size() * 2, circuit.size());
+            for (uint32_t v = 0; v < circuit.size(); ++v) {
+                const Operation& op = circuit[v];
+                uint32_t r = run_of[v];
+                if (r == NONE || replace[r] == 0) {
+                    result.append(circuit, op);
+                    continue;
+                }
+                if (replace[r] == 1 && emit_at[r] == v) {
+                    EulerAngles angles = zyz_angles(products[r]);
+                    uint32_t qubit = circuit.qubits(op)[0];
+                    result.add(OpCode::U, &qubit, 1, &angles.theta, 3);
+                }
+            }
+            size_t removed = circuit.size() - result.size();
+            circuit = std::move(result);
+            return removed;
+        }
+
+    private:
+        void collect_runs(const Circuit& circuit) {
+            size_t n = circuit.size();
+            run_of.assign(n, NONE);
+            run_ops.clear();
+            run_offsets.assign(1, 0);
+
+            // Open run per qubit, as a list of operations
+            std::vector<std::vector<uint32_t>> open(circuit.get_num_qubits());
+            auto close = [&](uint32_t qubit) {
+                auto& ops = open[qubit];
+                if (ops.empty()) return;
+                uint32_t r = static_cast<uint32_t>(run_offsets.size() - 1);
+                for (uint32_t v : ops) run_of[v] = r;
+                run_ops.insert(run_ops.end(), ops.begin(), ops.end());
+                run_offsets.push_back(static_cast<uint32_t>(run_ops.size()));
+                ops.clear();
+            };
+
+            for (uint32_t v = 0; v < n; ++v) {
+                const Operation& op = circuit[v];
+                auto qubits = circuit.qubits(op);
+                if (op.num_qubits == 1 && op.num_clbits == 0 && has_single_qubit_matrix(op.code)) {
+                    open[qubits[0]].push_back(v);
+                    continue;
+                }
+                for (uint32_t q : qubits) close(q);
+            }
+            for (uint32_t q = 0; q < open.size(); ++q) close(q);
+        }
+
+        // products[r] = matrix of the last gate * ... * matrix of the first gate
+        void multiply_runs(const Circuit& circuit) {
+            size_t num_runs = run_offsets.size() - 1;
+            products.resize(num_runs);
+
+            // Structure of arrays: entry k of lane i is at [k][i]
+            double acc_re[4][BATCH], acc_im[4][BATCH];
+            double gate_re[4][BATCH], gate_im[4][BATCH];
+            for (size_t first = 0; first < num_runs; first += BATCH) {
+                size_t lanes = std::min(BATCH, num_runs - first);
+                uint32_t longest = 0;
+                for (size_t i = 0; i < BATCH; ++i) {
+                    acc_re[0][i] = acc_re[3][i] = 1.0;
+                    acc_re[1][i] = acc_re[2][i] = 0.0;
+                    for (int k = 0; k < 4; ++k) acc_im[k][i] = 0.0;
+                    if (i < lanes) {
+                        longest = std::max(longest, run_offsets[first + i + 1] - run_offsets[first + i]);
+                    }
+                }
+
+                for (uint32_t step = 0; step < longest; ++step) {
+                    for (size_t i = 0; i < BATCH; ++i) {
+                        Matrix2 m = Matrix2::identity();
+                        if (i < lanes && run_offsets[first + i] + step < run_offsets[first + i + 1]) {
+                            const Operation& op = circuit[run_ops[run_offsets[first + i] + step]];
+                            single_qubit_matrix(op.code, circuit.params(op).data, m);
+                        }
+                        const Complex entries[4] = {m.a, m.b, m.c, m.d};
+                        for (int k = 0; k < 4; ++k) {
+                            gate_re[k][i] = entries[k].real();
+                            gate_im[k][i] = entries[k].imag();
+                        }
+                    }
+                    multiply_batch(gate_re, gate_im, acc_re, acc_im);
+                }
+
+                for (size_t i = 0; i < lanes; ++i) {
+                    products[first + i] = {{acc_re[0][i], acc_im[0][i]}, {acc_re[1][i], acc_im[1][i]},
+                                           {acc_re[2][i], acc_im[2][i]}, {acc_re[3][i], acc_im[3][i]}};
+                }
+            }
+        }
+
+        // acc = gate * acc for every lane
+        static void multiply_batch(const double (&g_re)[4][BATCH], const double (&g_im)[4][BATCH],
+                                   double (&a_re)[4][BATCH], double (&a_im)[4][BATCH]) {
+            for (size_t i = 0; i < BATCH; ++i) {
+                double r[4], m[4];
+                for (int row = 0; row < 2; ++row) {
+                    for (int col = 0; col < 2; ++col) {
+                        int x = row * 2, y = row * 2 + 1;
+                        int p = col, q = 2 + col;
+                        r[row * 2 + col] = g_re[x][i] * a_re[p][i] - g_im[x][i] * a_im[p][i]
+                                         + g_re[y][i] * a_re[q][i] - g_im[y][i] * a_im[q][i];
+                        m[row * 2 + col] = g_re[x][i] * a_im[p][i] + g_im[x][i] * a_re[p][i]
+                                         + g_re[y][i] * a_im[q][i] + g_im[y][i] * a_re[q][i];
+                    }
+                }
+                for (int k = 0; k < 4; ++k) {
+                    a_re[k][i] = r[k];
+                    a_im[k][i] = m[k];
+                }
+            }
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,518 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "IR/circuit.hpp"
+#include "IR/coupling_map.hpp"
+#include "utils/thread_pool.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Logical qubits of a circuit, linked by how many two-qubit gates they share.
+     */
+    class InteractionGraph {
+    public:
+        struct Neighbor {
+            uint32_t qubit;
+            uint32_t weight;
+        };
+
+    private:
+        uint32_t num_qubits = 0;
+        uint64_t total_weight = 0;
+        std::vector<uint32_t> offsets;
+        std::vector<Neighbor> neighbor_list;
+        std::vector<uint64_t> weights;          // qubit -> gates it shares with others
+
+    public:
+        explicit InteractionGraph(const Circuit& circuit)
+            : num_qubits(circuit.get_num_qubits()), offsets(circuit.get_num_qubits() + 1, 0),
+              weights(circuit.get_num_qubits(), 0) {
+            std::unordered_map<uint64_t, uint32_t> counts;
+            for (const auto& op : circuit.get_operations()) {
+                if (op.num_qubits != 2 || op.code == OpCode::BARRIER) {
+                    continue;
+                }
+                auto qubits = circuit.qubits(op);
+                uint32_t a = std::min(qubits[0], qubits[1]), b = std::max(qubits[0], qubits[1]);
+                ++counts[(uint64_t(a) << 32) | b];
+            }
+
+            std::vector<std::pair<uint64_t, uint32_t>> pairs(counts.begin(), counts.end());
+            std::sort(pairs.begin(), pairs.end());
+            for (const auto& [key, weight] : pairs) {
+                ++offsets[(key >> 32) + 1];
+                ++offsets[(key & 0xffffffffu) + 1];
+            }
+            for (uint32_t q = 0; q < num_qubits; ++q) {
+                offsets[q + 1] += offsets[q];
+            }
+            neighbor_list.resize(offsets[num_qubits]);
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (const auto& [key, weight] : pairs) {
+                uint32_t a = static_cast<uint32_t>(key >> 32), b = static_cast<uint32_t>(key & 0xffffffffu);
+                neighbor_list[fill[a]++] = Neighbor{b, weight};
+                neighbor_list[fill[b]++] = Neighbor{a, weight};
+                weights[a] += weight;
+                weights[b] += weight;
+                total_weight += weight;
+            }
+        }
+
+        uint32_t size() const {
+            return num_qubits;
+        }
+
+        Span<const Neighbor> neighbors(uint32_t qubit) const {
+            return {neighbor_list.data() + offsets[qubit], offsets[qubit + 1] - offsets[qubit]};
+        }
+
+        uint32_t degree(uint32_t qubit) const {
+            return offsets[qubit + 1] - offsets[qubit];
+        }
+
+        uint64_t weight(uint32_t qubit) const {
+            return weights[qubit];
+        }
+
+        // Two-qubit gates in the circuit
+        uint64_t get_total_weight() const {
+            return total_weight;
+        }
+
+        // Heap memory held by the adjacency arrays
+        size_t memory_bytes() const {
+            return offsets.capacity() * sizeof(uint32_t) + neighbor_list.capacity() * sizeof(Neighbor) +
+                   weights.capacity() * sizeof(uint64_t);
+        }
+    };
+
+
+    struct LayoutOptions {
+        uint64_t seed = 0;
+        uint32_t max_candidates = 8;                // layouts scored, also the roots searched at once
+        size_t max_states = 100000;                 // search states per root physical qubit
+        std::chrono::milliseconds time_limit{0};    // wall-clock cap on the search, 0 for none
+    };
+
+
+    struct LayoutResult {
+        Layout layout;
+        bool perfect = false;           // every interacting pair is adjacent
+        uint64_t score = 0;             // sum of gate counts times distance
+        uint32_t candidates = 0;        // layouts that were scored
+    };
+
+
+    /**
+     * @brief Initial layout from the circuit's interaction graph.
+     *
+     * First looks for a perfect layout, a subgraph monomorphism of the
+     * interaction graph into the coupling map, with a VF2-style search:
+     * logical qubits are matched in breadth-first order, each one against
+     * the free neighbours of an already placed partner. A physical qubit
+     * is pruned when it is not adjacent to every placed partner, has fewer
+     * free neighbours than the logical qubit has partners left to place,
+     * or would leave a placed neighbour short of room for its own; the
+     * rest are tried with the most free neighbours first. The search is
+     * split by the physical qubit of the first logical qubit; roots are
+     * tried in batches of `max_candidates` on the thread pool, each with
+     * its own state budget, until a batch finds a layout.
+     *
+     * Without a perfect layout, greedy placements are grown from several
+     * start qubits: the logical qubit sharing the most gates with those
+     * already placed goes to the free physical qubit minimizing the gate
+     * weighted distance to them. Placements need distances between every
+     * pair, so a disconnected coupling map only supports perfect layouts.
+     *
+     * Candidates are scored in parallel by the sum over interacting pairs
+     * of gate count times distance, ties going to the earlier candidate.
+     * Root and start orders come from the seed, so the result only depends
+     * on it, unless `time_limit` cuts the search short.
+     */
+    class VF2Layout {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        const CouplingMap& coupling;
+        LayoutOptions options;
+        ThreadPool& pool;
+
+        // Matching order of the interacting logical qubits
+        struct Order {
+            std::vector<uint32_t> qubits;
+            std::vector<uint32_t> anchor;       // earlier neighbour to extend from, NONE for a new component
+            std::vector<uint32_t> offsets;      // earlier neighbours of qubits[i] in placed
+            std::vector<uint32_t> placed;
+        };
+
+    public:
+        VF2Layout(const CouplingMap& coupling, LayoutOptions options = {},
+                  ThreadPool& pool = ThreadPool::shared())
+            : coupling(coupling), options(options), pool(pool) {}
+
+        LayoutResult run(const Circuit& circuit) const {
+            return run(circuit, InteractionGraph(circuit));
+        }
+
+        // Same, from the circuit's interaction graph built beforehand
+        LayoutResult run(const Circuit& circuit, const InteractionGraph& graph) const {
+            if (circuit.get_num_qubits() > coupling.size()) {
+                throw std::runtime_error("Circuit needs " + std::to_string(circuit.get_num_qubits()) +
+                                         " qubits, coupling map has " + std::to_string(coupling.size()));
+            }
+            std::mt19937_64 rng(options.seed);
+            std::vector<uint32_t> physical_order = shuffled_by_degree(rng);
+
+            LayoutResult result;
+            std::vector<std::vector<uint32_t>> candidates = search(graph, physical_order);
+            result.perfect = !candidates.empty();
+            if (candidates.empty()) {
+                if (!coupling.is_connected()) {
+                    throw std::runtime_error("Coupling map is not connected and has no perfect layout");
+                }
+                candidates = greedy(graph, physical_order);
+            }
+
+            std::vector<uint64_t> scores(candidates.size());
+            pool.parallel_for(candidates.size(), 1, [&](size_t, size_t begin, size_t end) {
+                for (size_t c = begin; c < end; ++c) {
+                    scores[c] = score(graph, candidates[c]);
+                }
+            });
+            size_t best = std::min_element(scores.begin(), scores.end()) - scores.begin();
+
+            result.layout = complete(std::move(candidates[best]));
+            result.score = scores[best];
+            result.candidates = static_cast<uint32_t>(candidates.size());
+            return result;
+        }
+
+        // Sum over interacting pairs of gate count times distance, the maximum if a pair is unreachable
+        uint64_t score(const InteractionGraph& graph, const std::vector<uint32_t>& to_physical) const {
+            uint64_t total = 0;
+            for (uint32_t a = 0; a < graph.size(); ++a) {
+                for (const auto& neighbor : graph.neighbors(a)) {
+                    if (a < neighbor.qubit) {
+                        uint32_t distance = coupling.distance(to_physical[a], to_physical[neighbor.qubit]);
+                        if (distance == CouplingMap::UNREACHABLE) {
+                            return std::numeric_limits<uint64_t>::max();
+                        }
+                        total += uint64_t(neighbor.weight) * distance;
+                    }
+                }
+            }
+            return total;
+        }
+
+    private:
+        // Physical qubits by decreasing degree, equal degrees in seeded order
+        std::vector<uint32_t> shuffled_by_degree(std::mt19937_64& rng) const {
+            std::vector<uint32_t> order(coupling.size());
+            for (uint32_t p = 0; p < coupling.size(); ++p) {
+                order[p] = p;
+            }
+            std::shuffle(order.begin(), order.end(), rng);
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return coupling.degree(a) > coupling.degree(b);
+            });
+            return order;
+        }
+
+        /**
+         * @brief Breadth-first order over the interacting qubits.
+         *
+         * The next qubit is the one with the most placed neighbours, then
+         * the one whose neighbours were placed earliest, then the highest
+         * degree, so constrained qubits are matched early and the order
+         * grows level by level; a new component starts from its highest
+         * degree qubit.
+         */
+        static Order matching_order(const InteractionGraph& graph) {
+            Order order;
+            uint32_t n = graph.size();
+            std::vector<uint32_t> placed_neighbors(n, 0);
+            std::vector<uint32_t> last_placed(n, 0);        // 1 + position of the latest placed neighbour
+            std::vector<bool> done(n, false);
+            std::vector<uint32_t> position(n, NONE);
+            order.offsets.push_back(0);
+            while (true) {
+                uint32_t next = NONE;
+                for (uint32_t q = 0; q < n; ++q) {
+                    if (done[q] || graph.degree(q) == 0) {
+                        continue;
+                    }
+                    if (next == NONE || placed_neighbors[q] > placed_neighbors[next] ||
+                        (placed_neighbors[q] == placed_neighbors[next] &&
+                         (last_placed[q] < last_placed[next] ||
+                          (last_placed[q] == last_placed[next] && graph.degree(q) > graph.degree(next))))) {
+                        next = q;
+                    }
+                }
+                if (next == NONE) {
+                    break;
+                }
+                done[next] = true;
+                position[next] = static_cast<uint32_t>(order.qubits.size());
+                uint32_t anchor = NONE;
+                for (const auto& neighbor : graph.neighbors(next)) {
+                    ++placed_neighbors[neighbor.qubit];
+                    last_placed[neighbor.qubit] = static_cast<uint32_t>(order.qubits.size()) + 1;
+                    if (position[neighbor.qubit] == NONE) {
+                        continue;
+                    }
+                    order.placed.push_back(neighbor.qubit);
+                    // Extend from the partner with the fewest physical choices
+                    if (anchor == NONE || graph.degree(neighbor.qubit) < graph.degree(anchor)) {
+                        anchor = neighbor.qubit;
+                    }
+                }
+                order.qubits.push_back(next);
+                order.anchor.push_back(anchor);
+                order.offsets.push_back(static_cast<uint32_t>(order.placed.size()));
+            }
+            return order;
+        }
+
+        // Perfect layouts, at most one per root and from the first batch of roots finding any
+        std::vector<std::vector<uint32_t>> search(const InteractionGraph& graph,
+                                                  const std::vector<uint32_t>& physical_order) const {
+            Order order = matching_order(graph);
+            std::vector<std::vector<uint32_t>> found;
+            if (order.qubits.empty()) {
+                found.emplace_back(graph.size(), NONE);
+                return found;
+            }
+
+            std::vector<uint32_t> roots;
+            for (uint32_t p : physical_order) {
+                if (coupling.degree(p) >= graph.degree(order.qubits[0])) {
+                    roots.push_back(p);
+                }
+            }
+            auto deadline = std::chrono::steady_clock::now() + options.time_limit;
+            size_t batch = std::max<size_t>(options.max_candidates, 1);
+            for (size_t first = 0; first < roots.size() && found.empty(); first += batch) {
+                size_t count = std::min(batch, roots.size() - first);
+                std::vector<std::vector<uint32_t>> results(count);
+                pool.parallel_for(count, 1, [&](size_t, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        results[i] = match(graph, order, physical_order, roots[first + i], deadline);
+                    }
+                });
+                for (auto& result : results) {
+                    if (!result.empty()) {
+                        found.push_back(std::move(result));
+                    }
+                }
+                if (options.time_limit.count() > 0 && std::chrono::steady_clock::now() >= deadline) {
+                    break;
+                }
+            }
+            return found;
+        }
+
+        // Depth-first matching with the first qubit of the order on `root`, empty if none
+        std::vector<uint32_t> match(const InteractionGraph& graph, const Order& order,
+                                    const std::vector<uint32_t>& physical_order, uint32_t root,
+                                    std::chrono::steady_clock::time_point deadline) const {
+            size_t depth_count = order.qubits.size();
+            std::vector<uint32_t> to_physical(graph.size(), NONE);
+            std::vector<uint32_t> to_logical(coupling.size(), NONE);
+            std::vector<std::vector<uint32_t>> feasible_choices(depth_count);
+            std::vector<uint32_t> next_choice(depth_count, 0);     // choice to try next per depth
+            std::vector<uint32_t> unplaced(graph.size());           // logical -> neighbours still to place
+            std::vector<uint32_t> free(coupling.size());            // physical -> free neighbours
+            for (uint32_t q = 0; q < graph.size(); ++q) {
+                unplaced[q] = graph.degree(q);
+            }
+            for (uint32_t p = 0; p < coupling.size(); ++p) {
+                free[p] = coupling.degree(p);
+            }
+
+            auto candidates = [&](size_t depth) -> Span<const uint32_t> {
+                if (depth == 0) {
+                    return {&root, 1};
+                }
+                uint32_t anchor = order.anchor[depth];
+                if (anchor == NONE) {
+                    return {physical_order.data(), physical_order.size()};
+                }
+                return coupling.neighbors(to_physical[anchor]);
+            };
+            auto is_placed_partner = [&](size_t depth, uint32_t logical) {
+                for (uint32_t i = order.offsets[depth]; i < order.offsets[depth + 1]; ++i) {
+                    if (order.placed[i] == logical) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+            // Look-ahead: p must keep room for the qubit's unplaced partners,
+            // and placed neighbours of p must keep room for theirs
+            auto feasible = [&](size_t depth, uint32_t p) {
+                uint32_t q = order.qubits[depth];
+                if (to_logical[p] != NONE || free[p] < unplaced[q]) {
+                    return false;
+                }
+                for (uint32_t i = order.offsets[depth]; i < order.offsets[depth + 1]; ++i) {
+                    if (!coupling.adjacent(p, to_physical[order.placed[i]])) {
+                        return false;
+                    }
+                }
+                for (uint32_t x : coupling.neighbors(p)) {
+                    uint32_t owner = to_logical[x];
+                    if (owner != NONE && !is_placed_partner(depth, owner) && free[x] < unplaced[owner] + 1) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            auto assign = [&](uint32_t q, uint32_t p, int step) {
+                to_physical[q] = step > 0 ? p : NONE;
+                to_logical[p] = step > 0 ? q : NONE;
+                for (uint32_t x : coupling.neighbors(p)) {
+                    free[x] -= step;
+                }
+                for (const auto& neighbor : graph.neighbors(q)) {
+                    unplaced[neighbor.qubit] -= step;
+                }
+            };
+
+            size_t depth = 0, states = 0;
+            while (true) {
+                if (++states > options.max_states ||
+                    (options.time_limit.count() > 0 && states % 1024 == 0 &&
+                     std::chrono::steady_clock::now() >= deadline)) {
+                    return {};
+                }
+                auto& choices = feasible_choices[depth];
+                if (next_choice[depth] == 0) {
+                    // Feasible qubits, those with the most room first
+                    choices.clear();
+                    for (uint32_t p : candidates(depth)) {
+                        if (feasible(depth, p)) {
+                            choices.push_back(p);
+                        }
+                    }
+                    std::stable_sort(choices.begin(), choices.end(), [&](uint32_t a, uint32_t b) {
+                        return free[a] > free[b];
+                    });
+                }
+                uint32_t chosen = NONE;
+                if (next_choice[depth] < choices.size()) {
+                    chosen = choices[next_choice[depth]++];
+                }
+                if (chosen == NONE) {
+                    // Backtrack
+                    next_choice[depth] = 0;
+                    if (depth == 0) {
+                        return {};
+                    }
+                    --depth;
+                    uint32_t q = order.qubits[depth];
+                    assign(q, to_physical[q], -1);
+                    continue;
+                }
+                assign(order.qubits[depth], chosen, 1);
+                if (++depth == depth_count) {
+                    return to_physical;
+                }
+            }
+        }
+
+        // Greedy placements grown from up to max_candidates start qubits
+        std::vector<std::vector<uint32_t>> greedy(const InteractionGraph& graph,
+                                                  const std::vector<uint32_t>& physical_order) const {
+            size_t count = std::min<size_t>(std::max<uint32_t>(options.max_candidates, 1), physical_order.size());
+            std::vector<std::vector<uint32_t>> placements(count);
+            pool.parallel_for(count, 1, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    placements[i] = grow(graph, physical_order[i]);
+                }
+            });
+            return placements;
+        }
+
+        std::vector<uint32_t> grow(const InteractionGraph& graph, uint32_t start) const {
+            uint32_t n = graph.size();
+            std::vector<uint32_t> to_physical(n, NONE);
+            std::vector<bool> used(coupling.size(), false);
+            std::vector<uint64_t> attraction(n, 0);     // gates shared with placed qubits
+
+            for (uint32_t placed = 0; placed < n; ++placed) {
+                uint32_t next = NONE;
+                for (uint32_t q = 0; q < n; ++q) {
+                    if (to_physical[q] != NONE || graph.degree(q) == 0) {
+                        continue;
+                    }
+                    if (next == NONE || attraction[q] > attraction[next] ||
+                        (attraction[q] == attraction[next] && graph.weight(q) > graph.weight(next))) {
+                        next = q;
+                    }
+                }
+                if (next == NONE) {
+                    break;
+                }
+
+                uint32_t best = NONE;
+                uint64_t best_cost = std::numeric_limits<uint64_t>::max();
+                for (uint32_t p = 0; p < coupling.size(); ++p) {
+                    if (used[p]) {
+                        continue;
+                    }
+                    uint64_t cost = 0;
+                    for (const auto& neighbor : graph.neighbors(next)) {
+                        uint32_t other = to_physical[neighbor.qubit];
+                        if (other != NONE) {
+                            cost += uint64_t(neighbor.weight) * coupling.distance(p, other);
+                        }
+                    }
+                    // Unattached qubits stay close to the start
+                    cost = cost * coupling.size() + coupling.distance(p, start);
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best = p;
+                    }
+                }
+                to_physical[next] = best;
+                used[best] = true;
+                for (const auto& neighbor : graph.neighbors(next)) {
+                    attraction[neighbor.qubit] += neighbor.weight;
+                }
+            }
+            return to_physical;
+        }
+
+        // Places idle logical qubits and ancillas on the free physical qubits
+        Layout complete(std::vector<uint32_t> to_physical) const {
+            std::vector<bool> used(coupling.size(), false);
+            for (uint32_t p : to_physical) {
+                if (p != NONE) {
+                    used[p] = true;
+                }
+            }
+            to_physical.resize(coupling.size(), NONE);
+            uint32_t free = 0;
+            for (auto& p : to_physical) {
+                if (p == NONE) {
+                    while (used[free]) {
+                        ++free;
+                    }
+                    p = free;
+                    used[free] = true;
+                }
+            }
+            return Layout::from_physical(std::move(to_physical));
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,220 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "circuit.hpp"
+#include "AST/gate.hpp"
+#include "AST/expression.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Writes a Circuit back as an OpenQASM 2.0 program.
+     *
+     * Registers keep their names, program gates are written out from
+     * their definitions (opaque when there is none) and parameters are
+     * printed in plain decimal notation with enough digits to read back
+     * the same double.
+     */
+    class QasmWriter : public BaseVisitor {
+    private:
+        std::ostream& out;
+        std::vector<std::string> qubit_names;
+        std::vector<std::string> clbit_names;
+
+    public:
+        explicit QasmWriter(std::ostream& out)
+            : out(out) {}
+
+        void write(const Circuit& circuit) {
+            out << "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n";
+            qubit_names = declare("qreg", circuit.get_qregs());
+            clbit_names = declare("creg", circuit.get_cregs());
+            for (const auto& gate : circuit.get_gates()) {
+                if (gate.definition) {
+                    write(*gate.definition);
+                }
+                else {
+                    out << "opaque " << gate.name << params_of(gate.num_params) << " "
+                        << qubits_of(gate.num_qubits) << ";\n";
+                }
+            }
+            for (const auto& op : circuit.get_operations()) {
+                write(circuit, op);
+            }
+        }
+
+        static std::string number(double value) {
+            char buffer[64];
+            for (int digits = 15; digits <= 17; ++digits) {
+                std::snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+                if (std::strtod(buffer, nullptr) == value) {
+                    break;
+                }
+            }
+            std::string text = buffer;
+            size_t exponent_at = text.find('e');
+            if (exponent_at == std::string::npos) {
+                return text;
+            }
+            // The lexer has no exponent notation, move the point instead
+            int exponent = std::atoi(text.c_str() + exponent_at + 1);
+            text.erase(exponent_at);
+            std::string sign;
+            if (text[0] == '-') {
+                sign = "-";
+                text.erase(0, 1);
+            }
+            std::string digits;
+            for (char c : text) {
+                if (c != '.') {
+                    digits += c;
+                }
+            }
+            if (exponent < 0) {
+                return sign + "0." + std::string(-exponent - 1, '0') + digits;
+            }
+            if (static_cast<size_t>(exponent) + 1 >= digits.size()) {
+                return sign + digits + std::string(exponent + 1 - digits.size(), '0');
+            }
+            return sign + digits.substr(0, exponent + 1) + "." + digits.substr(exponent + 1);
+        }
+
+        void visit(NumberExpr& expr) override {
+            out << number(expr.value);
+        }
+
+        void visit(IdentifierExpr& expr) override {
+            out << expr.name;
+        }
+
+        void visit(UnaryExpr& expr) override {
+            switch (expr.op) {
+                case UnaryExpr::Op::Neg: out << "-("; break;
+                case UnaryExpr::Op::Pos: out << "("; break;
+                case UnaryExpr::Op::Sin: out << "sin("; break;
+                case UnaryExpr::Op::Cos: out << "cos("; break;
+                case UnaryExpr::Op::Tan: out << "tan("; break;
+                case UnaryExpr::Op::Exp: out << "exp("; break;
+                case UnaryExpr::Op::Ln:  out << "ln("; break;
+            }
+            expr.operand->accept(*this);
+            out << ")";
+        }
+
+        void visit(BinaryExpr& expr) override {
+            out << "(";
+            expr.left->accept(*this);
+            switch (expr.op) {
+                case BinaryExpr::Op::Add: out << " + "; break;
+                case BinaryExpr::Op::Sub: out << " - "; break;
+                case BinaryExpr::Op::Mul: out << " * "; break;
+                case BinaryExpr::Op::Div: out << " / "; break;
+            }
+            expr.right->accept(*this);
+            out << ")";
+        }
+
+        void visit(Gate& gate) override {
+            out << "  " << gate.name;
+            if (!gate.params.empty()) {
+                out << "(";
+                for (size_t i = 0; i < gate.params.size(); ++i) {
+                    if (i > 0) out << ", ";
+                    gate.params[i]->accept(*this);
+                }
+                out << ")";
+            }
+            write_refs(gate.qubits);
+        }
+
+        void visit(Barrier& barrier) override {
+            out << "  barrier";
+            write_refs(barrier.qubits);
+        }
+
+    private:
+        std::vector<std::string> declare(const char* keyword, const std::vector<Circuit::Register>& registers) {
+            std::vector<std::string> names;
+            for (const auto& reg : registers) {
+                out << keyword << " " << reg.name << "[" << reg.size << "];\n";
+                for (uint32_t i = 0; i < reg.size; ++i) {
+                    names.push_back(reg.name + "[" + std::to_string(i) + "]");
+                }
+            }
+            return names;
+        }
+
+        void write(const GateDef& def) {
+            out << "gate " << def.name;
+            if (!def.params.empty()) {
+                out << "(";
+                for (size_t i = 0; i < def.params.size(); ++i) {
+                    out << (i > 0 ? "," : "") << def.params[i];
+                }
+                out << ")";
+            }
+            out << " ";
+            for (size_t i = 0; i < def.qubits.size(); ++i) {
+                out << (i > 0 ? "," : "") << def.qubits[i].name;
+            }
+            out << " {\n";
+            for (const auto& stmt : def.body) {
+                stmt->accept(*this);
+            }
+            out << "}\n";
+        }
+
+        void write(const Circuit& circuit, const Operation& op) {
+            auto qubits = circuit.qubits(op);
+            auto clbits = circuit.clbits(op);
+            if (op.code == OpCode::MEASURE) {
+                out << "measure " << qubit_names[qubits[0]] << " -> " << clbit_names[clbits[0]] << ";\n";
+                return;
+            }
+            out << circuit.name(op);
+            auto params = circuit.params(op);
+            if (!params.empty()) {
+                out << "(";
+                for (size_t i = 0; i < params.size(); ++i) {
+                    out << (i > 0 ? ", " : "") << number(params[i]);
+                }
+                out << ")";
+            }
+            for (size_t i = 0; i < qubits.size(); ++i) {
+                out << (i > 0 ? ", " : " ") << qubit_names[qubits[i]];
+            }
+            out << ";\n";
+        }
+
+        void write_refs(const std::vector<RegisterRef>& refs) {
+            for (size_t i = 0; i < refs.size(); ++i) {
+                out << (i > 0 ? ", " : " ") << refs[i].toString();
+            }
+            out << ";\n";
+        }
+
+        static std::string params_of(uint32_t count) {
+            if (count == 0) {
+                return "";
+            }
+            std::string text = "(";
+            for (uint32_t i = 0; i < count; ++i) {
+                text += (i > 0 ? ",p" : "p") + std::to_string(i);
+            }
+            return text + ")";
+        }
+
+        static std::string qubits_of(uint32_t count) {
+            std::string text;
+            for (uint32_t i = 0; i < count; ++i) {
+                text += (i > 0 ? ",a" : "a") + std::to_string(i);
+            }
+            return text;
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,203 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "circuit.hpp"
+#include "inliner.hpp"
+#include "SA/library/gate_library.hpp"
+
+
+namespace qarser {
+
+    struct Hash128 {
+        uint64_t low = 0;
+        uint64_t high = 0;
+
+        bool operator==(const Hash128& other) const {
+            return low == other.low && high == other.high;
+        }
+
+        bool operator!=(const Hash128& other) const {
+            return !(*this == other);
+        }
+
+        std::string to_string() const {
+            static constexpr char digits[] = "0123456789abcdef";
+            std::string text(32, '0');
+            for (int i = 0; i < 16; ++i) {
+                text[15 - i] = digits[(high >> (4 * i)) & 0xF];
+                text[31 - i] = digits[(low >> (4 * i)) & 0xF];
+            }
+            return text;
+        }
+    };
+
+
+    // Two independently mixed 64-bit lanes over a sequence of words
+    class Hash128Builder {
+    private:
+        Hash128 state;
+
+        static uint64_t mix(uint64_t x) {
+            x ^= x >> 30;
+            x *= 0xBF58476D1CE4E5B9ULL;
+            x ^= x >> 27;
+            x *= 0x94D049BB133111EBULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+    public:
+        explicit Hash128Builder(uint64_t domain = 0)
+            : state{mix(domain ^ 0x9E3779B97F4A7C15ULL), mix(domain ^ 0xC2B2AE3D27D4EB4FULL)} {}
+
+        Hash128Builder& add(uint64_t value) {
+            state.low = mix(state.low ^ (value + 0x9E3779B97F4A7C15ULL));
+            state.high = mix(state.high + value * 0xC2B2AE3D27D4EB4FULL + (state.low >> 17));
+            return *this;
+        }
+
+        Hash128Builder& add(const Hash128& value) {
+            return add(value.low).add(value.high);
+        }
+
+        Hash128Builder& add(double value) {
+            value = value == 0.0 ? 0.0 : value;     // -0.0 and 0.0 are the same angle
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return add(bits);
+        }
+
+        Hash128 get() const {
+            return state;
+        }
+    };
+
+
+    /**
+     * @brief Canonical 128-bit hash of a circuit's structure.
+     *
+     * Every operation is hashed from its opcode, parameters and the hashes
+     * of the operations that last touched each of its qubits and bits, so
+     * the hash of an operation covers its whole causal past, like a Merkle
+     * tree over the dependency DAG. Each output wire of an operation gets
+     * its own hash, derived from the operation's hash and the operand's
+     * position. The circuit's hash combines the register sizes and the
+     * final hash of every wire in index order. Reordering operations on
+     * disjoint wires never changes the DAG, so it never changes the hash.
+     *
+     * Names are left out: registers only contribute their sizes, and gates
+     * the program defines contribute their fully inlined expansion, so
+     * renaming either gives the same hash. Formatting and comments are gone
+     * by the time a program is lowered.
+     */
+    class StructuralHasher {
+    private:
+        enum Domain : uint64_t { CIRCUIT = 1, QUBIT, CLBIT, OPERATION, OUTPUT, GATE };
+
+        const GateLibrary& library;
+        std::vector<Hash128> wires;         // qubits, then clbits after them
+        std::vector<Hash128> gates;         // gate table index -> expansion hash
+
+    public:
+        explicit StructuralHasher(const GateLibrary& library)
+            : library(library) {}
+
+        Hash128 hash(const Circuit& circuit) {
+            uint32_t num_qubits = circuit.get_num_qubits();
+            uint32_t num_clbits = circuit.get_num_clbits();
+            wires.resize(num_qubits + num_clbits);
+            for (uint32_t q = 0; q < num_qubits; ++q) {
+                wires[q] = Hash128Builder(QUBIT).add(uint64_t{q}).get();
+            }
+            for (uint32_t c = 0; c < num_clbits; ++c) {
+                wires[num_qubits + c] = Hash128Builder(CLBIT).add(uint64_t{c}).get();
+            }
+            hash_gates(circuit);
+
+            for (const auto& op : circuit.get_operations()) {
+                Hash128Builder node(OPERATION);
+                node.add(static_cast<uint64_t>(op.code));
+                if (op.code == OpCode::GATE) {
+                    node.add(gates[op.gate]);
+                }
+                node.add(uint64_t{op.num_qubits}).add(uint64_t{op.num_clbits});
+                for (double param : circuit.params(op)) {
+                    node.add(param);
+                }
+                for (uint32_t q : circuit.qubits(op)) {
+                    node.add(wires[q]);
+                }
+                for (uint32_t c : circuit.clbits(op)) {
+                    node.add(wires[num_qubits + c]);
+                }
+
+                Hash128 value = node.get();
+                uint64_t position = 0;
+                for (uint32_t q : circuit.qubits(op)) {
+                    wires[q] = Hash128Builder(OUTPUT).add(value).add(position++).get();
+                }
+                for (uint32_t c : circuit.clbits(op)) {
+                    wires[num_qubits + c] = Hash128Builder(OUTPUT).add(value).add(position++).get();
+                }
+            }
+
+            Hash128Builder result(CIRCUIT);
+            result.add(uint64_t{num_qubits}).add(uint64_t{num_clbits});
+            for (const auto& reg : circuit.get_qregs()) {
+                result.add(uint64_t{reg.size});
+            }
+            result.add(uint64_t{circuit.get_qregs().size()});
+            for (const auto& reg : circuit.get_cregs()) {
+                result.add(uint64_t{reg.size});
+            }
+            result.add(uint64_t{circuit.get_cregs().size()});
+            for (const auto& wire : wires) {
+                result.add(wire);
+            }
+            return result.get();
+        }
+
+    private:
+        void hash_gates(const Circuit& circuit) {
+            Inliner inliner(library);       // definitions do not outlive their program
+            inliner.add_definitions(circuit);
+            gates.clear();
+            for (const auto& gate : circuit.get_gates()) {
+                Hash128Builder builder(GATE);
+                builder.add(uint64_t{gate.num_qubits}).add(uint64_t{gate.num_params});
+                if (gate.definition) {
+                    const ExpansionTemplate& expansion = inliner.compile(*gate.definition);
+                    for (const auto& op : expansion.ops) {
+                        builder.add(static_cast<uint64_t>(op.code)).add(uint64_t{op.num_qubits});
+                        for (uint32_t i = 0; i < op.num_qubits; ++i) {
+                            builder.add(uint64_t{expansion.qubit_slots[op.qubit_offset + i]});
+                        }
+                        for (uint32_t i = 0; i < op.num_params; ++i) {
+                            const auto& param = expansion.params[op.param_offset + i];
+                            builder.add(uint64_t{param.code_size});
+                            for (uint32_t k = 0; k < param.code_size; ++k) {
+                                const ParamInstr& instr = expansion.code[param.code_offset + k];
+                                builder.add(static_cast<uint64_t>(instr.op)).add(uint64_t{instr.slot}).add(instr.value);
+                            }
+                        }
+                    }
+                }
+                else {
+                    builder.add(std::hash<std::string>{}(gate.name));  // opaque, only its name identifies it
+                }
+                gates.push_back(builder.get());
+            }
+        }
+    };
+
+
+    struct Hash128Hasher {
+        size_t operator()(const Hash128& hash) const {
+            return static_cast<size_t>(hash.low ^ (hash.high * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+
+}; // namespace qarser
@@ -7,6 +7,8 @@
 #include "analyzers/declaration_analyzer.hpp"
 #include "analyzers/gate_usage_analyzer.hpp"
 #include "analyzers/gate_def_analyzer.hpp"
+#include "analyzers/qubit_usage_analyzer.hpp"
+#include "analyzers/gate_cost_analyzer.hpp"
 
 
 
@@ -23,40 +25,55 @@ namespace qarser {
 
     public:
         SemanticAnalyzer() {
-            init_builtins();
+            context.init_builtins();
             init_analyzers();
         }
 
 
         void analyze(Program& program) {
             for (const auto& stmt : program.statements) {
-                switch (stmt->kind()) {
-                    case Statement::Kind::QREG:
-                        stmt->accept(*declaration_analyzer);
-                        break;
-                    case Statement::Kind::CREG:
-                        stmt->accept(*declaration_analyzer);
-                        break;
-                    case Statement::Kind::GATE:
-                        stmt->accept(*gate_analyzer);
-                        break;
-                    case Statement::Kind::GATE_DEF:
-                        stmt->accept(*gate_def_analyzer);
-                        break;
-                   default:
-                        break;
+                if (context.get_errors().limit_reached()) {
+                    break;
                 }
+                analyze(*stmt);
             }
-            context.get_errors().report();
         }
 
-        
-    private:
-        void init_builtins() {
-            context.get_symbols().add_gate("U", 3, 1);
-            context.get_symbols().add_gate("CX", 0, 2);
+        void analyze(Statement& stmt) {
+            switch (stmt.kind()) {
+                case Statement::Kind::INCLUDE:
+                    stmt.accept(*declaration_analyzer);
+                    break;
+                case Statement::Kind::QREG:
+                    stmt.accept(*declaration_analyzer);
+                    break;
+                case Statement::Kind::CREG:
+                    stmt.accept(*declaration_analyzer);
+                    break;
+                case Statement::Kind::GATE:
+                case Statement::Kind::RESET:
+                case Statement::Kind::REPEAT:
+                    stmt.accept(*gate_analyzer);
+                    break;
+                case Statement::Kind::GATE_DEF:
+                    stmt.accept(*gate_def_analyzer);
+                    break;
+               default:
+                    break;
+            }
+        }
+
+        // Stop analyzing once `max_errors` diagnostics have been collected, 0 for no limit
+        void set_error_limit(size_t max_errors) {
+            context.get_errors().set_limit(max_errors);
         }
 
+        AnalysisContext& get_context() {
+            return context;
+        }
+
+        
+    private:
         void init_analyzers() {
             declaration_analyzer = std::make_unique<DeclarationAnalyzer>(context);
             gate_analyzer = std::make_unique<GateAnalyzer>(context);
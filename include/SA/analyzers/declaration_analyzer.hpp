@@ -10,23 +10,44 @@ namespace qarser {
             : BaseAnalyzer(context) {}
 
 
+        void visit(Include& include) override {
+            const GateLibrary* library = GateLibrary::find_include(include.filename);
+            if (!library) {
+                context.add_error(ErrorCode::INCLUDE_NOT_FOUND, include.line, include.filename);
+                return;
+            }
+
+            // Names declared before the include must not clash with its gates
+            bool clash = false;
+            context.get_symbols().for_each([&](const std::string& name, const Symbol&) {
+                if (library->get_symbols()->exists(name)) {
+                    context.add_error(ErrorCode::GATE_REDEFINITION, include.line, name);
+                    clash = true;
+                }
+            });
+            if (!clash) {
+                context.set_library(*library);
+            }
+        }
+
+
         void visit(QRegister& qreg) override {
             if (qreg.size <= 0) {
-                context.add_error(qreg.line, "Invalid quantum register size");
+                context.add_error(ErrorCode::INVALID_QREG_SIZE, qreg.line);
                 return;
             }
             if (!context.get_symbols().add_qreg(qreg.name, qreg.size)) {
-                context.add_error(qreg.line, "Redefinition of quantum register '" + qreg.name + "'");
+                context.add_error(ErrorCode::QREG_REDEFINITION, qreg.line, qreg.name);
             }
         }
 
         void visit(CRegister& creg) override {
             if (creg.size <= 0) {
-                context.add_error(creg.line, "Invalid classical register size");
+                context.add_error(ErrorCode::INVALID_CREG_SIZE, creg.line);
                 return;
             }
             if (!context.get_symbols().add_creg(creg.name, creg.size)) {
-                context.add_error(creg.line, "Redefinition of classical register '" + creg.name + "'");
+                context.add_error(ErrorCode::CREG_REDEFINITION, creg.line, creg.name);
             }
         }
     };
@@ -0,0 +1,520 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include "base_analyzer.hpp"
+#include "AST/gate.hpp"
+#include "AST/evaluator.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Primitive cost of a gate once fully expanded into U and CX.
+     */
+    struct GateCost {
+        uint64_t one_qubit = 0;         // U operations
+        uint64_t two_qubit = 0;         // CX operations
+        uint64_t depth = 0;             // upper bound on the primitive depth
+        uint64_t t_count = 0;           // U phases that are odd multiples of pi/4
+        bool t_count_exact = true;      // false if some phase depended on a non-constant parameter
+    };
+
+
+    /**
+     * @brief Computes expansion costs without expanding anything.
+     *
+     * The cost of each GateDef is derived once, when it is visited, from the
+     * costs of the gates its body calls. Like the semantic analyzer, a body
+     * or statement only sees definitions that come before it. The depth
+     * treats every callee as a block spanning all of its qubits, which
+     * makes it an upper bound. T-counts depend on parameter values and are
+     * memoized per (definition, constant arguments).
+     *
+     * Whole-program totals then take one step per statement (per broadcast
+     * element for the depth timeline). Run on a program that passed
+     * semantic analysis; statements it rejected are skipped.
+     *
+     * A repeat's counts are those of one iteration times its count. Its
+     * depth timeline is followed iteration by iteration; when nothing
+     * moves and an iteration raises every qubit it touches by the same
+     * amount, all later ones will too, and the rest is added at once.
+     * When every operand moves by the same stride, the body is reduced once
+     * to the longest path between each pair of its qubits, and later
+     * iterations only apply that table at their offset.
+     */
+    class GateCostAnalyzer : public BaseAnalyzer {
+    private:
+        struct TCount {
+            uint64_t count = 0;
+            bool exact = true;
+        };
+
+        std::unordered_map<std::string, const GateDef*> definitions;
+        std::unordered_map<const GateDef*, size_t> rank;       // visit order of the program's definitions
+        std::unordered_map<const GateDef*, GateCost> costs;
+        std::unordered_set<const GateDef*> in_progress;
+        std::unordered_map<std::string, TCount> t_counts;
+
+        std::unordered_map<std::string, size_t> qreg_offsets;
+        std::vector<uint64_t> levels;
+        GateCost total;
+
+        std::unordered_map<std::string, long long> shifts;     // register -> index offset of the current iteration
+        std::vector<size_t>* touched = nullptr;                // collects qubits whose level changes, if set
+
+        static constexpr double TOLERANCE = 1e-9;
+        static constexpr size_t MAX_SPAN_QUBITS = 64;           // largest body reduced to a path table
+        static constexpr int64_t NO_PATH = -1;
+
+    public:
+        GateCostAnalyzer(AnalysisContext& context)
+            : BaseAnalyzer(context) {}
+
+        void visit(Program& program) override {
+            for (const auto& stmt : program.statements) {
+                stmt->accept(*this);
+            }
+            for (uint64_t level : levels) {
+                total.depth = std::max(total.depth, level);
+            }
+        }
+
+        void visit(GateDef& def) override {
+            if (!definitions.emplace(def.name, &def).second) {
+                return;
+            }
+            rank.emplace(&def, rank.size());
+            cost_of_definition(def);
+        }
+
+        void visit(QRegister& qreg) override {
+            if (qreg_offsets.count(qreg.name) || !context.get_symbols().lookup_qreg(qreg.name)) {
+                return;
+            }
+            qreg_offsets.emplace(qreg.name, levels.size());
+            levels.resize(levels.size() + qreg.size, 0);
+        }
+
+        void visit(Gate& gate) override {
+            const GateCost* cost = resolve(gate.name);
+            size_t width = broadcast_width(gate.qubits);
+            if (!cost || width == 0) {
+                return;
+            }
+
+            std::vector<std::optional<double>> args;
+            for (const auto& param : gate.params) {
+                args.push_back(ExpressionEvaluator::evaluate_constant(*param));
+            }
+            TCount t = t_count(gate.name, args);
+
+            total.one_qubit += width * cost->one_qubit;
+            total.two_qubit += width * cost->two_qubit;
+            total.t_count += width * t.count;
+            total.t_count_exact = total.t_count_exact && t.exact;
+
+            std::vector<size_t> qubits(gate.qubits.size());
+            for (size_t i = 0; i < width; ++i) {
+                uint64_t start = 0;
+                for (size_t q = 0; q < gate.qubits.size(); ++q) {
+                    qubits[q] = global_index(gate.qubits[q], i);
+                    start = std::max(start, levels[qubits[q]]);
+                }
+                for (size_t q : qubits) {
+                    levels[q] = start + cost->depth;
+                    if (touched) touched->push_back(q);
+                }
+            }
+        }
+
+        void visit(Barrier& barrier) override {
+            uint64_t level = 0;
+            for_each_qubit(barrier.qubits, [&](size_t q) { level = std::max(level, levels[q]); });
+            for_each_qubit(barrier.qubits, [&](size_t q) {
+                levels[q] = level;
+                if (touched) touched->push_back(q);
+            });
+        }
+
+        void visit(Repeat& repeat) override {
+            if (repeat.count <= 0) {
+                return;
+            }
+            GateCost before = total;
+            std::vector<size_t>* outer = touched;
+            std::vector<size_t> qubits;
+            touched = &qubits;
+            for (const auto& stmt : repeat.body) {
+                stmt->accept(*this);
+            }
+            bool moves = !repeat.shifts.empty();
+            if (!moves) {
+                std::sort(qubits.begin(), qubits.end());
+                qubits.erase(std::unique(qubits.begin(), qubits.end()), qubits.end());
+                touched = nullptr;
+            }
+            GateCost once{total.one_qubit - before.one_qubit, total.two_qubit - before.two_qubit, 0,
+                          total.t_count - before.t_count, true};
+            if (moves && extrapolate_shifted(repeat, qubits)) {
+                uint64_t remaining = static_cast<uint64_t>(repeat.count - 1);
+                total.one_qubit += once.one_qubit * remaining;
+                total.two_qubit += once.two_qubit * remaining;
+                total.t_count += once.t_count * remaining;
+                touched = outer;
+                if (touched) {
+                    touched->insert(touched->end(), qubits.begin(), qubits.end());
+                }
+                return;
+            }
+
+            std::vector<uint64_t> previous(moves ? 0 : qubits.size());
+            for (int k = 1; k < repeat.count; ++k) {
+                for (const auto& shift : repeat.shifts) {
+                    shifts[shift.name] += shift.stride;
+                }
+                for (size_t i = 0; i < previous.size(); ++i) {
+                    previous[i] = levels[qubits[i]];
+                }
+                for (const auto& stmt : repeat.body) {
+                    stmt->accept(*this);
+                }
+                if (moves) {
+                    continue;
+                }
+                uint64_t step = qubits.empty() ? 0 : levels[qubits[0]] - previous[0];
+                bool uniform = true;
+                for (size_t i = 1; i < qubits.size() && uniform; ++i) {
+                    uniform = levels[qubits[i]] - previous[i] == step;
+                }
+                if (uniform) {
+                    uint64_t remaining = static_cast<uint64_t>(repeat.count - 1 - k);
+                    for (size_t q : qubits) {
+                        levels[q] += step * remaining;
+                    }
+                    total.one_qubit += once.one_qubit * remaining;
+                    total.two_qubit += once.two_qubit * remaining;
+                    total.t_count += once.t_count * remaining;
+                    break;
+                }
+            }
+            for (const auto& shift : repeat.shifts) {
+                shifts[shift.name] -= static_cast<long long>(repeat.count - 1) * shift.stride;
+            }
+
+            touched = outer;
+            if (touched) {
+                touched->insert(touched->end(), qubits.begin(), qubits.end());
+            }
+        }
+
+        const GateCost& get_total() const {
+            return total;
+        }
+
+        // Cost of a single application of `gate`, nullptr if it is unknown
+        const GateCost* get_cost(const std::string& gate) {
+            return resolve(gate);
+        }
+
+    private:
+        static const GateCost& u_cost() {
+            static const GateCost cost{1, 0, 1, 0, true};
+            return cost;
+        }
+
+        static const GateCost& cx_cost() {
+            static const GateCost cost{0, 1, 1, 0, true};
+            return cost;
+        }
+
+        // The definition `name` refers to, as seen from the body of `caller` if one is given
+        const GateDef* find_definition(const std::string& name, const GateDef* caller = nullptr) const {
+            auto it = definitions.find(name);
+            if (it != definitions.end()) {
+                auto from = caller ? rank.find(caller) : rank.end();
+                if (from != rank.end() && rank.at(it->second) > from->second) {
+                    return nullptr;
+                }
+                return it->second;
+            }
+            return context.get_library().find_definition(name);
+        }
+
+        const GateCost* resolve(const std::string& name) {
+            if (name == "U") return &u_cost();
+            if (name == "CX") return &cx_cost();
+            const GateDef* def = find_definition(name);
+            return def ? &cost_of_definition(*def) : nullptr;
+        }
+
+        const GateCost& cost_of_definition(const GateDef& def) {
+            auto it = costs.find(&def);
+            if (it != costs.end()) {
+                return it->second;
+            }
+            if (!in_progress.insert(&def).second) {
+                throw std::runtime_error("Recursive gate definition '" + def.name + "'");
+            }
+
+            GateCost cost;
+            std::vector<uint64_t> arg_levels(def.qubits.size(), 0);
+            for (const auto& stmt : def.body) {
+                if (stmt->kind() == Statement::Kind::BARRIER) {
+                    auto args = argument_indices(def, static_cast<Barrier&>(*stmt).qubits);
+                    uint64_t level = 0;
+                    for (size_t a : args) level = std::max(level, arg_levels[a]);
+                    for (size_t a : args) arg_levels[a] = level;
+                    continue;
+                }
+                if (stmt->kind() != Statement::Kind::GATE) {
+                    continue;
+                }
+                const auto& call = static_cast<Gate&>(*stmt);
+                const GateCost* callee = resolve(call.name);
+                if (!callee) {
+                    continue;
+                }
+                cost.one_qubit += callee->one_qubit;
+                cost.two_qubit += callee->two_qubit;
+
+                auto args = argument_indices(def, call.qubits);
+                uint64_t start = 0;
+                for (size_t a : args) start = std::max(start, arg_levels[a]);
+                for (size_t a : args) arg_levels[a] = start + callee->depth;
+            }
+            for (uint64_t level : arg_levels) {
+                cost.depth = std::max(cost.depth, level);
+            }
+
+            in_progress.erase(&def);
+            return costs.emplace(&def, cost).first->second;
+        }
+
+        /**
+         * @brief Runs iterations 1..count-1 of a repeat whose operands all move by one stride.
+         *
+         * Iteration 0 has already been visited. Returns false, with nothing
+         * changed, if the body has other statements, whole-register or
+         * unshifted operands, or too many qubits.
+         */
+        bool extrapolate_shifted(const Repeat& repeat, std::vector<size_t>& qubits) {
+            int stride = repeat.shifts.front().stride;
+            for (const auto& shift : repeat.shifts) {
+                if (shift.stride != stride) {
+                    return false;
+                }
+            }
+            auto moving = [&](const RegisterRef& ref) {
+                if (ref.isRefWholeRegister() || !qreg_offsets.count(ref.name)) {
+                    return false;
+                }
+                bool shifted_ref = false;
+                for (const auto& shift : repeat.shifts) {
+                    shifted_ref = shifted_ref || shift.name == ref.name;
+                }
+                long long last = shifted(ref) + static_cast<long long>(repeat.count - 1) * stride;
+                long long size = static_cast<long long>(context.get_symbols().get_register_size(ref.name));
+                return shifted_ref && shifted(ref) >= 0 && shifted(ref) < size && last >= 0 && last < size;
+            };
+
+            // Qubits of iteration 0, as slots
+            std::unordered_map<size_t, size_t> slot_of;
+            std::vector<size_t> slots;
+            for (const auto& stmt : repeat.body) {
+                const std::vector<RegisterRef>* refs = nullptr;
+                if (stmt->kind() == Statement::Kind::GATE) {
+                    refs = &static_cast<const Gate&>(*stmt).qubits;
+                }
+                else if (stmt->kind() == Statement::Kind::BARRIER) {
+                    refs = &static_cast<const Barrier&>(*stmt).qubits;
+                }
+                else {
+                    return false;
+                }
+                for (const auto& ref : *refs) {
+                    if (!moving(ref)) {
+                        return false;
+                    }
+                    size_t q = global_index(ref, 0);
+                    if (slot_of.emplace(q, slots.size()).second) {
+                        slots.push_back(q);
+                        if (slots.size() > MAX_SPAN_QUBITS) {
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            // paths[j][i]: longest path from slot i's level on entry to slot j's level, NO_PATH if none
+            size_t n = slots.size();
+            std::vector<std::vector<int64_t>> paths(n, std::vector<int64_t>(n, NO_PATH));
+            for (size_t i = 0; i < n; ++i) {
+                paths[i][i] = 0;
+            }
+            std::vector<size_t> operands;
+            std::vector<int64_t> start(n);
+            for (const auto& stmt : repeat.body) {
+                bool is_gate = stmt->kind() == Statement::Kind::GATE;
+                const GateCost* cost = nullptr;
+                operands.clear();
+                if (is_gate) {
+                    const auto& gate = static_cast<const Gate&>(*stmt);
+                    cost = resolve(gate.name);
+                    if (!cost) {
+                        continue;
+                    }
+                    for (const auto& ref : gate.qubits) operands.push_back(slot_of.at(global_index(ref, 0)));
+                }
+                else {
+                    for (const auto& ref : static_cast<const Barrier&>(*stmt).qubits) {
+                        operands.push_back(slot_of.at(global_index(ref, 0)));
+                    }
+                }
+                std::fill(start.begin(), start.end(), NO_PATH);
+                for (size_t s : operands) {
+                    for (size_t i = 0; i < n; ++i) start[i] = std::max(start[i], paths[s][i]);
+                }
+                int64_t depth = is_gate ? static_cast<int64_t>(cost->depth) : 0;
+                for (size_t s : operands) {
+                    for (size_t i = 0; i < n; ++i) paths[s][i] = start[i] == NO_PATH ? NO_PATH : start[i] + depth;
+                }
+            }
+
+            std::vector<uint64_t> entry(n);
+            for (int k = 1; k < repeat.count; ++k) {
+                long long offset = static_cast<long long>(k) * stride;
+                for (size_t i = 0; i < n; ++i) {
+                    entry[i] = levels[static_cast<size_t>(static_cast<long long>(slots[i]) + offset)];
+                }
+                for (size_t j = 0; j < n; ++j) {
+                    uint64_t level = 0;
+                    for (size_t i = 0; i < n; ++i) {
+                        if (paths[j][i] != NO_PATH) level = std::max(level, entry[i] + static_cast<uint64_t>(paths[j][i]));
+                    }
+                    size_t q = static_cast<size_t>(static_cast<long long>(slots[j]) + offset);
+                    levels[q] = level;
+                    qubits.push_back(q);
+                }
+            }
+            return true;
+        }
+
+        static std::vector<size_t> argument_indices(const GateDef& def, const std::vector<RegisterRef>& refs) {
+            std::vector<size_t> indices;
+            for (const auto& ref : refs) {
+                for (size_t a = 0; a < def.qubits.size(); ++a) {
+                    if (def.qubits[a].name == ref.name) {
+                        indices.push_back(a);
+                        break;
+                    }
+                }
+            }
+            return indices;
+        }
+
+        static bool is_t_phase(double theta, double phi, double lambda) {
+            // U(0, phi, lambda) is diag(1, e^{i(phi + lambda)}) up to a global phase
+            double turns = std::remainder(theta, 2 * M_PI);
+            if (std::abs(turns) > TOLERANCE) {
+                return false;
+            }
+            double quarter = std::remainder(phi + lambda - M_PI / 4, M_PI / 2);
+            return std::abs(quarter) < TOLERANCE;
+        }
+
+        TCount t_count(const std::string& name, const std::vector<std::optional<double>>& args) {
+            if (name == "U") {
+                if (args.size() != 3 || !args[0] || !args[1] || !args[2]) {
+                    return TCount{0, false};
+                }
+                return TCount{is_t_phase(*args[0], *args[1], *args[2]) ? 1u : 0u, true};
+            }
+            if (name == "CX") {
+                return TCount{};
+            }
+            const GateDef* def = find_definition(name);
+            if (!def) {
+                return TCount{};
+            }
+
+            std::string key(reinterpret_cast<const char*>(&def), sizeof(def));
+            for (const auto& arg : args) {
+                double value = arg ? *arg : 0.0;
+                key.push_back(arg ? 1 : 0);
+                key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+            auto it = t_counts.find(key);
+            if (it != t_counts.end()) {
+                return it->second;
+            }
+
+            TCount result;
+            ExpressionEvaluator evaluator(def->params, args);
+            for (const auto& stmt : def->body) {
+                if (stmt->kind() != Statement::Kind::GATE) {
+                    continue;
+                }
+                const auto& call = static_cast<Gate&>(*stmt);
+                std::vector<std::optional<double>> call_args;
+                for (const auto& param : call.params) {
+                    call_args.push_back(evaluator.evaluate(*param));
+                }
+                if (call.name != "U" && call.name != "CX" && !find_definition(call.name, def)) {
+                    continue;
+                }
+                TCount callee = t_count(call.name, call_args);
+                result.count += callee.count;
+                result.exact = result.exact && callee.exact;
+            }
+            return t_counts.emplace(key, result).first->second;
+        }
+
+        // Number of applications a statement broadcasts to, 0 if an operand is invalid
+        size_t broadcast_width(const std::vector<RegisterRef>& refs) const {
+            size_t width = 1;
+            for (const auto& ref : refs) {
+                const QRegisterSymbol* qreg = context.get_symbols().lookup_qreg(ref.name);
+                if (!qreg || !qreg_offsets.count(ref.name) ||
+                    (!ref.isRefWholeRegister() && (shifted(ref) < 0 || shifted(ref) >= qreg->width))) {
+                    return 0;
+                }
+                if (ref.isRefWholeRegister()) {
+                    width = qreg->width;
+                }
+            }
+            return width;
+        }
+
+        size_t global_index(const RegisterRef& ref, size_t broadcast_index) const {
+            size_t offset = qreg_offsets.at(ref.name);
+            return offset + (ref.isRefWholeRegister() ? broadcast_index : static_cast<size_t>(shifted(ref)));
+        }
+
+        long long shifted(const RegisterRef& ref) const {
+            auto it = shifts.find(ref.name);
+            return ref.index + (it == shifts.end() ? 0 : it->second);
+        }
+
+        template <typename Fn>
+        void for_each_qubit(const std::vector<RegisterRef>& refs, Fn&& fn) const {
+            for (const auto& ref : refs) {
+                auto it = qreg_offsets.find(ref.name);
+                if (it == qreg_offsets.end()) {
+                    continue;
+                }
+                size_t size = context.get_symbols().get_register_size(ref.name);
+                if (ref.isRefWholeRegister()) {
+                    for (size_t i = 0; i < size; ++i) fn(it->second + i);
+                }
+                else if (shifted(ref) >= 0 && static_cast<size_t>(shifted(ref)) < size) {
+                    fn(it->second + static_cast<size_t>(shifted(ref)));
+                }
+            }
+        }
+    };
+
+}; // namespace qarser
@@ -12,11 +12,11 @@ namespace qarser {
         
         public:
             ParamExpressionValidator(AnalysisContext& context, GateScope& scope)
-                : gate_scope(scope), context(context){}
+                : context(context), gate_scope(scope) {}
         
             void visit(IdentifierExpr& id) override {
                 if (!gate_scope.lookup_param(id.name)) {
-                    context.add_error(id.line, "Parameter '" + id.name + "' not declared in gate definition");
+                    context.add_error(ErrorCode::UNDECLARED_PARAM, id.line, id.name);
                 }
             }
         
@@ -41,23 +41,19 @@ namespace qarser {
         void visit(Gate& gate) {
             auto* gate_symbol = context.get_symbols().lookup_gate(gate.name);
             if (!gate_symbol) {
-                context.add_error(gate.line, "Undefined gate '" + gate.name + "'");
+                context.add_error(ErrorCode::UNDEFINED_GATE, gate.line, gate.name);
                 return;
             }
 
-            if (gate.params.size() != gate_symbol->num_params) {
-                context.add_error(gate.line,
-                    "Gate '" + gate.name + "' expects " +
-                    std::to_string(gate_symbol->num_params) + " parameters, got " +
-                    std::to_string(gate.params.size()));
+            if (gate.params.size() != static_cast<size_t>(gate_symbol->num_params)) {
+                context.add_error(ErrorCode::GATE_PARAM_COUNT, gate.line, gate.name, {},
+                    gate_symbol->num_params, static_cast<int>(gate.params.size()));
                 return;
             }
 
-            if (gate.qubits.size() != gate_symbol->num_qubits) {
-                context.add_error(gate.line, 
-                    "Gate '" + gate.name + "' expects " + 
-                    std::to_string(gate_symbol->num_qubits) + " qubits, got " +
-                    std::to_string(gate.qubits.size()));
+            if (gate.qubits.size() != static_cast<size_t>(gate_symbol->width)) {
+                context.add_error(ErrorCode::GATE_QUBIT_COUNT, gate.line, gate.name, {},
+                    gate_symbol->width, static_cast<int>(gate.qubits.size()));
                 return;
             }
 
@@ -70,7 +66,17 @@ namespace qarser {
 
             for (const auto& qubit : gate.qubits) {
                 if (gate_scope.lookup_qubit(qubit.name) == nullptr) {
-                    context.add_error(gate.line, "Undefined qubit '" + qubit.name + "'");
+                    context.add_error(ErrorCode::UNDEFINED_QUBIT, gate.line, qubit.name);
+                }
+            }
+
+            // Qubit arguments are single qubits, a pairwise check is enough
+            for (size_t i = 1; i < gate.qubits.size(); ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (gate.qubits[i].name == gate.qubits[j].name) {
+                        context.add_error(ErrorCode::DUPLICATE_QUBIT, gate.line, gate.qubits[i].name, gate.name, -1);
+                        return;
+                    }
                 }
             }
 
@@ -95,7 +101,7 @@ namespace qarser {
 
         void visit(GateDef& gate_def) override {
             if (!context.get_symbols().add_gate(gate_def.name, gate_def.params.size(), gate_def.qubits.size())) {
-                context.add_error(gate_def.line, "Redefinition of gate '" + gate_def.name + "'");
+                context.add_error(ErrorCode::GATE_REDEFINITION, gate_def.line, gate_def.name);
                 return;
             }
 
@@ -105,13 +111,13 @@ namespace qarser {
 
             for (const auto& qubit : gate_def.qubits) {
                 if (!gate_scope->add_qubit(qubit.name)) {
-                    context.add_error(gate_def.line, "Name '" + qubit.name + "' already used in gate definition");
+                    context.add_error(ErrorCode::NAME_IN_USE, gate_def.line, qubit.name);
                 }
             }
 
             for (const auto& param : gate_def.params) {
                 if (!gate_scope->add_param(param)) {
-                    context.add_error(gate_def.line, "Name '" + param + "' already used in gate definition");
+                    context.add_error(ErrorCode::NAME_IN_USE, gate_def.line, param);
                 }
             }
 
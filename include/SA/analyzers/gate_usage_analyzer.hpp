@@ -1,5 +1,7 @@
 #pragma once    
+#include <unordered_map>
 #include "base_analyzer.hpp"
+#include "utils/bitset.hpp"
 
 
 namespace qarser {
@@ -14,76 +16,158 @@ namespace qarser {
         void visit(Gate& gate) override {
             const GateSymbol* symbol = context.get_symbols().lookup_gate(gate.name);
             if (!symbol) {
-                context.add_error(gate.line, "Gate '" + gate.name + "' not declared");
+                context.add_error(ErrorCode::GATE_NOT_DECLARED, gate.line, gate.name);
                 return;
             }
 
             // Check params count
-            if (gate.params.size() != symbol->num_params) {
-                context.add_error(gate.line, 
-                    "Gate '" + gate.name + "' expects " + 
-                    std::to_string(symbol->num_params) + " parameters, got " +
-                    std::to_string(gate.params.size()));
+            if (gate.params.size() != static_cast<size_t>(symbol->num_params)) {
+                context.add_error(ErrorCode::GATE_PARAM_COUNT, gate.line, gate.name, {},
+                    symbol->num_params, static_cast<int>(gate.params.size()));
                 return;
             }
 
 
-            auto expanded_qubits = expand_register_refs(gate.qubits);
-
-            // Check qubit count 
-            if (expanded_qubits.size() != symbol->num_qubits) {
-                context.add_error(gate.line, 
-                    "Gate '" + gate.name + "' expects " + 
-                    std::to_string(symbol->num_qubits) + " qubits, got " +
-                    std::to_string(expanded_qubits.size()));
+            // Check qubit count
+            if (gate.qubits.size() != static_cast<size_t>(symbol->width)) {
+                context.add_error(ErrorCode::GATE_QUBIT_COUNT, gate.line, gate.name, {},
+                    symbol->width, static_cast<int>(gate.qubits.size()));
                 return;
             }
 
-            // Check register refs legality
-            for (const auto& ref : expanded_qubits) {
-                if (ref.index >= context.get_symbols().get_register_size(ref.name)) {
-                    context.add_error(gate.line, "register '" + ref.name + "' index out of range");
+            // Check register refs legality, whole-register operands broadcast
+            // the gate and must all have the same size
+            int broadcast = 0;
+            for (const auto& ref : gate.qubits) {
+                const QRegisterSymbol* qreg = context.get_symbols().lookup_qreg(ref.name);
+                if (!qreg) {
+                    context.add_error(ErrorCode::QREG_NOT_DECLARED, gate.line, ref.name);
+                    return;
+                }
+                if (ref.isRefWholeRegister()) {
+                    if (broadcast != 0 && broadcast != qreg->width) {
+                        context.add_error(ErrorCode::BROADCAST_SIZE_MISMATCH, gate.line, gate.name);
+                        return;
+                    }
+                    broadcast = qreg->width;
+                }
+                else if (ref.index >= qreg->width) {
+                    context.add_error(ErrorCode::INDEX_OUT_OF_RANGE, gate.line, ref.name);
                     return;
                 }
             }
+
+            check_aliasing(gate);
        }
 
 
+        void visit(Reset& reset) override {
+            const QRegisterSymbol* qreg = context.get_symbols().lookup_qreg(reset.qubit.name);
+            if (!qreg) {
+                context.add_error(ErrorCode::QREG_NOT_DECLARED, reset.line, reset.qubit.name);
+                return;
+            }
+            if (!reset.qubit.isRefWholeRegister() && reset.qubit.index >= qreg->width) {
+                context.add_error(ErrorCode::INDEX_OUT_OF_RANGE, reset.line, reset.qubit.name);
+            }
+        }
+
+
+        /**
+         * @brief Checks the body once, moving operands only at their extreme iterations.
+         *
+         * Only when that finds a problem is every iteration checked in turn,
+         * with the body shifted in place to its operands and lines, so the
+         * diagnostics are those of the uncompressed program.
+         */
+        void visit(Repeat& repeat) override {
+            ErrorCollector& errors = context.get_errors();
+            size_t mark = errors.count();
+            for (const auto& stmt : repeat.body) {
+                stmt->accept(*this);
+            }
+            bool out_of_range = false;
+            repeat.for_each_operand([&](const RegisterRef& ref, long long low, long long high) {
+                if (low == ref.index && high == ref.index) {
+                    return;
+                }
+                size_t size = context.get_symbols().get_register_size(ref.name);
+                if (size > 0 && (ref.isRefWholeRegister() || low < 0 || high >= static_cast<long long>(size))) {
+                    out_of_range = true;
+                }
+            });
+            if (errors.count() == mark && !out_of_range) {
+                return;
+            }
+
+            errors.truncate(mark);
+            int position = 0;       // iteration the body is shifted to
+            for (int k = 1; k <= repeat.count && !errors.limit_reached(); ++k) {
+                for (const auto& stmt : repeat.body) {
+                    if (errors.limit_reached()) {
+                        break;
+                    }
+                    stmt->accept(*this);
+                }
+                if (k < repeat.count) {
+                    repeat.shift(1, repeat.line_offsets[k] - repeat.line_offsets[position]);
+                    position = k;
+                }
+            }
+            repeat.shift(-position, -repeat.line_offsets[position]);
+        }
+
+
     private:
+        // Per-register scratch bits, all clear between statements
+        std::unordered_map<std::string, DynamicBitset> operand_bits;
 
         /**
-         * @brief 展开寄存器引用列表，将整个寄存器引用展开为单比特引用
-         * 
-         * 例如:
-         * 给定寄存器声明:
-         *     QREG qa[3], qb[2]
-         * 输入引用列表:
-         *     {qa[0], qb[-1], qa[2]}
-         * 展开后:
-         *     {qa[0], qb[0], qb[1], qa[2]}
-         * 
-         * @param ref 原始寄存器引用列表
-         * @return std::vector<RegisterRef> 展开后的引用列表
-         * 
-         * @note 必须在寄存器声明之后使用，否则无法获取正确的寄存器大小
-         * @note 如果引用的寄存器未声明，可能导致未定义行为
+         * @brief Reports a qubit that appears in more than one operand.
+         *
+         * A whole-register operand marks every bit of its register at once, so
+         * `cx q,q` and `cx q,q[0]` are caught with word-wide operations.
+         * Only the bits set here are cleared again afterwards.
          */
-        std::vector<RegisterRef> expand_register_refs(const std::vector<RegisterRef>& ref) {
-            std::vector<RegisterRef> expanded;
-            for (const auto& r : ref) {
-                if (r.index == -1) {
-                    size_t size = context.get_symbols().get_register_size(r.name);
-                    for (int i = 0; i < size; ++i) {
-                        expanded.push_back(RegisterRef(r.name, i));
+        void check_aliasing(const Gate& gate) {
+            if (gate.qubits.size() < 2) {
+                return;
+            }
+
+            std::vector<std::pair<DynamicBitset*, const RegisterRef*>> touched;
+            const RegisterRef* duplicate = nullptr;
+            for (const auto& ref : gate.qubits) {
+                DynamicBitset& bits = operand_bits[ref.name];
+                size_t size = context.get_symbols().get_register_size(ref.name);
+                if (bits.size() != size) {
+                    bits = DynamicBitset(size);
+                }
+
+                touched.emplace_back(&bits, &ref);
+                if (ref.isRefWholeRegister()) {
+                    if (bits.any()) {
+                        duplicate = &ref;
+                        break;
                     }
-                } 
+                    bits.set_all();
+                }
+                else if (bits.test_and_set(ref.index)) {
+                    duplicate = &ref;
+                    break;
+                }
+            }
+
+            for (const auto& [bits, ref] : touched) {
+                if (ref->isRefWholeRegister())
+                    bits->reset_all();
                 else
-                    expanded.push_back(r);
+                    bits->reset(ref->index);
             }
-            return expanded;
-        }
- 
 
+            if (duplicate) {
+                context.add_error(ErrorCode::DUPLICATE_QUBIT, gate.line, duplicate->name, gate.name, duplicate->index);
+            }
+        }
     };
 
 };
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base_analyzer.hpp"
+#include "AST/gate.hpp"
+#include "SA/context/qubit_usage.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Computes used, idle and unmeasured qubits of every quantum register.
+     *
+     * Runs over an already analyzed program: references the semantic checks
+     * rejected (undeclared registers, indices out of range) are skipped.
+     * Whole-register references are recorded with word-wide range operations.
+     * A repeat visits its body once; an operand that moves marks every
+     * index it takes over the iterations, a single range when it moves by
+     * one per iteration.
+     */
+    class QubitUsageAnalyzer : public BaseAnalyzer {
+    private:
+        struct Move {
+            int stride;
+            int count;
+        };
+
+        QubitUsage usage;
+        std::unordered_map<std::string, std::vector<Move>> moves;   // register -> shifts of the enclosing repeats
+        std::vector<size_t> indices;
+        std::vector<uint8_t> seen;          // clear between operands, only the entries in `indices` are set
+
+    public:
+        QubitUsageAnalyzer(AnalysisContext& context)
+            : BaseAnalyzer(context) {}
+
+        void visit(Program& program) override {
+            for (const auto& stmt : program.statements) {
+                stmt->accept(*this);
+            }
+        }
+
+        void visit(QRegister& qreg) override {
+            const QRegisterSymbol* symbol = context.get_symbols().lookup_qreg(qreg.name);
+            if (symbol && symbol->width == qreg.size) {
+                usage.add_register(qreg.name, qreg.size);
+            }
+        }
+
+        void visit(Gate& gate) override {
+            for (const auto& ref : gate.qubits) {
+                mark(ref, &QubitUsage::RegisterUsage::used);
+            }
+        }
+
+        void visit(Measure& measure) override {
+            for (const auto& ref : measure.qubits) {
+                mark(ref, &QubitUsage::RegisterUsage::used);
+                mark(ref, &QubitUsage::RegisterUsage::measured);
+            }
+        }
+
+        void visit(Reset& reset) override {
+            mark(reset.qubit, &QubitUsage::RegisterUsage::used);
+        }
+
+        void visit(Repeat& repeat) override {
+            if (repeat.count <= 0) {
+                return;
+            }
+            for (const auto& shift : repeat.shifts) {
+                moves[shift.name].push_back(Move{shift.stride, repeat.count});
+            }
+            for (const auto& stmt : repeat.body) {
+                stmt->accept(*this);
+            }
+            for (const auto& shift : repeat.shifts) {
+                moves[shift.name].pop_back();
+            }
+        }
+
+        const QubitUsage& get_usage() const {
+            return usage;
+        }
+
+    private:
+        void mark(const RegisterRef& ref, DynamicBitset QubitUsage::RegisterUsage::* field) {
+            QubitUsage::RegisterUsage* reg = usage.find(ref.name);
+            if (!reg) {
+                return;
+            }
+            DynamicBitset& bits = reg->*field;
+            if (ref.isRefWholeRegister()) {
+                bits.set_all();
+                return;
+            }
+            auto it = moves.find(ref.name);
+            long long size = static_cast<long long>(bits.size());
+            if (ref.index < 0 || ref.index >= size) {
+                return;
+            }
+            if (it == moves.end() || it->second.empty()) {
+                bits.set(static_cast<size_t>(ref.index));
+                return;
+            }
+            if (it->second.size() == 1 && std::abs(it->second[0].stride) == 1) {
+                long long end = ref.index + static_cast<long long>(it->second[0].count - 1) * it->second[0].stride;
+                bits.set_range(static_cast<size_t>(std::max(std::min<long long>(ref.index, end), 0LL)),
+                               static_cast<size_t>(std::min(std::max<long long>(ref.index, end) + 1, size)));
+                return;
+            }
+
+            // Sums of the moves of every enclosing repeat, indices outside the register dropped
+            indices.assign(1, static_cast<size_t>(ref.index));
+            if (seen.size() < bits.size()) {
+                seen.resize(bits.size(), 0);
+            }
+            seen[ref.index] = 1;
+            for (const Move& move : it->second) {
+                size_t reached = indices.size();
+                for (size_t i = 0; i < reached; ++i) {
+                    long long index = static_cast<long long>(indices[i]);
+                    for (int k = 1; k < move.count; ++k) {
+                        index += move.stride;
+                        if (index < 0 || index >= size) {
+                            break;
+                        }
+                        if (!seen[index]) {
+                            seen[index] = 1;
+                            indices.push_back(static_cast<size_t>(index));
+                        }
+                    }
+                }
+            }
+            for (size_t index : indices) {
+                bits.set(index);
+                seen[index] = 0;
+            }
+        }
+    };
+
+}; // namespace qarser
@@ -1,6 +1,7 @@
 #pragma once
 #include "symbol.hpp"
 #include "SA/error/error.hpp"
+#include "SA/library/gate_library.hpp"
 
 namespace qarser {
 
@@ -8,6 +9,7 @@ namespace qarser {
     private:
         SymbolTable symbols;
         ErrorCollector errors;
+        const GateLibrary* library = nullptr;
         
     public:
         SymbolTable& get_symbols() { 
@@ -18,13 +20,24 @@ namespace qarser {
         }
 
 
-        void add_error(int line, const std::string& message) {
-            errors.add_error(line, message);
+        void add_error(ErrorCode code, int line,
+                       std::string_view symbol = {}, std::string_view other = {},
+                       int arg0 = 0, int arg1 = 0) {
+            errors.add_error(code, line, symbol, other, arg0, arg1);
+        }
+
+        // Predefined gates the program's names are layered on
+        const GateLibrary& get_library() const {
+            return *library;
+        }
+
+        void set_library(const GateLibrary& gates) {
+            library = &gates;
+            symbols.set_base(gates.get_symbols());
         }
 
         void init_builtins() {
-            symbols.add_gate("U", 3, 1);
-            symbols.add_gate("CX", 0, 2);
+            set_library(GateLibrary::core());
         }
     };
 
@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "utils/bitset.hpp"
+
+namespace qarser {
+
+    /**
+     * @brief Per-register qubit usage, one dense bitset per property.
+     */
+    class QubitUsage {
+    public:
+        struct RegisterUsage {
+            std::string name;
+            DynamicBitset used;         // touched by a gate or a measurement
+            DynamicBitset measured;
+
+            RegisterUsage(const std::string& name, size_t size)
+                : name(name), used(size), measured(size) {}
+
+            // Qubits never touched by the program
+            DynamicBitset idle() const {
+                return ~used;
+            }
+
+            // Qubits that are used but never measured
+            DynamicBitset unmeasured() const {
+                DynamicBitset result = used;
+                result.subtract(measured);
+                return result;
+            }
+        };
+
+    private:
+        std::vector<RegisterUsage> registers;
+        std::unordered_map<std::string, size_t> index;
+
+    public:
+        bool add_register(const std::string& name, size_t size) {
+            if (!index.emplace(name, registers.size()).second) {
+                return false;
+            }
+            registers.emplace_back(name, size);
+            return true;
+        }
+
+        RegisterUsage* find(const std::string& name) {
+            auto it = index.find(name);
+            return it != index.end() ? &registers[it->second] : nullptr;
+        }
+
+        const RegisterUsage* find(const std::string& name) const {
+            auto it = index.find(name);
+            return it != index.end() ? &registers[it->second] : nullptr;
+        }
+
+        // Registers in declaration order
+        const std::vector<RegisterUsage>& get_registers() const {
+            return registers;
+        }
+
+        size_t num_used() const {
+            size_t n = 0;
+            for (const auto& reg : registers) n += reg.used.count();
+            return n;
+        }
+
+        size_t num_idle() const {
+            size_t n = 0;
+            for (const auto& reg : registers) n += reg.used.size() - reg.used.count();
+            return n;
+        }
+
+        size_t num_unmeasured() const {
+            size_t n = 0;
+            for (const auto& reg : registers) n += reg.unmeasured().count();
+            return n;
+        }
+    };
+
+}; // namespace qarser
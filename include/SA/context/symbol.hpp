@@ -1,8 +1,12 @@
 #pragma once
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
 
 namespace qarser {
-    enum class SymbolType {
+    enum class SymbolType : uint8_t {
         QREG,
         CREG,
         GATE,
@@ -18,141 +22,249 @@ namespace qarser {
     }
 
 
-    class NameManager {
-    private:
-        std::unordered_map<std::string, SymbolType> used_names;
-    
-    public:
-        bool add_name(const std::string& name, SymbolType type) {
-            return used_names.emplace(name, type).second;
+    /**
+     * @brief Compact tagged symbol record (12 bytes, no vtable).
+     *
+     * `width` is the size of a register or the number of qubits a gate
+     * acts on; only gates use `num_params`.
+     */
+    struct Symbol {
+        SymbolType type;
+        int num_params;
+        int width;
+
+        static Symbol qreg(int size) { return Symbol(SymbolType::QREG, 0, size); }
+        static Symbol creg(int size) { return Symbol(SymbolType::CREG, 0, size); }
+        static Symbol gate(int num_params, int num_qubits) {
+            return Symbol(SymbolType::GATE, num_params, num_qubits);
         }
-    
-        bool exists(const std::string& name) const {
-            return used_names.find(name) != used_names.end();
+
+        bool is_register() const {
+            return type == SymbolType::QREG || type == SymbolType::CREG;
         }
+
+    private:
+        Symbol(SymbolType type, int num_params, int width)
+            : type(type), num_params(num_params), width(width) {}
     };
 
+    using QRegisterSymbol = Symbol;
+    using CRegisterSymbol = Symbol;
+    using GateSymbol = Symbol;
 
-    class Symbol {
-    public:
-        std::string name;
 
-        Symbol(const std::string& name) 
-            : name(name) {}
 
-        virtual ~Symbol() = default;
+    /**
+     * @brief Single open-addressing table for every global name.
+     *
+     * Registers and gates share one namespace, so one table both enforces
+     * name uniqueness and answers lookups. Slots hold a 32-bit hash tag and
+     * the index of a densely stored entry; a lookup is one linear probe
+     * sequence that only touches an entry when its tag matches.
+     *
+     * A table may be layered on an immutable shared base (e.g. the builtin
+     * gates). Names are looked up locally first and then in the base; new
+     * names may not shadow base names, and edits only touch the local layer.
+     */
+    class SymbolTable {
+    private:
+        struct Slot {
+            uint32_t tag;
+            uint32_t index;     // entry index + 1, 0 marks an empty slot
+        };
 
-        virtual SymbolType type() const = 0;
-    };
+        struct Entry {
+            std::string name;
+            uint64_t hash;
+            Symbol symbol;
+        };
 
+        std::vector<Slot> slots;
+        std::vector<Entry> entries;
+        std::shared_ptr<const SymbolTable> base;
 
-    class QRegisterSymbol : public Symbol {
     public:
-        int size;
+        SymbolTable() = default;
 
-    public:
-        QRegisterSymbol(const std::string& name, int size) 
-            : Symbol(name), size(size) {}
-        
-        SymbolType type() const override {
-            return SymbolType::QREG;
+        explicit SymbolTable(std::shared_ptr<const SymbolTable> base)
+            : base(std::move(base)) {}
+
+        void set_base(std::shared_ptr<const SymbolTable> table) {
+            base = std::move(table);
         }
-    };
 
+        const std::shared_ptr<const SymbolTable>& get_base() const {
+            return base;
+        }
 
-    class CRegisterSymbol : public Symbol {
-    public:
-        int size;
+        bool exists(std::string_view name) const {
+            return find(name) != nullptr;
+        }
 
-    public:
-        CRegisterSymbol(const std::string& name, int size) 
-            : Symbol(name), size(size) {}
-        
-        SymbolType type() const override {
-            return SymbolType::CREG;
+        bool add_qreg(std::string_view name, int size) {
+            return insert(name, Symbol::qreg(size));
         }
-    };
 
+        bool add_creg(std::string_view name, int size) {
+            return insert(name, Symbol::creg(size));
+        }
 
-    class GateSymbol : public Symbol {
-    public:
-        int num_params;
-        int num_qubits;
+        bool add_gate(std::string_view name, int num_params, int num_qubits) {
+            return insert(name, Symbol::gate(num_params, num_qubits));
+        }
 
-    public:
-        GateSymbol(const std::string& name, int num_params, int num_qubits) 
-            :   Symbol(name), 
-                num_params(num_params),
-                num_qubits(num_qubits) {} 
 
-        SymbolType type() const override {
-            return SymbolType::GATE;
+        /**
+         * @brief Finds a name locally, then in the base.
+         *
+         * Symbols are stored by value in a growable array: the pointer is
+         * invalidated by the next add_* or remove on the table holding the
+         * name, so copy the Symbol before changing the table.
+         */
+        const Symbol* lookup(std::string_view name) const {
+            return find(name);
         }
-    };
 
+        const QRegisterSymbol* lookup_qreg(std::string_view name) const {
+            return find(name, SymbolType::QREG);
+        }
 
+        const CRegisterSymbol* lookup_creg(std::string_view name) const {
+            return find(name, SymbolType::CREG);
+        }
 
-    class SymbolTable {
-    private:
-        NameManager name_manager;
-        std::unordered_map<std::string, QRegisterSymbol> qregs;
-        std::unordered_map<std::string, CRegisterSymbol> cregs;
-        std::unordered_map<std::string, GateSymbol> gates;
+        const GateSymbol* lookup_gate(std::string_view name) const {
+            return find(name, SymbolType::GATE);
+        }
 
-    public:
-        SymbolTable() = default;
+        size_t get_register_size(std::string_view name) const {
+            const Symbol* symbol = find(name);
+            return symbol && symbol->is_register() ? symbol->width : 0;
+        }
 
-        bool exists(const std::string& name) const {
-            return name_manager.exists(name);
+        // Number of names in the local layer
+        size_t size() const {
+            return entries.size();
         }
 
-        bool add_qreg(const std::string& name, int size) {
-            if (!name_manager.add_name(name, SymbolType::QREG)) {
-                return false;
+        // Calls fn(name, symbol) for every name in the local layer
+        template <typename Fn>
+        void for_each(Fn&& fn) const {
+            for (const auto& entry : entries) {
+                fn(entry.name, entry.symbol);
             }
-            return qregs.emplace(name, QRegisterSymbol(name, size)).second;
         }
 
-        bool add_creg(const std::string& name, int size) {
-            if (!name_manager.add_name(name, SymbolType::CREG)) {
+        /**
+         * @brief Removes a name from the local layer.
+         *
+         * Uses backward-shift deletion so no tombstones are left behind, and
+         * moves the last entry into the freed entry slot to keep entries dense.
+         */
+        bool remove(std::string_view name) {
+            if (slots.empty()) {
                 return false;
             }
-            return cregs.emplace(name, CRegisterSymbol(name, size)).second;
-        }
-
-        bool add_gate(const std::string& name, int num_params, int num_qubits) {
-            if (!name_manager.add_name(name, SymbolType::GATE)) {
+            uint64_t h = hash(name);
+            size_t mask = slots.size() - 1;
+            size_t i = find_slot(name, h);
+            if (slots[i].index == 0) {
                 return false;
             }
-            return gates.emplace(name, GateSymbol(name, num_params, num_qubits)).second;
+            uint32_t removed = slots[i].index - 1;
+
+            for (size_t j = (i + 1) & mask; slots[j].index != 0; j = (j + 1) & mask) {
+                size_t home = entries[slots[j].index - 1].hash & mask;
+                bool in_place = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+                if (!in_place) {
+                    slots[i] = slots[j];
+                    i = j;
+                }
+            }
+            slots[i] = Slot{0, 0};
+
+            uint32_t last = static_cast<uint32_t>(entries.size() - 1);
+            if (removed != last) {
+                slots[find_slot(entries[last].name, entries[last].hash)].index = removed + 1;
+                entries[removed] = std::move(entries[last]);
+            }
+            entries.pop_back();
+            return true;
         }
 
+    private:
+        static uint64_t hash(std::string_view name) {
+            // FNV-1a followed by a murmur finalizer for well mixed low bits
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (char c : name) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 0x100000001b3ull;
+            }
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            return h;
+        }
 
-        const QRegisterSymbol* lookup_qreg(const std::string& name) const {
-            auto it = qregs.find(name);
-            return it != qregs.end() ? &it->second : nullptr;
+        const Symbol* find(std::string_view name, SymbolType type) const {
+            const Symbol* symbol = find(name);
+            return symbol && symbol->type == type ? symbol : nullptr;
         }
-    
-        const CRegisterSymbol* lookup_creg(const std::string& name) const {
-            auto it = cregs.find(name);
-            return it != cregs.end() ? &it->second : nullptr;
+
+        const Symbol* find(std::string_view name) const {
+            if (!slots.empty()) {
+                const Slot& slot = slots[find_slot(name, hash(name))];
+                if (slot.index != 0) {
+                    return &entries[slot.index - 1].symbol;
+                }
+            }
+            return base ? base->find(name) : nullptr;
         }
-    
-        const GateSymbol* lookup_gate(const std::string& name) const {
-            auto it = gates.find(name);
-            return it != gates.end() ? &it->second : nullptr;
+
+        // Slot holding `name`, or the empty slot that ends its probe sequence
+        size_t find_slot(std::string_view name, uint64_t h) const {
+            uint32_t tag = static_cast<uint32_t>(h >> 32);
+            size_t mask = slots.size() - 1;
+            for (size_t i = h & mask; ; i = (i + 1) & mask) {
+                const Slot& slot = slots[i];
+                if (slot.index == 0 ||
+                    (slot.tag == tag && entries[slot.index - 1].name == name)) {
+                    return i;
+                }
+            }
         }
 
-        size_t get_register_size(const std::string& name) const {
-            if (auto qreg = lookup_qreg(name)) {
-                return qreg->size;
+        bool insert(std::string_view name, const Symbol& symbol) {
+            if (base && base->find(name)) {
+                return false;
+            }
+            // Keep the load factor at or below 1/2
+            if ((entries.size() + 1) * 2 > slots.size()) {
+                rehash(slots.empty() ? 16 : slots.size() * 2);
+            }
+            uint64_t h = hash(name);
+            size_t i = find_slot(name, h);
+            if (slots[i].index != 0) {
+                return false;
             }
-            if (auto creg = lookup_creg(name)) {
-                return creg->size;
+            entries.push_back(Entry{std::string(name), h, symbol});
+            slots[i] = Slot{static_cast<uint32_t>(h >> 32), static_cast<uint32_t>(entries.size())};
+            return true;
+        }
+
+        void rehash(size_t capacity) {
+            slots.assign(capacity, Slot{0, 0});
+            size_t mask = capacity - 1;
+            for (size_t e = 0; e < entries.size(); ++e) {
+                uint64_t h = entries[e].hash;
+                size_t i = h & mask;
+                while (slots[i].index != 0) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = Slot{static_cast<uint32_t>(h >> 32), static_cast<uint32_t>(e + 1)};
             }
-            return 0;
         }
     };
 
 
-}; // namespace qarser
\ No newline at end of file
+}; // namespace qarser
@@ -1,57 +1,276 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-    
+
 namespace qarser {
-    
 
-    class SemanticError {
-    public:
+    enum class ErrorCode : uint16_t {
+        INVALID_QREG_SIZE,
+        INVALID_CREG_SIZE,
+        QREG_REDEFINITION,
+        CREG_REDEFINITION,
+        GATE_REDEFINITION,
+        INCLUDE_NOT_FOUND,
+
+        GATE_NOT_DECLARED,
+        GATE_PARAM_COUNT,        // args: expected, got
+        GATE_QUBIT_COUNT,        // args: expected, got
+        QREG_NOT_DECLARED,
+        BROADCAST_SIZE_MISMATCH,
+        INDEX_OUT_OF_RANGE,
+        DUPLICATE_QUBIT,         // symbol: register or qubit argument, other: gate, args: index or -1
+
+        // Gate definition bodies
+        NAME_IN_USE,
+        UNDECLARED_PARAM,
+        UNDEFINED_GATE,
+        UNDEFINED_QUBIT,
+
+        TOO_MANY_ERRORS,         // args: diagnostics dropped past the limit
+    };
+
+
+    /**
+     * @brief Compact diagnostic record, formatted only when rendered.
+     *
+     * Names are stored as IDs interned by the owning ErrorCollector. The AST
+     * only carries line numbers, so the span is the statement's line.
+     */
+    struct Diagnostic {
+        static constexpr uint32_t NO_SYMBOL = std::numeric_limits<uint32_t>::max();
+
+        ErrorCode code;
         int line;
-        std::string message;
+        uint32_t symbol = NO_SYMBOL;
+        uint32_t other = NO_SYMBOL;
+        int args[2] = {0, 0};
+    };
+
+
+
+    class DiagnosticSink {
+    public:
+        virtual ~DiagnosticSink() = default;
+        virtual void write(const Diagnostic& diagnostic, std::string_view message) = 0;
+        virtual void flush() {}
+    };
+
+
+    // Buffers rendered lines and writes them to the stream in large chunks
+    class StreamSink : public DiagnosticSink {
+    private:
+        std::ostream& out;
+        std::string buffer;
+        size_t capacity;
 
     public:
-        SemanticError(int line ,const std::string& message) 
-            : line(line), message(message) {}
+        explicit StreamSink(std::ostream& out, size_t capacity = 1 << 16)
+            : out(out), capacity(capacity) {
+            buffer.reserve(capacity);
+        }
+
+        ~StreamSink() override {
+            flush();
+        }
+
+        void write(const Diagnostic& diagnostic, std::string_view message) override {
+            // Line 0 marks diagnostics about the whole program
+            if (diagnostic.line > 0) {
+                buffer += "Error at line ";
+                buffer += std::to_string(diagnostic.line);
+                buffer += ": ";
+            }
+            else {
+                buffer += "Error: ";
+            }
+            buffer += message;
+            buffer += '\n';
+            if (buffer.size() >= capacity) {
+                flush();
+            }
+        }
+
+        void flush() override {
+            out.write(buffer.data(), buffer.size());
+            out.flush();
+            buffer.clear();
+        }
     };
 
 
+
     class ErrorCollector {
     private:
-        std::vector<SemanticError> errors;
-        
+        std::vector<Diagnostic> errors;
+        size_t limit = std::numeric_limits<size_t>::max();
+        size_t dropped = 0;
+
+        std::deque<std::string> names;
+        std::unordered_map<std::string_view, uint32_t> name_ids;
+
     public:
-        ErrorCollector() = default;       
+        ErrorCollector() = default;
+        ErrorCollector(const ErrorCollector&) = delete;
+        ErrorCollector& operator=(const ErrorCollector&) = delete;
+
+        // Maximum number of stored diagnostics, later ones are only counted; 0 means no limit
+        void set_limit(size_t max_errors) {
+            limit = max_errors == 0 ? std::numeric_limits<size_t>::max() : max_errors;
+        }
+
+        bool limit_reached() const {
+            return errors.size() >= limit;
+        }
+
+        size_t get_dropped() const {
+            return dropped;
+        }
 
-        void add_error(int line, const std::string& message) {
-            errors.emplace_back(line, message);
+        // Diagnostics added so far, stored or dropped
+        size_t count() const {
+            return errors.size() + dropped;
+        }
+
+        // Forgets every diagnostic added since count() returned `mark`
+        void truncate(size_t mark) {
+            if (mark <= errors.size()) {
+                errors.resize(mark);
+                dropped = 0;
+            }
+            else {
+                dropped = mark - errors.size();
+            }
+        }
+
+        void add_error(ErrorCode code, int line,
+                       std::string_view symbol = {}, std::string_view other = {},
+                       int arg0 = 0, int arg1 = 0) {
+            if (limit_reached()) {
+                ++dropped;
+                return;
+            }
+            Diagnostic diagnostic{code, line};
+            if (!symbol.empty()) diagnostic.symbol = intern(symbol);
+            if (!other.empty()) diagnostic.other = intern(other);
+            diagnostic.args[0] = arg0;
+            diagnostic.args[1] = arg1;
+            errors.push_back(diagnostic);
         }
 
         void report() {
-            if (empty())
-                std::cout << "Done !" << std::endl;
-            else
-                this->print();
+            StreamSink sink(std::cout);
+            report(sink);
         }
 
+        void report(DiagnosticSink& sink) const {
+            for (const auto& err : errors) {
+                sink.write(err, format(err));
+            }
+            if (dropped > 0) {
+                Diagnostic summary{ErrorCode::TOO_MANY_ERRORS, 0};
+                summary.args[0] = static_cast<int>(std::min<size_t>(dropped, std::numeric_limits<int>::max()));
+                sink.write(summary, format(summary));
+            }
+            sink.flush();
+        }
 
-        bool empty() {
+        bool empty() const {
             return errors.empty();
         }
 
-        const std::vector<SemanticError>& get_errors() const {
+        const std::vector<Diagnostic>& get_errors() const {
             return errors;
         }
 
-        void print() {
-            for (const auto& err : errors) {
-                std::cout << "Error at line " << err.line << ": " << err.message << std::endl;
-            }
+        // Moves the collected errors out, leaving the collector empty
+        std::vector<Diagnostic> take() {
+            std::vector<Diagnostic> taken = std::move(errors);
+            errors.clear();
+            dropped = 0;
+            return taken;
+        }
+
+        const std::string& name(uint32_t id) const {
+            return names[id];
         }
 
+        std::string format(const Diagnostic& err) const {
+            auto sym = [&]() -> std::string { return quote(err.symbol); };
+            switch (err.code) {
+                case ErrorCode::INVALID_QREG_SIZE:
+                    return "Invalid quantum register size";
+                case ErrorCode::INVALID_CREG_SIZE:
+                    return "Invalid classical register size";
+                case ErrorCode::QREG_REDEFINITION:
+                    return "Redefinition of quantum register " + sym();
+                case ErrorCode::CREG_REDEFINITION:
+                    return "Redefinition of classical register " + sym();
+                case ErrorCode::GATE_REDEFINITION:
+                    return "Redefinition of gate " + sym();
+                case ErrorCode::INCLUDE_NOT_FOUND:
+                    return "Cannot find include file " + sym();
+                case ErrorCode::GATE_NOT_DECLARED:
+                    return "Gate " + sym() + " not declared";
+                case ErrorCode::GATE_PARAM_COUNT:
+                    return "Gate " + sym() + " expects " + std::to_string(err.args[0]) +
+                           " parameters, got " + std::to_string(err.args[1]);
+                case ErrorCode::GATE_QUBIT_COUNT:
+                    return "Gate " + sym() + " expects " + std::to_string(err.args[0]) +
+                           " qubits, got " + std::to_string(err.args[1]);
+                case ErrorCode::QREG_NOT_DECLARED:
+                    return "Quantum register " + sym() + " not declared";
+                case ErrorCode::BROADCAST_SIZE_MISMATCH:
+                    return "Gate " + sym() + " broadcast over registers of different sizes";
+                case ErrorCode::INDEX_OUT_OF_RANGE:
+                    return "register " + sym() + " index out of range";
+                case ErrorCode::DUPLICATE_QUBIT: {
+                    std::string operand = lookup(err.symbol);
+                    if (err.args[0] >= 0) {
+                        operand += "[" + std::to_string(err.args[0]) + "]";
+                    }
+                    return "Duplicate qubit operand '" + operand + "' in gate " + quote(err.other);
+                }
+                case ErrorCode::NAME_IN_USE:
+                    return "Name " + sym() + " already used in gate definition";
+                case ErrorCode::UNDECLARED_PARAM:
+                    return "Parameter " + sym() + " not declared in gate definition";
+                case ErrorCode::UNDEFINED_GATE:
+                    return "Undefined gate " + sym();
+                case ErrorCode::UNDEFINED_QUBIT:
+                    return "Undefined qubit " + sym();
+                case ErrorCode::TOO_MANY_ERRORS:
+                    return "Too many errors, " + std::to_string(err.args[0]) + " more not shown";
+            }
+            return "Unknown error";
+        }
 
+    private:
+        uint32_t intern(std::string_view name) {
+            auto it = name_ids.find(name);
+            if (it != name_ids.end()) {
+                return it->second;
+            }
+            uint32_t id = static_cast<uint32_t>(names.size());
+            names.emplace_back(name);
+            name_ids.emplace(names.back(), id);
+            return id;
+        }
 
+        std::string lookup(uint32_t id) const {
+            return id == Diagnostic::NO_SYMBOL ? std::string() : names[id];
+        }
 
+        std::string quote(uint32_t id) const {
+            return "'" + lookup(id) + "'";
+        }
     };
 
 
-}; // namespace qarser
\ No newline at end of file
+}; // namespace qarser
@@ -0,0 +1,397 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include "SA/analyzer.hpp"
+#include "AST/gate.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Collects the global names a statement defines and refers to.
+     *
+     * Gate uses depend on the gate's definition, register references on the
+     * register declaration, and a gate definition on every gate its body calls.
+     */
+    class DependencyCollector : public BaseVisitor {
+    public:
+        std::vector<std::string> defines;
+        std::vector<std::string> uses;
+
+    public:
+        void visit(QRegister& qreg) override {
+            defines.push_back(qreg.name);
+        }
+
+        void visit(CRegister& creg) override {
+            defines.push_back(creg.name);
+        }
+
+        void visit(Gate& gate) override {
+            uses.push_back(gate.name);
+            add_refs(gate.qubits);
+        }
+
+        void visit(GateDef& gate_def) override {
+            defines.push_back(gate_def.name);
+            for (const auto& stmt : gate_def.body) {
+                // Qubit arguments inside a body are local, only callee names are global
+                if (stmt->kind() == Statement::Kind::GATE) {
+                    uses.push_back(static_cast<Gate&>(*stmt).name);
+                }
+            }
+        }
+
+        void visit(Measure& measure) override {
+            add_refs(measure.qubits);
+            add_refs(measure.cbits);
+        }
+
+        void visit(Reset& reset) override {
+            uses.push_back(reset.qubit.name);
+        }
+
+        void visit(Barrier& barrier) override {
+            add_refs(barrier.qubits);
+        }
+
+        void visit(Repeat& repeat) override {
+            for (const auto& stmt : repeat.body) {
+                stmt->accept(*this);
+            }
+        }
+
+    private:
+        void add_refs(const std::vector<RegisterRef>& refs) {
+            for (const auto& ref : refs) {
+                uses.push_back(ref.name);
+            }
+        }
+    };
+
+
+
+    /**
+     * @brief Semantic analysis that re-checks only what an edit can affect.
+     *
+     * Every statement keeps the names it defines and uses together with the
+     * errors it produced. After `replace`, the changed statements and every
+     * statement referring to a name defined by a removed or inserted statement
+     * are re-analyzed in program order; all other results are kept. The
+     * concatenated diagnostics always equal those of a full re-analysis.
+     *
+     * Program order is kept as a sparse 64-bit label per record, so an edit
+     * only labels its inserted statements, in the gap between their
+     * neighbours; all labels are spread out again only when a gap runs out.
+     *
+     * Includes switch the shared gate library for everything after them, so
+     * edits that add or remove an include, or that define a name provided by
+     * the active library, fall back to a full re-analysis.
+     */
+    class IncrementalAnalyzer {
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        static constexpr uint64_t REMOVED = std::numeric_limits<uint64_t>::max();
+
+        struct Record {
+            uint32_t id;
+            Statement* stmt;
+            uint64_t label;                         // increases in program order, REMOVED once removed
+            std::vector<uint32_t> defines;
+            std::vector<uint32_t> uses;
+            std::vector<Diagnostic> errors;
+        };
+
+        std::unique_ptr<SemanticAnalyzer> analyzer = std::make_unique<SemanticAnalyzer>();
+
+        std::vector<Record> records;                // by id
+        std::vector<uint32_t> order;                // record ids, aligned with Program::statements
+
+        std::unordered_map<std::string, uint32_t> name_ids;
+        std::vector<std::string> names;
+        std::vector<uint32_t> binding;              // name id -> record id of the visible definition
+        std::vector<std::vector<uint32_t>> referrers;   // name id -> record ids defining or using it
+        std::vector<uint8_t> dirty;                 // name id -> flag, only set during an update
+
+        uint32_t library_record = NONE;             // include that activated the gate library
+        std::vector<const GateLibrary*> included;   // libraries named by include statements
+
+    public:
+        IncrementalAnalyzer() = default;
+
+        // Full analysis of `program`, discarding any previous state
+        void analyze(Program& program) {
+            analyzer = std::make_unique<SemanticAnalyzer>();
+            records.clear();
+            order.clear();
+            name_ids.clear();
+            names.clear();
+            binding.clear();
+            referrers.clear();
+            dirty.clear();
+            library_record = NONE;
+            included.clear();
+            update(program, 0, {}, program.statements.size());
+        }
+
+        /**
+         * @brief Replaces `count` statements starting at `first` with `statements`.
+         *
+         * The program is edited in place and re-analyzed incrementally.
+         */
+        void replace(Program& program, size_t first, size_t count,
+                     std::vector<std::unique_ptr<Statement>> statements) {
+            if (first > program.statements.size() || count > program.statements.size() - first) {
+                throw std::out_of_range("Statement range out of program bounds");
+            }
+            bool full = false;
+            for (size_t i = first; i < first + count; ++i) {
+                full = full || affects_library(*program.statements[i]);
+            }
+            for (const auto& stmt : statements) {
+                full = full || affects_library(*stmt);
+            }
+
+            auto& stmts = program.statements;
+            stmts.erase(stmts.begin() + first, stmts.begin() + first + count);
+            size_t inserted = statements.size();
+            stmts.insert(stmts.begin() + first,
+                std::make_move_iterator(statements.begin()),
+                std::make_move_iterator(statements.end()));
+
+            if (full) {
+                analyze(program);
+                return;
+            }
+
+            std::vector<uint32_t> removed(order.begin() + first, order.begin() + first + count);
+            order.erase(order.begin() + first, order.begin() + first + count);
+            update(program, first, removed, inserted);
+        }
+
+        // Diagnostics in program order
+        std::vector<Diagnostic> get_errors() const {
+            std::vector<Diagnostic> all;
+            for (uint32_t id : order) {
+                all.insert(all.end(), records[id].errors.begin(), records[id].errors.end());
+            }
+            return all;
+        }
+
+        // Interned names referenced by the diagnostics
+        const ErrorCollector& get_collector() {
+            return analyzer->get_context().get_errors();
+        }
+
+        const SymbolTable& get_symbols() {
+            return analyzer->get_context().get_symbols();
+        }
+
+    private:
+        void update(Program& program, size_t first,
+                    const std::vector<uint32_t>& removed, size_t inserted) {
+            std::vector<uint32_t> dirty_names;
+
+            auto mark_dirty = [&](uint32_t name) {
+                if (!dirty[name]) {
+                    dirty[name] = 1;
+                    dirty_names.push_back(name);
+                }
+            };
+
+            for (uint32_t id : removed) {
+                Record& record = records[id];
+                record.label = REMOVED;
+                record.stmt = nullptr;
+                for (uint32_t name : record.defines) {
+                    mark_dirty(name);
+                }
+                record.uses.clear();
+                record.errors.clear();
+            }
+
+            // Dirty statements: the inserted ones and every live referrer of a dirty name
+            std::vector<uint32_t> ids;
+            for (size_t i = first; i < first + inserted; ++i) {
+                ids.push_back(make_record(*program.statements[i]));
+                for (uint32_t name : records[ids.back()].defines) {
+                    mark_dirty(name);
+                }
+            }
+            order.insert(order.begin() + first, ids.begin(), ids.end());
+            assign_labels(first, inserted);
+
+            SymbolTable& symbols = analyzer->get_context().get_symbols();
+            for (uint32_t name : dirty_names) {
+                auto& refs = referrers[name];
+                refs.erase(std::remove_if(refs.begin(), refs.end(),
+                    [&](uint32_t id) { return records[id].label == REMOVED; }), refs.end());
+                ids.insert(ids.end(), refs.begin(), refs.end());
+                // Builtins have no defining record and are never removed
+                if (binding[name] != NONE) {
+                    symbols.remove(names[name]);
+                    binding[name] = NONE;
+                }
+            }
+            std::sort(ids.begin(), ids.end(),
+                [&](uint32_t a, uint32_t b) { return records[a].label < records[b].label; });
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+            for (uint32_t id : ids) {
+                recheck(records[id]);
+            }
+
+            for (uint32_t name : dirty_names) {
+                dirty[name] = 0;
+            }
+        }
+
+        // Labels the `count` records inserted at `first` between their neighbours
+        void assign_labels(size_t first, size_t count) {
+            uint64_t low = first > 0 ? records[order[first - 1]].label : 0;
+            uint64_t high = first + count < order.size() ? records[order[first + count]].label : REMOVED;
+            uint64_t step = (high - low) / (count + 1);
+            if (step == 0) {
+                // Out of room, spread every label evenly again
+                low = 0;
+                step = REMOVED / (order.size() + 1);
+                first = 0;
+                count = order.size();
+            }
+            for (size_t i = 0; i < count; ++i) {
+                records[order[first + i]].label = low + step * (i + 1);
+            }
+        }
+
+        bool affects_library(Statement& stmt) {
+            if (stmt.kind() == Statement::Kind::INCLUDE) {
+                return true;
+            }
+            if (included.empty()) {
+                return false;
+            }
+            // Whether an include clashes depends on the names declared before it
+            DependencyCollector collector;
+            stmt.accept(collector);
+            for (const GateLibrary* library : included) {
+                for (const auto& name : collector.defines) {
+                    if (library->get_symbols()->exists(name)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void recheck(Record& record) {
+            Statement& stmt = *record.stmt;
+            AnalysisContext& context = analyzer->get_context();
+            SymbolTable& symbols = context.get_symbols();
+
+            // Statements before the include only see the builtin gates
+            std::shared_ptr<const SymbolTable> base = symbols.get_base();
+            bool before_library = library_record != NONE && records[library_record].label > record.label;
+            if (before_library) {
+                symbols.set_base(GateLibrary::core().get_symbols());
+            }
+            const GateLibrary* library = &context.get_library();
+
+            // Names this statement defined itself are re-added by the analyzer
+            std::vector<uint8_t> had;
+            for (uint32_t name : record.defines) {
+                if (binding[name] == record.id) {
+                    symbols.remove(names[name]);
+                    binding[name] = NONE;
+                }
+                had.push_back(symbols.exists(names[name]));
+            }
+
+            // Hide definitions that only appear later in the program
+            std::vector<std::pair<uint32_t, Symbol>> hidden;
+            for (uint32_t name : record.uses) {
+                if (dirty[name] || binding[name] == NONE || records[binding[name]].label <= record.label) {
+                    continue;
+                }
+                hidden.emplace_back(name, *symbols.lookup(names[name]));
+                symbols.remove(names[name]);
+            }
+
+            analyzer->analyze(stmt);
+            record.errors = context.get_errors().take();
+
+            if (library != &context.get_library()) {
+                library_record = record.id;
+            }
+            if (stmt.kind() == Statement::Kind::INCLUDE) {
+                if (auto* named = GateLibrary::find_include(static_cast<Include&>(stmt).filename)) {
+                    included.push_back(named);
+                }
+            }
+            if (before_library) {
+                symbols.set_base(base);
+            }
+
+            for (size_t i = 0; i < record.defines.size(); ++i) {
+                if (!had[i] && symbols.exists(names[record.defines[i]])) {
+                    binding[record.defines[i]] = record.id;
+                }
+            }
+
+            for (const auto& [name, symbol] : hidden) {
+                restore(symbols, names[name], symbol);
+            }
+        }
+
+        static void restore(SymbolTable& symbols, const std::string& name, const Symbol& symbol) {
+            switch (symbol.type) {
+                case SymbolType::QREG: symbols.add_qreg(name, symbol.width); break;
+                case SymbolType::CREG: symbols.add_creg(name, symbol.width); break;
+                case SymbolType::GATE: symbols.add_gate(name, symbol.num_params, symbol.width); break;
+            }
+        }
+
+        // Adds an unlabeled record for `stmt` and returns its id
+        uint32_t make_record(Statement& stmt) {
+            DependencyCollector collector;
+            stmt.accept(collector);
+
+            Record record;
+            record.id = static_cast<uint32_t>(records.size());
+            record.stmt = &stmt;
+            record.label = REMOVED;
+
+            for (const auto& name : collector.defines) {
+                record.defines.push_back(intern(name));
+            }
+            for (const auto& name : collector.uses) {
+                record.uses.push_back(intern(name));
+            }
+            std::sort(record.uses.begin(), record.uses.end());
+            record.uses.erase(std::unique(record.uses.begin(), record.uses.end()), record.uses.end());
+
+            std::vector<uint32_t> refs = record.uses;
+            refs.insert(refs.end(), record.defines.begin(), record.defines.end());
+            std::sort(refs.begin(), refs.end());
+            refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+            for (uint32_t name : refs) {
+                referrers[name].push_back(record.id);
+            }
+            records.push_back(std::move(record));
+            return records.back().id;
+        }
+
+        uint32_t intern(const std::string& name) {
+            auto [it, inserted] = name_ids.emplace(name, static_cast<uint32_t>(names.size()));
+            if (inserted) {
+                names.push_back(name);
+                binding.push_back(NONE);
+                referrers.emplace_back();
+                dirty.push_back(0);
+            }
+            return it->second;
+        }
+    };
+
+}; // namespace qarser
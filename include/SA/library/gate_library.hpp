@@ -0,0 +1,90 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include "parser.h"
+#include "SA/context/symbol.hpp"
+#include "SA/library/qelib1.hpp"
+
+
+namespace qarser {
+
+    /**
+     * @brief Immutable, process-wide set of predefined gates.
+     *
+     * Each library is built once on first use (thread-safe static
+     * initialization) and never modified afterwards. Analysis sessions layer
+     * their own SymbolTable on `get_symbols()`, so starting a session only
+     * copies a shared pointer and sessions on different threads can share
+     * the same library.
+     */
+    class GateLibrary {
+    private:
+        std::shared_ptr<const SymbolTable> symbols;
+        std::unique_ptr<Program> program;
+        std::unordered_map<std::string, const GateDef*> definitions;
+
+    public:
+        GateLibrary(GateLibrary&&) = default;
+        GateLibrary(const GateLibrary&) = delete;
+        GateLibrary& operator=(const GateLibrary&) = delete;
+
+        const std::shared_ptr<const SymbolTable>& get_symbols() const {
+            return symbols;
+        }
+
+        // Definition of a library gate, nullptr for builtins and unknown names
+        const GateDef* find_definition(const std::string& name) const {
+            auto it = definitions.find(name);
+            return it != definitions.end() ? it->second : nullptr;
+        }
+
+        // Builtin gates U and CX
+        static const GateLibrary& core() {
+            static const GateLibrary library = build(nullptr);
+            return library;
+        }
+
+        // Builtins plus every gate of qelib1.inc
+        static const GateLibrary& qelib1() {
+            static const GateLibrary library = build(QELIB1_SOURCE);
+            return library;
+        }
+
+        // Library provided by an include file, nullptr if it is unknown
+        static const GateLibrary* find_include(const std::string& filename) {
+            if (filename == "qelib1.inc") {
+                return &qelib1();
+            }
+            return nullptr;
+        }
+
+    private:
+        GateLibrary() = default;
+
+        static GateLibrary build(const char* source) {
+            GateLibrary library;
+            auto table = std::make_shared<SymbolTable>();
+            table->add_gate("U", 3, 1);
+            table->add_gate("CX", 0, 2);
+
+            if (source) {
+                library.program = Parser(source).parse();
+                for (const auto& stmt : library.program->statements) {
+                    if (stmt->kind() != Statement::Kind::GATE_DEF) {
+                        continue;
+                    }
+                    const auto& def = static_cast<const GateDef&>(*stmt);
+                    if (!table->add_gate(def.name, def.params.size(), def.qubits.size())) {
+                        throw std::logic_error("Duplicate gate '" + def.name + "' in gate library");
+                    }
+                    library.definitions.emplace(def.name, &def);
+                }
+            }
+            library.symbols = std::move(table);
+            return library;
+        }
+    };
+
+}; // namespace qarser
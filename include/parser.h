@@ -37,7 +37,7 @@ private:
     std::unique_ptr<CRegister> parse_creg();
     std::unique_ptr<Measure> parse_measure();
     std::unique_ptr<Barrier> parse_barrier();
-    // std::unique_ptr<Reset> parse_reset();
+    std::unique_ptr<Reset> parse_reset();
     // std::unique_ptr<If> parse_if();
 
     std::unique_ptr<Gate> parse_gate();
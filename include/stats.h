@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "lexer.h"
+
+namespace qarser {
+
+
+struct CircuitStats {
+    std::unordered_map<std::string, uint64_t> gate_counts;  // top-level calls per gate name
+    uint64_t one_qubit = 0;
+    uint64_t two_qubit = 0;
+    uint64_t multi_qubit = 0;
+    uint64_t measurements = 0;
+    uint64_t resets = 0;
+    uint64_t barriers = 0;
+
+    uint64_t qubits = 0;        // declared
+    uint64_t qubits_used = 0;
+    uint64_t clbits = 0;
+    uint64_t depth = 0;         // every gate call, measure and reset counts as one layer; measures also wait on their clbit
+
+    // Bytes of a complex<double> state vector over every declared qubit
+    double statevector_bytes() const;
+
+    void print(std::ostream& out) const;
+};
+
+
+/**
+ * @brief Computes CircuitStats in one pass over the token stream.
+ *
+ * No AST is built: statements are recognised directly from tokens, gate
+ * definitions are skipped, and only per-register offsets plus a depth
+ * counter and a used flag per qubit and a depth counter per clbit are kept,
+ * so memory is proportional to the register width. Calls count once per broadcast element; gates
+ * are not expanded.
+ */
+class StatsCollector {
+private:
+    struct Register {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Operand {
+        uint64_t base;
+        uint64_t size;      // 1 for a single qubit
+        bool whole;
+        bool clbit = false;
+    };
+
+    QasmLexer lexer;
+    Token current;
+
+    std::unordered_map<std::string, Register> qregs;
+    std::unordered_map<std::string, Register> cregs;
+    std::vector<uint64_t> levels;
+    std::vector<uint64_t> clbit_levels;
+    std::vector<bool> used;
+    std::vector<Operand> operands;
+    CircuitStats stats;
+
+public:
+    StatsCollector(const std::string& source);
+    CircuitStats collect();
+
+private:
+    void advance();
+    Token consume(TokenType type, const std::string& message);
+    [[noreturn]] void error(const std::string& message);
+
+    void statement();
+    void declaration(std::unordered_map<std::string, Register>& registers, uint64_t& total);
+    void gate_call();
+    void measure();
+    void reset();
+    void barrier();
+    void skip_gate_def();
+    void skip_until(TokenType type);
+
+    Operand operand(const std::unordered_map<std::string, Register>& registers);
+    uint64_t broadcast_width();
+    void apply(uint64_t width);
+    uint64_t& level(const Operand& op, uint64_t broadcast_index);
+};
+
+
+}; // namespace qarser
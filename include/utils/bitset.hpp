@@ -0,0 +1,191 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace qarser {
+
+    /**
+     * @brief Dense, runtime-sized bitset backed by 64-bit words.
+     *
+     * Range and set operations work a word at a time (and are simple enough
+     * loops for the compiler to vectorize), so their cost scales with the
+     * number of words rather than the number of bits.
+     */
+    class DynamicBitset {
+    private:
+        static constexpr size_t BITS = 64;
+
+        size_t nbits = 0;
+        std::vector<uint64_t> words;
+
+    public:
+        DynamicBitset() = default;
+
+        explicit DynamicBitset(size_t size)
+            : nbits(size), words((size + BITS - 1) / BITS, 0) {}
+
+        size_t size() const { return nbits; }
+        size_t num_words() const { return words.size(); }
+        const uint64_t* data() const { return words.data(); }
+        uint64_t* data() { return words.data(); }
+
+        void resize(size_t size) {
+            nbits = size;
+            words.resize((size + BITS - 1) / BITS, 0);
+            trim();
+        }
+
+        bool test(size_t i) const {
+            return (words[i / BITS] >> (i % BITS)) & 1;
+        }
+
+        void set(size_t i) {
+            words[i / BITS] |= uint64_t(1) << (i % BITS);
+        }
+
+        void reset(size_t i) {
+            words[i / BITS] &= ~(uint64_t(1) << (i % BITS));
+        }
+
+        // Tests bit `i` and sets it, returns the previous value
+        bool test_and_set(size_t i) {
+            uint64_t& word = words[i / BITS];
+            uint64_t mask = uint64_t(1) << (i % BITS);
+            bool was_set = word & mask;
+            word |= mask;
+            return was_set;
+        }
+
+        void set_all() {
+            for (auto& w : words) w = ~uint64_t(0);
+            trim();
+        }
+
+        void reset_all() {
+            for (auto& w : words) w = 0;
+        }
+
+        // Sets bits [begin, end)
+        void set_range(size_t begin, size_t end) {
+            apply_range(begin, end, [](uint64_t& w, uint64_t mask) { w |= mask; });
+        }
+
+        // Clears bits [begin, end)
+        void reset_range(size_t begin, size_t end) {
+            apply_range(begin, end, [](uint64_t& w, uint64_t mask) { w &= ~mask; });
+        }
+
+        bool any() const {
+            uint64_t acc = 0;
+            for (uint64_t w : words) acc |= w;
+            return acc != 0;
+        }
+
+        bool none() const {
+            return !any();
+        }
+
+        size_t count() const {
+            size_t n = 0;
+            for (uint64_t w : words) n += __builtin_popcountll(w);
+            return n;
+        }
+
+        bool intersects(const DynamicBitset& other) const {
+            uint64_t acc = 0;
+            size_t n = words.size() < other.words.size() ? words.size() : other.words.size();
+            for (size_t i = 0; i < n; ++i) acc |= words[i] & other.words[i];
+            return acc != 0;
+        }
+
+        DynamicBitset& operator|=(const DynamicBitset& other) {
+            size_t n = words.size() < other.words.size() ? words.size() : other.words.size();
+            for (size_t i = 0; i < n; ++i) words[i] |= other.words[i];
+            return *this;
+        }
+
+        DynamicBitset& operator&=(const DynamicBitset& other) {
+            size_t n = words.size() < other.words.size() ? words.size() : other.words.size();
+            for (size_t i = 0; i < n; ++i) words[i] &= other.words[i];
+            for (size_t i = n; i < words.size(); ++i) words[i] = 0;
+            return *this;
+        }
+
+        DynamicBitset& operator^=(const DynamicBitset& other) {
+            size_t n = words.size() < other.words.size() ? words.size() : other.words.size();
+            for (size_t i = 0; i < n; ++i) words[i] ^= other.words[i];
+            return *this;
+        }
+
+        // Clears every bit that is set in `other` (this &= ~other)
+        DynamicBitset& subtract(const DynamicBitset& other) {
+            size_t n = words.size() < other.words.size() ? words.size() : other.words.size();
+            for (size_t i = 0; i < n; ++i) words[i] &= ~other.words[i];
+            return *this;
+        }
+
+        DynamicBitset operator~() const {
+            DynamicBitset result(*this);
+            for (auto& w : result.words) w = ~w;
+            result.trim();
+            return result;
+        }
+
+        bool operator==(const DynamicBitset& other) const {
+            return nbits == other.nbits && words == other.words;
+        }
+
+        bool operator!=(const DynamicBitset& other) const {
+            return !(*this == other);
+        }
+
+        // Calls fn(index) for every set bit in increasing order
+        template <typename Fn>
+        void for_each(Fn&& fn) const {
+            for (size_t w = 0; w < words.size(); ++w) {
+                uint64_t bits = words[w];
+                while (bits) {
+                    fn(w * BITS + __builtin_ctzll(bits));
+                    bits &= bits - 1;
+                }
+            }
+        }
+
+        std::vector<size_t> to_indices() const {
+            std::vector<size_t> indices;
+            indices.reserve(count());
+            for_each([&](size_t i) { indices.push_back(i); });
+            return indices;
+        }
+
+    private:
+        // Zeroes the unused high bits of the last word
+        void trim() {
+            if (nbits % BITS != 0 && !words.empty()) {
+                words.back() &= (uint64_t(1) << (nbits % BITS)) - 1;
+            }
+        }
+
+        template <typename Op>
+        void apply_range(size_t begin, size_t end, Op op) {
+            if (begin >= end) {
+                return;
+            }
+            size_t first = begin / BITS;
+            size_t last = (end - 1) / BITS;
+            uint64_t head = ~uint64_t(0) << (begin % BITS);
+            uint64_t tail = ~uint64_t(0) >> (BITS - 1 - (end - 1) % BITS);
+            if (first == last) {
+                op(words[first], head & tail);
+                return;
+            }
+            op(words[first], head);
+            for (size_t w = first + 1; w < last; ++w) {
+                op(words[w], ~uint64_t(0));
+            }
+            op(words[last], tail);
+        }
+    };
+
+}; // namespace qarser
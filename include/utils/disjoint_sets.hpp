@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace qarser {
+
+    /**
+     * @brief Union-find over the elements 0..size-1.
+     *
+     * Union by size and path halving keep every operation within the
+     * inverse Ackermann bound, effectively constant.
+     */
+    class DisjointSets {
+    private:
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> sizes;
+        size_t num_sets = 0;
+
+    public:
+        DisjointSets() = default;
+
+        explicit DisjointSets(size_t size)
+            : parent(size), sizes(size, 1), num_sets(size) {
+            for (size_t i = 0; i < size; ++i) {
+                parent[i] = static_cast<uint32_t>(i);
+            }
+        }
+
+        size_t size() const { return parent.size(); }
+        size_t count() const { return num_sets; }
+
+        uint32_t find(uint32_t i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        }
+
+        // Returns false when a and b already were in the same set
+        bool unite(uint32_t a, uint32_t b) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return false;
+            }
+            if (sizes[a] < sizes[b]) {
+                std::swap(a, b);
+            }
+            parent[b] = a;
+            sizes[a] += sizes[b];
+            --num_sets;
+            return true;
+        }
+
+        uint32_t set_size(uint32_t i) {
+            return sizes[find(i)];
+        }
+    };
+
+}; // namespace qarser
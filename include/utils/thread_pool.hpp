@@ -0,0 +1,126 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+namespace qarser {
+
+    /**
+     * @brief Fixed set of worker threads for data-parallel loops.
+     *
+     * `parallel_for` splits a range into chunks that the workers and the
+     * calling thread claim from a shared counter, and returns once every
+     * chunk is done. A pool with no workers runs everything on the caller.
+     */
+    class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable available;
+        bool stopping = false;
+
+    public:
+        explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency()) {
+            // The calling thread always takes part, so it counts as one of them
+            for (size_t i = 1; i < num_threads; ++i) {
+                workers.emplace_back([this] { run(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            available.notify_all();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Threads taking part in a parallel_for, including the caller
+        size_t size() const {
+            return workers.size() + 1;
+        }
+
+        // Pool sized to the hardware, created on first use
+        static ThreadPool& shared() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        /**
+         * @brief Calls fn(chunk, begin, end) for consecutive chunks of [0, count).
+         *
+         * Chunk i covers [i * grain, min((i + 1) * grain, count)).
+         */
+        template <typename Fn>
+        void parallel_for(size_t count, size_t grain, Fn&& fn) {
+            grain = std::max<size_t>(grain, 1);
+            size_t num_chunks = (count + grain - 1) / grain;
+            if (num_chunks <= 1 || workers.empty()) {
+                for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                    fn(chunk, chunk * grain, std::min(count, (chunk + 1) * grain));
+                }
+                return;
+            }
+
+            std::atomic<size_t> next{0};
+            size_t helpers = std::min(workers.size(), num_chunks - 1);
+            size_t finished = 0;
+            std::mutex done_mutex;
+            std::condition_variable done;
+
+            auto work = [&] {
+                for (size_t chunk = next++; chunk < num_chunks; chunk = next++) {
+                    fn(chunk, chunk * grain, std::min(count, (chunk + 1) * grain));
+                }
+            };
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (size_t i = 0; i < helpers; ++i) {
+                    tasks.push([&] {
+                        work();
+                        std::lock_guard<std::mutex> lock(done_mutex);
+                        if (++finished == helpers) {
+                            done.notify_one();
+                        }
+                    });
+                }
+            }
+            available.notify_all();
+
+            work();
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done.wait(lock, [&] { return finished == helpers; });
+        }
+
+    private:
+        void run() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    available.wait(lock, [this] { return stopping || !tasks.empty(); });
+                    if (stopping && tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+    };
+
+}; // namespace qarser
@@ -0,0 +1,430 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "parser.h"
+#include "stats.h"
+#include "AST/compressor.hpp"
+#include "SA/analyzer.hpp"
+#include "SA/incremental_analyzer.hpp"
+#include "IR/lowering.hpp"
+#include "IR/qasm_writer.hpp"
+#include "IR/structural_hash.hpp"
+#include "IR/passes/basis_translation.hpp"
+#include "IR/passes/component_partition.hpp"
+#include "IR/passes/dead_operation_elimination.hpp"
+#include "IR/passes/light_cone.hpp"
+#include "IR/passes/qubit_reuse.hpp"
+#include "IR/passes/sabre_routing.hpp"
+#include "IR/passes/vf2_layout.hpp"
+
+static void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--stats] [--watch] [--compress] [--usage] [--hash] [--slice <bits>] [--prune] [--reuse] [--split] [--route <coupling>] [--layout] [--trials <n>] [--seed <n>] <file.qasm>\n"
+              << "  --stats    print circuit statistics without building the AST\n"
+              << "  --watch    re-check the file whenever it changes, re-analyzing only edited statements\n"
+              << "  --compress fold repeated statement blocks before analysis and lowering\n"
+              << "  --usage    print the idle and the unmeasured qubits of every register\n"
+              << "  --hash     print the structural hash, blind to names, layout and independent gate order\n"
+              << "  --slice    keep only what the comma-separated bits or qubits (c, c[1], q[0]) depend on\n"
+              << "  --prune    remove operations no measured bit depends on\n"
+              << "  --reuse    run qubits on wires freed by measurements and print the narrowed program\n"
+              << "  --split    print each independent part as its own program with its qubit and bit maps\n"
+              << "  --route    route onto the coupling map in <coupling> (one \"a b\" edge per line)\n"
+              << "             and print the routed program with its layouts\n"
+              << "  --layout   start routing from a layout matched to the circuit's interactions\n"
+              << "  --trials   routing trials run in parallel (default 8)\n"
+              << "  --seed     seed of the routing trials (default 0)\n";
+}
+
+static void print_layout(std::ostream& out, const char* title, const qarser::Layout& layout, uint32_t num_qubits) {
+    out << "// " << title << ":";
+    for (uint32_t q = 0; q < num_qubits; ++q) {
+        out << " " << q << "->" << layout.to_physical[q];
+    }
+    out << "\n";
+}
+
+// Global indices of "name" or "name[i]" in `registers`, empty if there is no such register
+static std::vector<uint32_t> resolve(const std::vector<qarser::Circuit::Register>& registers, const std::string& ref) {
+    std::string name = ref.substr(0, ref.find('['));
+    for (const auto& reg : registers) {
+        if (reg.name != name) {
+            continue;
+        }
+        if (name.size() == ref.size()) {
+            std::vector<uint32_t> indices(reg.size);
+            for (uint32_t i = 0; i < reg.size; ++i) {
+                indices[i] = reg.offset + i;
+            }
+            return indices;
+        }
+        std::string digits = ref.substr(name.size() + 1, ref.size() - name.size() - 2);
+        if (ref.back() != ']' || digits.empty() || digits.size() > 9 ||
+            digits.find_first_not_of("0123456789") != std::string::npos || std::stoul(digits) >= reg.size) {
+            throw std::invalid_argument("Invalid slice target " + ref);
+        }
+        return {reg.offset + static_cast<uint32_t>(std::stoul(digits))};
+    }
+    return {};
+}
+
+static qarser::Circuit slice(const qarser::Circuit& circuit, const std::string& targets) {
+    std::vector<uint32_t> clbits, qubits;
+    std::stringstream refs(targets);
+    std::string ref;
+    while (std::getline(refs, ref, ',')) {
+        auto bits = resolve(circuit.get_cregs(), ref);
+        auto wires = resolve(circuit.get_qregs(), ref);
+        if (bits.empty() && wires.empty()) {
+            throw std::invalid_argument("Unknown slice target " + ref);
+        }
+        clbits.insert(clbits.end(), bits.begin(), bits.end());
+        qubits.insert(qubits.end(), wires.begin(), wires.end());
+    }
+    auto result = qarser::LightConeSlicer().slice(circuit, clbits, qubits);
+    std::cout << "// slice: " << result.operations_before << " -> " << result.circuit.size() << " operations, "
+              << circuit.get_num_qubits() << " -> " << result.qubits.size() << " qubits\n// qubits:";
+    for (uint32_t q = 0; q < result.qubits.size(); ++q) {
+        std::cout << " " << q << "->" << result.qubits[q];
+    }
+    std::cout << "\n";
+    return std::move(result.circuit);
+}
+
+static qarser::Circuit reuse_qubits(const qarser::Circuit& circuit) {
+    auto result = qarser::QubitReuse().run(circuit);
+    std::cout << "// width: " << result.width_before << " -> " << result.width_after
+              << ", resets inserted: " << result.resets << "\n// wires:";
+    for (uint32_t q = 0; q < result.wires.size(); ++q) {
+        if (result.wires[q].empty()) {
+            continue;
+        }
+        std::cout << " " << q << "->";
+        for (size_t i = 0; i < result.wires[q].size(); ++i) {
+            std::cout << (i ? "," : "") << result.wires[q][i];
+        }
+    }
+    std::cout << "\n";
+    return std::move(result.circuit);
+}
+
+static int print_components(const qarser::Circuit& circuit) {
+    auto partition = qarser::ComponentPartitioner().split(circuit);
+    std::cout << "// components: " << partition.components.size() << ", idle qubits: "
+              << partition.idle_qubits.size() << "\n";
+    for (size_t i = 0; i < partition.components.size(); ++i) {
+        const auto& component = partition.components[i];
+        std::cout << "// component " << i << ": " << component.circuit.size() << " operations\n// qubits:";
+        for (uint32_t q = 0; q < component.qubits.size(); ++q) {
+            std::cout << " " << q << "->" << component.qubits[q];
+        }
+        std::cout << "\n// bits:";
+        for (uint32_t c = 0; c < component.clbits.size(); ++c) {
+            std::cout << " " << c << "->" << component.clbits[c];
+        }
+        std::cout << "\n";
+        qarser::QasmWriter(std::cout).write(component.circuit);
+    }
+    return 0;
+}
+
+// Leading and trailing statements that lie entirely outside lines [begin, end]
+static std::pair<size_t, size_t> untouched(const qarser::Program& program, int begin, int end, int num_lines) {
+    // Statements record the line of one of their tokens, so each lies between its neighbours' lines
+    const auto& stmts = program.statements;
+    size_t leading = 0;
+    while (leading < stmts.size() &&
+           (leading + 1 < stmts.size() ? stmts[leading + 1]->line : num_lines + 1) < begin) {
+        ++leading;
+    }
+    size_t trailing = 0;
+    while (leading + trailing < stmts.size()) {
+        size_t i = stmts.size() - 1 - trailing;
+        if ((i > 0 ? stmts[i - 1]->line : 0) <= end) {
+            break;
+        }
+        ++trailing;
+    }
+    return {leading, trailing};
+}
+
+static std::vector<std::string> split_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::stringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static int watch(const char* path) {
+    namespace fs = std::filesystem;
+    qarser::Program program;
+    qarser::IncrementalAnalyzer analyzer;
+    std::vector<std::string> lines;
+    analyzer.analyze(program);
+
+    fs::file_time_type seen{};
+    while (true) {
+        std::error_code error;
+        fs::file_time_type modified = fs::last_write_time(path, error);
+        if (error || modified == seen) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            continue;
+        }
+        seen = modified;
+        std::ifstream file(path);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        std::unique_ptr<qarser::Program> edited;
+        try {
+            edited = qarser::Parser(buffer.str()).parse();
+        }
+        catch (const std::exception& e) {
+            std::cout << e.what() << std::endl;
+            continue;
+        }
+
+        // Only statements that may touch the changed lines are replaced
+        std::vector<std::string> edited_lines = split_lines(buffer.str());
+        size_t prefix = 0;
+        while (prefix < lines.size() && prefix < edited_lines.size() && lines[prefix] == edited_lines[prefix]) {
+            ++prefix;
+        }
+        size_t suffix = 0;
+        while (suffix < std::min(lines.size(), edited_lines.size()) - prefix &&
+               lines[lines.size() - 1 - suffix] == edited_lines[edited_lines.size() - 1 - suffix]) {
+            ++suffix;
+        }
+        // Statements after a change that moved lines carry stale line numbers
+        int begin = static_cast<int>(prefix) + 1;
+        auto [leading, trailing] = untouched(program, begin,
+            lines.size() == edited_lines.size() ? static_cast<int>(lines.size() - suffix) : INT_MAX,
+            static_cast<int>(lines.size()));
+        auto [edited_leading, edited_trailing] = untouched(*edited, begin,
+            lines.size() == edited_lines.size() ? static_cast<int>(edited_lines.size() - suffix) : INT_MAX,
+            static_cast<int>(edited_lines.size()));
+        leading = std::min(leading, edited_leading);
+        trailing = std::min(trailing, edited_trailing);
+
+        auto& stmts = edited->statements;
+        std::vector<std::unique_ptr<qarser::Statement>> statements(
+            std::make_move_iterator(stmts.begin() + leading),
+            std::make_move_iterator(stmts.end() - trailing));
+        auto start = std::chrono::steady_clock::now();
+        analyzer.replace(program, leading, program.statements.size() - leading - trailing, std::move(statements));
+        auto end = std::chrono::steady_clock::now();
+        lines = std::move(edited_lines);
+
+        auto errors = analyzer.get_errors();
+        {
+            qarser::StreamSink sink(std::cout);
+            for (const auto& err : errors) {
+                sink.write(err, analyzer.get_collector().format(err));
+            }
+        }
+        std::cout << "// " << path << ": " << errors.size() << " errors, " << program.statements.size()
+                  << " statements, checked in "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+    }
+}
+
+static void print_usage(const qarser::QubitUsage& usage) {
+    auto print_indices = [](const char* title, const qarser::DynamicBitset& bits) {
+        std::cout << ", " << bits.count() << " " << title;
+        if (bits.any()) {
+            std::cout << ":";
+            bits.for_each([](size_t i) { std::cout << " " << i; });
+        }
+    };
+    for (const auto& reg : usage.get_registers()) {
+        std::cout << "// " << reg.name << ": " << reg.used.count() << " of " << reg.used.size() << " used";
+        print_indices("idle", reg.idle());
+        print_indices("unmeasured", reg.unmeasured());
+        std::cout << "\n";
+    }
+}
+
+static int route(qarser::Circuit circuit, const char* coupling_path, bool select_layout,
+                 const qarser::SabreOptions& options) {
+    auto coupling = qarser::CouplingMap::from_file(coupling_path);
+
+    // Only gates on more than two qubits need decomposing before routing
+    bool decompose = false;
+    for (const auto& op : circuit.get_operations()) {
+        decompose |= op.num_qubits > 2 && op.code != qarser::OpCode::BARRIER;
+    }
+    if (decompose) {
+        std::vector<qarser::OpCode> basis;
+        for (size_t i = 0; i < static_cast<size_t>(qarser::OpCode::GATE); ++i) {
+            auto code = static_cast<qarser::OpCode>(i);
+            if (qarser::is_unitary(code) && qarser::op_info(code).num_qubits <= 2) {
+                basis.push_back(code);
+            }
+        }
+        circuit = qarser::BasisTranslator(basis).translate(circuit);
+    }
+
+    qarser::SabreRouter router(coupling, options);
+    qarser::RoutingResult result;
+    if (select_layout) {
+        qarser::LayoutOptions layout_options;
+        layout_options.seed = options.seed;
+        auto layout = qarser::VF2Layout(coupling, layout_options).run(circuit);
+        std::cout << "// layout: " << (layout.perfect ? "perfect" : "greedy") << ", score " << layout.score << "\n";
+        result = router.route(circuit, layout.layout);
+    }
+    else {
+        result = router.route(circuit);
+    }
+    print_layout(std::cout, "initial layout", result.initial_layout, circuit.get_num_qubits());
+    print_layout(std::cout, "final layout", result.final_layout, circuit.get_num_qubits());
+    std::cout << "// swaps: " << result.swaps << "\n";
+    qarser::QasmWriter(std::cout).write(result.circuit);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    bool stats = false;
+    bool watching = false;
+    bool select_layout = false;
+    bool compress = false;
+    bool hash = false;
+    bool qubit_usage = false;
+    bool prune = false;
+    bool split = false;
+    bool reuse = false;
+    const char* coupling = nullptr;
+    const char* targets = nullptr;
+    const char* path = nullptr;
+    qarser::SabreOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        }
+        else if (std::strcmp(argv[i], "--watch") == 0) {
+            watching = true;
+        }
+        else if (std::strcmp(argv[i], "--compress") == 0) {
+            compress = true;
+        }
+        else if (std::strcmp(argv[i], "--usage") == 0) {
+            qubit_usage = true;
+        }
+        else if (std::strcmp(argv[i], "--hash") == 0) {
+            hash = true;
+        }
+        else if (std::strcmp(argv[i], "--slice") == 0 && i + 1 < argc) {
+            targets = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--prune") == 0) {
+            prune = true;
+        }
+        else if (std::strcmp(argv[i], "--reuse") == 0) {
+            reuse = true;
+        }
+        else if (std::strcmp(argv[i], "--split") == 0) {
+            split = true;
+        }
+        else if (std::strcmp(argv[i], "--route") == 0 && i + 1 < argc) {
+            coupling = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--layout") == 0) {
+            select_layout = true;
+        }
+        else if (std::strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
+            options.trials = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::stoull(argv[++i]);
+        }
+        else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path || (stats && watching) || (watching && (compress || qubit_usage || hash || split || coupling || prune || reuse || targets)) ||
+        (stats && (compress || qubit_usage || hash || split || coupling || prune || reuse || targets)) || (select_layout && !coupling) || (split && coupling)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (watching) {
+        return watch(path);
+    }
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open " << path << "\n";
+        return 2;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    try {
+        if (stats) {
+            qarser::StatsCollector(buffer.str()).collect().print(std::cout);
+            return 0;
+        }
+        auto program = qarser::Parser(buffer.str()).parse();
+        if (compress) {
+            auto report = qarser::RepeatCompressor().compress(*program);
+            std::cout << "// statements: " << report.statements_before << " -> " << report.statements_after
+                      << " (" << report.repeats << " repeats)\n";
+        }
+        qarser::SemanticAnalyzer analyzer;
+        analyzer.analyze(*program);
+        auto& errors = analyzer.get_context().get_errors();
+        errors.report();
+        if (!errors.empty()) {
+            return 1;
+        }
+        if (qubit_usage) {
+            qarser::QubitUsageAnalyzer usage(analyzer.get_context());
+            program->accept(usage);
+            print_usage(usage.get_usage());
+        }
+        if (!hash && !split && !coupling && !prune && !reuse && !targets) {
+            return 0;
+        }
+        const auto& library = analyzer.get_context().get_library();
+        auto circuit = qarser::CircuitLowering(library).lower(*program);
+        if (hash) {
+            std::cout << "// hash: " << qarser::StructuralHasher(library).hash(circuit).to_string() << "\n";
+            if (!split && !coupling && !prune && !reuse && !targets) {
+                return 0;
+            }
+        }
+        if (targets) {
+            circuit = slice(circuit, targets);
+        }
+        if (prune) {
+            std::cout << "// dead operations removed: " << qarser::DeadOperationElimination().run(circuit) << "\n";
+        }
+        if (reuse) {
+            circuit = reuse_qubits(circuit);
+        }
+        if (split) {
+            return print_components(circuit);
+        }
+        if (coupling) {
+            return route(std::move(circuit), coupling, select_layout, options);
+        }
+        qarser::QasmWriter(std::cout).write(circuit);
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
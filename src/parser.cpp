@@ -74,6 +74,7 @@ namespace qarser {
         if (match(TokenType::QREG)) return parse_qreg();
         if (match(TokenType::CREG)) return parse_creg();
         if (match(TokenType::MEASURE)) return parse_measure();
+        if (match(TokenType::RESET)) return parse_reset();
         if (match(TokenType::BARRIER)) return parse_barrier();
 
         if (match(TokenType::GATE)) 
@@ -87,7 +88,7 @@ namespace qarser {
         Token filename = consume(TokenType::STRING, "Expect filename!");
         consume(TokenType::SEMICOLON, "Expect ';' !");
 
-        return std::make_unique<Include>(filename.lexeme);
+        return std::make_unique<Include>(filename.line, filename.lexeme);
     }
 
     std::unique_ptr<QRegister> Parser::parse_qreg() {
@@ -333,6 +334,14 @@ namespace qarser {
         return std::make_unique<Measure>(previous.line, qubits, cbits);
     }
 
+    std::unique_ptr<Reset> Parser::parse_reset() {
+        consume(TokenType::RESET, "Expect reset key word!");
+        RegisterRef qubit = parse_single_register_ref();
+        consume(TokenType::SEMICOLON, "Parsing reset, Expect ';'!");
+
+        return std::make_unique<Reset>(previous.line, qubit);
+    }
+
     std::unique_ptr<Barrier> Parser::parse_barrier() {
         consume(TokenType::BARRIER, "Expect barrier key word!");
         std::vector<RegisterRef> qubits = parse_register_ref();
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include "stats.h"
+#include "parser.h"
+
+
+namespace qarser {
+
+    double CircuitStats::statevector_bytes() const {
+        return 16.0 * std::pow(2.0, static_cast<double>(qubits));
+    }
+
+    void CircuitStats::print(std::ostream& out) const {
+        out << "qubits:          " << qubits << " (" << qubits_used << " used)\n";
+        out << "clbits:          " << clbits << "\n";
+        out << "depth:           " << depth << "\n";
+        out << "1q gates:        " << one_qubit << "\n";
+        out << "2q gates:        " << two_qubit << "\n";
+        out << "multi-q gates:   " << multi_qubit << "\n";
+        out << "measurements:    " << measurements << "\n";
+        out << "resets:          " << resets << "\n";
+        out << "barriers:        " << barriers << "\n";
+        out << "statevector:     " << statevector_bytes() << " bytes\n";
+
+        std::vector<std::pair<std::string, uint64_t>> counts(gate_counts.begin(), gate_counts.end());
+        std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        out << "gate counts:\n";
+        for (const auto& [name, count] : counts) {
+            out << "    " << std::setw(12) << std::left << name << count << "\n";
+        }
+    }
+
+
+    // -- Public :
+    StatsCollector::StatsCollector(const std::string& source)
+        : lexer(source) {
+        advance();
+    }
+
+    CircuitStats StatsCollector::collect() {
+        consume(TokenType::OPENQASM, "Expect OPENQASM key word!");
+        consume(TokenType::NUMBER, "Expect Version number!");
+        consume(TokenType::SEMICOLON, "Expect Semicolon!");
+
+        while (current.type != TokenType::EOF_TOKEN) {
+            statement();
+        }
+        stats.qubits_used = std::count(used.begin(), used.end(), true);
+        return stats;
+    }
+
+
+    // -- Private :
+    void StatsCollector::advance() {
+        current = lexer.next();
+    }
+
+    Token StatsCollector::consume(TokenType type, const std::string& message) {
+        if (current.type != type) {
+            error(message);
+        }
+        Token temp = current;
+        advance();
+        return temp;
+    }
+
+    void StatsCollector::error(const std::string& message) {
+        throw ParsingError(current.line, current.column, message, current.lexeme);
+    }
+
+    void StatsCollector::statement() {
+        switch (current.type) {
+            case TokenType::INCLUDE:
+                advance();
+                consume(TokenType::STRING, "Expect filename!");
+                consume(TokenType::SEMICOLON, "Expect ';' !");
+                return;
+            case TokenType::QREG:
+                advance();
+                declaration(qregs, stats.qubits);
+                levels.resize(stats.qubits, 0);
+                used.resize(stats.qubits, false);
+                return;
+            case TokenType::CREG:
+                advance();
+                declaration(cregs, stats.clbits);
+                clbit_levels.resize(stats.clbits, 0);
+                return;
+            case TokenType::GATE:    return skip_gate_def();
+            case TokenType::MEASURE: return measure();
+            case TokenType::RESET:   return reset();
+            case TokenType::BARRIER: return barrier();
+            case TokenType::IF:
+                // Conditions do not change the statistics of the guarded operation
+                skip_until(TokenType::RIGHT_PAREN);
+                return statement();
+            default:
+                return gate_call();
+        }
+    }
+
+    void StatsCollector::declaration(std::unordered_map<std::string, Register>& registers, uint64_t& total) {
+        Token name = consume(TokenType::IDENTIFIER, "Expect register name!");
+        consume(TokenType::LEFT_BRACKET, "Parsing register declaration, Expect '[' !");
+        Token size = consume(TokenType::NUMBER, "Expect register size!");
+        consume(TokenType::RIGHT_BRACKET, "Expect Right Bracket ']' !");
+        consume(TokenType::SEMICOLON, "Expect ';' while parsing register declaration!");
+
+        uint64_t width = std::stoull(size.lexeme);
+        if (registers.emplace(name.lexeme, Register{total, width}).second) {
+            total += width;
+        }
+    }
+
+    void StatsCollector::gate_call() {
+        Token name = consume(TokenType::IDENTIFIER, "Expect gate name!");
+        if (current.type == TokenType::LEFT_PAREN) {
+            skip_until(TokenType::RIGHT_PAREN);
+        }
+
+        operands.clear();
+        operands.push_back(operand(qregs));
+        while (current.type == TokenType::COMMA) {
+            advance();
+            operands.push_back(operand(qregs));
+        }
+        consume(TokenType::SEMICOLON, "Expect ';' after gate call!");
+
+        uint64_t width = broadcast_width();
+        stats.gate_counts[name.lexeme] += width;
+        switch (operands.size()) {
+            case 1:  stats.one_qubit += width; break;
+            case 2:  stats.two_qubit += width; break;
+            default: stats.multi_qubit += width; break;
+        }
+        apply(width);
+    }
+
+    void StatsCollector::measure() {
+        advance();
+        operands.clear();
+        operands.push_back(operand(qregs));
+        consume(TokenType::ARROW, "Expect '->' in measure!");
+        operands.push_back(operand(cregs));
+        operands.back().clbit = true;
+        consume(TokenType::SEMICOLON, "Expect ';' after measure!");
+
+        if (operands[0].whole != operands[1].whole || operands[0].size != operands[1].size) {
+            error("Measure between registers of different sizes!");
+        }
+
+        uint64_t width = broadcast_width();
+        stats.measurements += width;
+        apply(width);
+    }
+
+    void StatsCollector::reset() {
+        advance();
+        operands.clear();
+        operands.push_back(operand(qregs));
+        consume(TokenType::SEMICOLON, "Expect ';' after reset!");
+
+        uint64_t width = broadcast_width();
+        stats.resets += width;
+        apply(width);
+    }
+
+    void StatsCollector::barrier() {
+        advance();
+        operands.clear();
+        operands.push_back(operand(qregs));
+        while (current.type == TokenType::COMMA) {
+            advance();
+            operands.push_back(operand(qregs));
+        }
+        consume(TokenType::SEMICOLON, "Expect ';' after barrier!");
+        ++stats.barriers;
+
+        // Barriers take no time but align every qubit they name
+        uint64_t level = 0;
+        for (const auto& op : operands) {
+            for (uint64_t i = 0; i < op.size; ++i) level = std::max(level, levels[op.base + i]);
+        }
+        for (const auto& op : operands) {
+            for (uint64_t i = 0; i < op.size; ++i) levels[op.base + i] = level;
+        }
+    }
+
+    void StatsCollector::skip_gate_def() {
+        skip_until(TokenType::LEFT_BRACE);
+        skip_until(TokenType::RIGHT_BRACE);
+    }
+
+    // Skips past the next `type` token, keeping parentheses balanced
+    void StatsCollector::skip_until(TokenType type) {
+        int depth = 0;
+        while (current.type != TokenType::EOF_TOKEN) {
+            TokenType seen = current.type;
+            advance();
+            if (seen == TokenType::LEFT_PAREN) ++depth;
+            if (seen == TokenType::RIGHT_PAREN) --depth;
+            if (seen == type && depth <= 0) {
+                return;
+            }
+        }
+        error("Unexpected end of file!");
+    }
+
+    StatsCollector::Operand StatsCollector::operand(const std::unordered_map<std::string, Register>& registers) {
+        Token name = consume(TokenType::IDENTIFIER, "Expect register name!");
+        auto it = registers.find(name.lexeme);
+        if (it == registers.end()) {
+            throw ParsingError(name.line, name.column, "Undeclared register!", name.lexeme);
+        }
+        const Register& reg = it->second;
+        if (current.type != TokenType::LEFT_BRACKET) {
+            return Operand{reg.offset, reg.size, true};
+        }
+        advance();
+        Token index = consume(TokenType::NUMBER, "Expect index!");
+        consume(TokenType::RIGHT_BRACKET, "Expect Right Bracket ']' !");
+        uint64_t i = std::stoull(index.lexeme);
+        if (i >= reg.size) {
+            throw ParsingError(index.line, index.column, "Register index out of range!", index.lexeme);
+        }
+        return Operand{reg.offset + i, 1, false};
+    }
+
+    uint64_t StatsCollector::broadcast_width() {
+        uint64_t width = 0;
+        for (const auto& op : operands) {
+            if (!op.whole) continue;
+            if (width != 0 && op.size != width) {
+                error("Broadcast over registers of different sizes!");
+            }
+            width = op.size;
+        }
+        return std::max<uint64_t>(width, 1);
+    }
+
+    // One layer per broadcast element on the qubits and clbits it touches
+    void StatsCollector::apply(uint64_t width) {
+        for (uint64_t i = 0; i < width; ++i) {
+            uint64_t next = 0;
+            for (const auto& op : operands) {
+                next = std::max(next, level(op, i));
+            }
+            ++next;
+            for (const auto& op : operands) {
+                level(op, i) = next;
+                if (!op.clbit) {
+                    used[op.base + (op.whole ? i : 0)] = true;
+                }
+            }
+            stats.depth = std::max(stats.depth, next);
+        }
+    }
+
+    uint64_t& StatsCollector::level(const Operand& op, uint64_t broadcast_index) {
+        uint64_t index = op.base + (op.whole ? broadcast_index : 0);
+        return op.clbit ? clbit_levels[index] : levels[index];
+    }
+
+}; // namespace qarser
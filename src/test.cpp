@@ -92,6 +92,7 @@ void test_sa() {
 
     qarser::SemanticAnalyzer sa;
     sa.analyze(*ast);
+    sa.get_context().get_errors().report();
 }
 
 